@@ -1,6 +1,10 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <functional>
+#include <utility>
+#include <vector>
 #include <cstddef>
 
 struct AstSymbol {
@@ -10,4 +14,21 @@ struct AstSymbol {
     std::string callee_full;
     std::string callee_base;
     std::string first_arg;
+    std::vector<std::string> args;
+    std::vector<std::pair<std::string, std::string>> kwargs;
+    std::size_t startByte = 0;
+    std::size_t endByte = 0;
 };
+
+// One result a call site produced, without its file and line, so it can be kept alongside the
+// call and re-emitted when the call is unchanged.
+struct AstFinding {
+    std::string algorithm;
+    std::string matchString;
+    std::string evidenceType;
+    std::string severity;
+};
+
+// Sees the raw callee and first-argument text of a call site before any string is built;
+// returning false drops the call.
+using CallSiteFilter = std::function<bool(std::string_view callee, std::string_view firstArg)>;
@@ -0,0 +1,360 @@
+#include "ApiNameIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+
+namespace analyzers {
+
+namespace {
+
+const int kMaxDepth = 16;
+
+inline unsigned char fold(unsigned char c){ return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + 32) : c; }
+
+bool isMeta(char c){ return c && std::strchr(".[](){}*+?|^$\\", c); }
+
+// Position just past the ']' closing the class that opens at re[i], or npos.
+std::size_t skipClass(std::string_view re, std::size_t i){
+    for(++i; i < re.size(); ++i){
+        if(re[i] == '\\') ++i;
+        else if(re[i] == ']') return i + 1;
+    }
+    return std::string_view::npos;
+}
+
+// Index of the ')' closing the group that opens at re[i], or npos.
+std::size_t closeParen(std::string_view re, std::size_t i){
+    int depth = 0;
+    while(i < re.size()){
+        const char c = re[i];
+        if(c == '\\'){ i += 2; continue; }
+        if(c == '['){
+            i = skipClass(re, i);
+            if(i == std::string_view::npos) return i;
+            continue;
+        }
+        if(c == '(') ++depth;
+        else if(c == ')' && --depth == 0) return i;
+        ++i;
+    }
+    return std::string_view::npos;
+}
+
+// Splits at '|' outside groups and classes.
+bool splitAlternatives(std::string_view re, std::vector<std::string_view>& alts){
+    std::size_t start = 0, i = 0;
+    while(i < re.size()){
+        const char c = re[i];
+        if(c == '\\'){ i += 2; continue; }
+        if(c == '['){
+            i = skipClass(re, i);
+            if(i == std::string_view::npos) return false;
+            continue;
+        }
+        if(c == '('){
+            i = closeParen(re, i);
+            if(i == std::string_view::npos) return false;
+            ++i;
+            continue;
+        }
+        if(c == '|'){
+            alts.push_back(re.substr(start, i - start));
+            start = i + 1;
+        }
+        ++i;
+    }
+    alts.push_back(re.substr(start));
+    return true;
+}
+
+bool prefixes(std::string_view re, std::vector<std::string>& out, int depth){
+    if(depth > kMaxDepth) return false;
+    std::vector<std::string_view> alts;
+    if(!splitAlternatives(re, alts)) return false;
+    if(alts.size() > 1){
+        for(auto a : alts){
+            if(!prefixes(a, out, depth + 1)) return false;
+        }
+        return true;
+    }
+    std::size_t i = 0;
+    for(;;){
+        if(re.compare(i, 1, "^") == 0) i += 1;
+        else if(re.compare(i, 2, "\\b") == 0) i += 2;
+        else break;
+    }
+    if(i < re.size() && re[i] == '('){
+        const std::size_t close = closeParen(re, i);
+        if(close == std::string_view::npos) return false;
+        if(close + 1 < re.size() && std::strchr("?*{", re[close + 1])) return false;
+        std::string_view inner = re.substr(i + 1, close - i - 1);
+        if(inner.compare(0, 2, "?:") == 0) inner.remove_prefix(2);
+        else if(!inner.empty() && inner[0] == '?') return false;    // lookaround
+        return prefixes(inner, out, depth + 1);
+    }
+    std::string lit;
+    while(i < re.size()){
+        char c = re[i];
+        std::size_t width = 1;
+        if(c == '\\'){
+            if(i + 1 >= re.size()) break;
+            c = re[i + 1];
+            // \b, \s, \d, \x41, ... are classes, anchors or numeric escapes, not the letter itself.
+            if(std::isalnum((unsigned char)c)) break;
+            width = 2;
+        }else if(isMeta(c)){
+            break;
+        }
+        if(i + width < re.size() && std::strchr("?*{", re[i + width])) break;
+        lit.push_back((char)fold((unsigned char)c));
+        i += width;
+        if(i < re.size() && re[i] == '+') break;
+    }
+    if(lit.empty()) return false;
+    out.push_back(std::move(lit));
+    return true;
+}
+
+
+// One item of a regex sequence, with the quantifier that follows it.
+struct Item {
+    enum Kind { Char, Class, Group, Anchor, Other } kind = Other;
+    std::string_view text;      // the character, the class body or the group body
+    bool optional = false;      // '?', '*' or {0,...}
+    bool repeats = false;       // '+', '*' or {n,...} with more than one match possible
+};
+
+const std::size_t kMaxExpansion = 64;
+
+// Reads the item at re[i] and advances i past it and its quantifier.
+bool nextItem(std::string_view re, std::size_t& i, Item& it){
+    it = Item();
+    const char c = re[i];
+    if(c == '\\'){
+        if(i + 1 >= re.size()) return false;
+        const char e = re[i + 1];
+        it.kind = (e == 'b' || e == 'B') ? Item::Anchor : std::isalnum((unsigned char)e) ? Item::Other : Item::Char;
+        it.text = re.substr(i + 1, 1);
+        i += 2;
+    }else if(c == '['){
+        const std::size_t end = skipClass(re, i);
+        if(end == std::string_view::npos) return false;
+        it.kind = Item::Class;
+        it.text = re.substr(i + 1, end - i - 2);
+        i = end;
+    }else if(c == '('){
+        const std::size_t close = closeParen(re, i);
+        if(close == std::string_view::npos) return false;
+        std::string_view inner = re.substr(i + 1, close - i - 1);
+        if(inner.compare(0, 2, "?:") == 0){ inner.remove_prefix(2); it.kind = Item::Group; }
+        else if(inner.compare(0, 2, "?=") == 0 || inner.compare(0, 2, "?!") == 0) it.kind = Item::Anchor;
+        else it.kind = (!inner.empty() && inner[0] == '?') ? Item::Other : Item::Group;
+        it.text = inner;
+        i = close + 1;
+    }else{
+        it.kind = (c == '^' || c == '$') ? Item::Anchor : (isMeta(c) ? Item::Other : Item::Char);
+        it.text = re.substr(i, 1);
+        i += 1;
+    }
+    if(i < re.size()){
+        const char q = re[i];
+        if(q == '?' || q == '*' || q == '+'){
+            it.optional = q != '+';
+            it.repeats = q != '?';
+            ++i;
+        }else if(q == '{'){
+            const std::size_t end = re.find('}', i);
+            if(end == std::string_view::npos) return false;
+            const std::string_view body = re.substr(i + 1, end - i - 1);
+            it.optional = body.empty() || body[0] == '0';
+            it.repeats = body != "1" && body != "1,1";
+            i = end + 1;
+        }
+        if((it.optional || it.repeats) && i < re.size() && re[i] == '?') ++i;  // lazy
+    }
+    return true;
+}
+
+bool expand(std::string_view re, std::vector<std::string>& out, int depth);
+
+// Every string a single item matches, folded; false for anything but characters, small plain
+// classes and groups of those.
+bool expandItem(const Item& it, std::vector<std::string>& out, int depth){
+    out.clear();
+    if(it.kind == Item::Char){
+        out.emplace_back(1, (char)fold((unsigned char)it.text[0]));
+        return true;
+    }
+    if(it.kind == Item::Class){
+        if(it.text.empty() || it.text.size() > 8 || it.text[0] == '^') return false;
+        for(char c : it.text){
+            if(c == '\\' || c == '-') return false;
+            std::string one(1, (char)fold((unsigned char)c));
+            if(std::find(out.begin(), out.end(), one) == out.end()) out.push_back(one);
+        }
+        return true;
+    }
+    return it.kind == Item::Group && expand(it.text, out, depth + 1);
+}
+
+bool expand(std::string_view re, std::vector<std::string>& out, int depth){
+    if(depth > kMaxDepth) return false;
+    std::vector<std::string_view> alts;
+    if(!splitAlternatives(re, alts)) return false;
+    out.clear();
+    for(auto a : alts){
+        std::vector<std::string> run{ std::string() }, ex, next;
+        for(std::size_t i = 0; i < a.size();){
+            Item it;
+            if(!nextItem(a, i, it)) return false;
+            if(it.kind == Item::Anchor) continue;
+            if(it.repeats || !expandItem(it, ex, depth)) return false;
+            if(it.optional) ex.push_back(std::string());
+            if(run.size() * ex.size() > kMaxExpansion) return false;
+            next.clear();
+            for(const auto& r : run) for(const auto& e : ex) next.push_back(r + e);
+            run.swap(next);
+        }
+        out.insert(out.end(), run.begin(), run.end());
+        if(out.size() > kMaxExpansion) return false;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return true;
+}
+
+std::size_t shortest(const std::vector<std::string>& v){
+    std::size_t m = std::string::npos;
+    for(const auto& s : v) m = std::min(m, s.size());
+    return v.empty() ? 0 : m;
+}
+
+// Among the runs of expandable items in each alternative (and the mandatory groups breaking
+// them), the most selective set: the longest shortest member, or once that reaches four bytes,
+// the fewest members. A run is cut rather than multiplied out once it is four bytes long.
+bool mandatory(std::string_view re, std::vector<std::string>& out, int depth){
+    if(depth > kMaxDepth) return false;
+    std::vector<std::string_view> alts;
+    if(!splitAlternatives(re, alts)) return false;
+    std::vector<std::string> all;
+    for(auto a : alts){
+        std::vector<std::string> best, run{ std::string() }, ex, next, inner;
+        auto consider = [&](const std::vector<std::string>& c){
+            const std::size_t m = shortest(c), b = shortest(best);
+            if(!m) return;
+            const bool better = best.empty() || (m >= 4 && b >= 4 ? (c.size() < best.size() || (c.size() == best.size() && m > b))
+                                                                  : (m > b || (m == b && c.size() < best.size())));
+            if(better) best = c;
+        };
+        auto closeRun = [&](){ consider(run); run.assign(1, std::string()); };
+        for(std::size_t i = 0; i < a.size();){
+            Item it;
+            if(!nextItem(a, i, it)) return false;
+            if(it.kind == Item::Anchor) continue;
+            if(!expandItem(it, ex, depth)){
+                closeRun();
+                if(it.kind == Item::Group && !it.optional && mandatory(it.text, inner, depth + 1)) consider(inner);
+                continue;
+            }
+            if(it.optional && it.repeats){ closeRun(); continue; }
+            if(it.optional) ex.push_back(std::string());
+            if(ex.size() > 1 && shortest(run) >= 4) closeRun();
+            if(run.size() * ex.size() > kMaxExpansion){ closeRun(); if(it.optional) continue; run = ex; }
+            else{
+                next.clear();
+                for(const auto& r : run) for(const auto& e : ex) next.push_back(r + e);
+                run.swap(next);
+            }
+            if(it.repeats) closeRun();
+        }
+        closeRun();
+        if(best.empty()) return false;
+        all.insert(all.end(), best.begin(), best.end());
+    }
+    // Superstrings are kept: "md5sum" is implied by "md5" as a substring but not as a word.
+    std::sort(all.begin(), all.end());
+    all.erase(std::unique(all.begin(), all.end()), all.end());
+    out.insert(out.end(), all.begin(), all.end());
+    return true;
+}
+
+}
+
+bool ApiNameIndex::requiredPrefixes(std::string_view re, std::vector<std::string>& out){
+    std::vector<std::string> lits;
+    if(!prefixes(re, lits, 0)) return false;
+    out.insert(out.end(), lits.begin(), lits.end());
+    return true;
+}
+
+bool ApiNameIndex::requiredLiterals(std::string_view re, std::vector<std::string>& out){
+    std::vector<std::string> lits;
+    if(!mandatory(re, lits, 0)) return false;
+    out.insert(out.end(), lits.begin(), lits.end());
+    return true;
+}
+
+std::uint32_t ApiNameIndex::child(std::uint32_t s, unsigned char c) const {
+    const auto& next = nodes[s].next;
+    auto it = std::lower_bound(next.begin(), next.end(), c, [](const std::pair<unsigned char, std::uint32_t>& e, unsigned char v){ return e.first < v; });
+    return (it != next.end() && it->first == c) ? it->second : 0;
+}
+
+void ApiNameIndex::build(const std::vector<std::vector<std::string>>& literals){
+    nodes.assign(1, Node());
+    always.clear();
+    for(std::size_t id = 0; id < literals.size(); ++id){
+        if(literals[id].empty()){ always.push_back(id); continue; }
+        for(const auto& lit : literals[id]){
+            std::uint32_t s = 0;
+            for(unsigned char c : lit){
+                c = fold(c);
+                std::uint32_t t = child(s, c);
+                if(!t){
+                    t = (std::uint32_t)nodes.size();
+                    auto& next = nodes[s].next;
+                    next.insert(std::upper_bound(next.begin(), next.end(), std::make_pair(c, (std::uint32_t)0)), { c, t });
+                    nodes.emplace_back();
+                }
+                s = t;
+            }
+            auto& ids = nodes[s].ids;
+            if(std::find(ids.begin(), ids.end(), id) == ids.end()) ids.push_back(id);
+        }
+    }
+    // Breadth-first failure links; the root's children fail to the root.
+    std::deque<std::uint32_t> queue;
+    for(const auto& e : nodes[0].next) queue.push_back(e.second);
+    while(!queue.empty()){
+        const std::uint32_t s = queue.front();
+        queue.pop_front();
+        for(const auto& e : nodes[s].next){
+            std::uint32_t f = nodes[s].fail;
+            while(f && !child(f, e.first)) f = nodes[f].fail;
+            const std::uint32_t t = child(f, e.first);
+            nodes[e.second].fail = t;
+            nodes[e.second].outLink = nodes[t].ids.empty() ? nodes[t].outLink : t;
+            queue.push_back(e.second);
+        }
+    }
+}
+
+void ApiNameIndex::candidates(std::string_view name, std::vector<std::size_t>& out) const {
+    out = always;
+    std::uint32_t s = 0;
+    for(char ch : name){
+        const unsigned char c = fold((unsigned char)ch);
+        std::uint32_t t;
+        while(!(t = child(s, c)) && s) s = nodes[s].fail;
+        s = t;
+        for(std::uint32_t o = nodes[s].ids.empty() ? nodes[s].outLink : s; o; o = nodes[o].outLink){
+            out.insert(out.end(), nodes[o].ids.begin(), nodes[o].ids.end());
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace analyzers {
+
+// Narrows the API patterns worth running against an imported or exported function name. Each
+// pattern is reduced to the literals any match has to start with (the alternatives of
+// "\b(?:EVP_[A-Za-z0-9_]+|RSA_...)" give "evp_", "rsa_", ...); all literals go into one
+// case-folded Aho-Corasick automaton, so a name is walked once and only patterns whose literal
+// occurs in it are handed back for the regex to confirm. Patterns that cannot be reduced are
+// returned for every name.
+class ApiNameIndex {
+public:
+    // Literals every match of an ECMAScript regex must begin with; false when some alternative
+    // starts with a class, an optional part or anything else that is not a plain character.
+    static bool requiredPrefixes(std::string_view re, std::vector<std::string>& out);
+    // Case-folded literals one of which occurs in every match of an ECMAScript regex, wherever
+    // in the match: short alternations, optional characters and small classes are expanded
+    // ("R-?34(?:10|11)" gives r3410, r-3410, ...). False when some alternative has no literal.
+    static bool requiredLiterals(std::string_view re, std::vector<std::string>& out);
+
+    // literals[id] holds the literals of pattern `id`; an empty list makes it a candidate for
+    // every name.
+    void build(const std::vector<std::vector<std::string>>& literals);
+    // Ids, ascending and without duplicates, that may match `name`.
+    void candidates(std::string_view name, std::vector<std::size_t>& out) const;
+
+private:
+    struct Node {
+        std::vector<std::pair<unsigned char, std::uint32_t>> next;  // sorted by byte
+        std::uint32_t fail = 0;
+        std::uint32_t outLink = 0;  // nearest proper suffix state with ids, 0 for none
+        std::vector<std::size_t> ids;
+    };
+
+    std::uint32_t child(std::uint32_t s, unsigned char c) const;
+
+    std::vector<Node> nodes{ Node() };
+    std::vector<std::size_t> always;
+};
+
+}
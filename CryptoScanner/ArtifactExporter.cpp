@@ -0,0 +1,703 @@
+#include "ArtifactExporter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <openssl/evp.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#include <unistd.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace artifact {
+
+namespace {
+
+static inline bool isELF(const std::vector<unsigned char>& b){ return b.size()>=4 && b[0]==0x7F && b[1]=='E' && b[2]=='L' && b[3]=='F'; }
+static inline bool isPE(const std::vector<unsigned char>& b){ return b.size()>=2 && b[0]=='M' && b[1]=='Z'; }
+static inline bool isAr(const std::vector<unsigned char>& b){ return b.size()>=8 && std::memcmp(b.data(), "!<arch>\n", 8) == 0; }
+
+static inline std::string sha256Hex(const std::vector<unsigned char>& b){
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int n = 0;
+    if(!EVP_Digest(b.data(), b.size(), md, &n, EVP_sha256(), nullptr)) return "";
+    std::ostringstream oss;
+    oss<<std::hex<<std::setfill('0');
+    for(unsigned int i=0;i<n;i++) oss<<std::setw(2)<<(unsigned)md[i];
+    return oss.str();
+}
+
+static inline std::string zpad(int v, int w){
+    std::ostringstream oss; oss<<std::setw(w)<<std::setfill('0')<<v; return oss.str();
+}
+
+static inline bool readAll(const std::string& path, std::vector<unsigned char>& out){
+    std::ifstream f(path, std::ios::binary);
+    if(!f) return false;
+    f.seekg(0, std::ios::end);
+    std::streamoff n = f.tellg();
+    if(n < 0) return false;
+    f.seekg(0, std::ios::beg);
+    out.resize((size_t)n);
+    if(n > 0) f.read(reinterpret_cast<char*>(out.data()), n);
+    return (bool)f;
+}
+
+static inline bool writeAll(const fs::path& p, const uint8_t* data, size_t n){
+    std::error_code ec;
+    fs::create_directories(p.parent_path(), ec);
+    std::ofstream f(p, std::ios::binary | std::ios::trunc);
+    if(!f) return false;
+    if(n){
+        f.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(n));
+        if(!f) return false;
+    }
+    f.flush();
+    f.close();
+    auto sz = fs::file_size(p, ec);
+    if(ec) return false;
+    return sz == n;
+}
+
+// A line such as "  401000:\tpush rbp" marks real disassembly rather than a usage or error message.
+static inline bool containsAsmLine(const std::string& s){
+    size_t i = 0;
+    while(i < s.size()){
+        size_t j = i;
+        while(j < s.size() && (s[j]==' ' || s[j]=='\t')) j++;
+        size_t h = j;
+        while(j < s.size() && std::isxdigit((unsigned char)s[j])) j++;
+        if(j > h && j + 1 < s.size() && s[j]==':' && (s[j+1]==' ' || s[j+1]=='\t')) return true;
+        size_t nl = s.find('\n', j);
+        if(nl == std::string::npos) break;
+        i = nl + 1;
+    }
+    return false;
+}
+
+// Streams the command's output to out and checks the first 4 MiB for disassembly on the way,
+// so the file is never read back.
+static inline size_t runCapture(const std::string& cmd, const fs::path& out, bool& sawAsm){
+    sawAsm = false;
+#if defined(_WIN32)
+    FILE* pipe = _popen(cmd.c_str(), "r");
+#else
+    FILE* pipe = popen(cmd.c_str(), "r");
+#endif
+    if(!pipe) return 0;
+    std::ofstream f(out, std::ios::binary | std::ios::trunc);
+    const size_t cap = 4*1024*1024;
+    std::string head;
+    char buf[8192];
+    size_t total = 0;
+    if(f){
+        for(;;){
+            size_t r = fread(buf, 1, sizeof(buf), pipe);
+            if(r == 0) break;
+            f.write(buf, static_cast<std::streamsize>(r));
+            if(head.size() < cap) head.append(buf, std::min(r, cap - head.size()));
+            total += r;
+        }
+        f.flush();
+    }
+#if defined(_WIN32)
+    _pclose(pipe);
+#else
+    pclose(pipe);
+#endif
+    sawAsm = containsAsmLine(head);
+    return total;
+}
+
+static inline std::string getExecDir(){
+#if defined(_WIN32)
+    char buf[MAX_PATH];
+    DWORD n = GetModuleFileNameA(NULL, buf, MAX_PATH);
+    if(n==0 || n==MAX_PATH) return fs::current_path().string();
+    fs::path p(buf);
+    return p.remove_filename().string();
+#elif defined(__APPLE__)
+    char buf[4096];
+    uint32_t sz = sizeof(buf);
+    if(_NSGetExecutablePath(buf, &sz) != 0) return fs::current_path().string();
+    fs::path p = fs::weakly_canonical(fs::path(buf));
+    return p.remove_filename().string();
+#else
+    char buf[4096];
+    ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf)-1);
+    if(n <= 0) return fs::current_path().string();
+    buf[n] = '\0';
+    fs::path p = fs::weakly_canonical(fs::path(buf));
+    return p.remove_filename().string();
+#endif
+}
+
+static inline fs::path firstWritable(const std::vector<fs::path>& candidates){
+    std::error_code ec;
+    for(const auto& c: candidates){
+        fs::create_directories(c, ec);
+        if(!ec){
+            std::ofstream t(c / ".touch", std::ios::binary | std::ios::trunc);
+            if(t){ t.write("",0); t.close(); fs::remove(c / ".touch", ec); return c; }
+        }
+    }
+    return fs::current_path();
+}
+
+static inline fs::path resultDirRoot(){
+    std::vector<fs::path> cand;
+    cand.push_back(fs::path(getExecDir()) / "result");
+    cand.push_back(fs::current_path() / "result");
+#if !defined(_WIN32)
+    const char* home = std::getenv("HOME");
+    if(home && *home) cand.push_back(fs::path(home) / ".cryptoscanner" / "result");
+    cand.push_back(fs::path("/tmp") / "CryptoScanner" / "result");
+#endif
+    return firstWritable(cand);
+}
+
+// Quotes a path for the shell popen runs: single quotes on POSIX, where nothing inside them is
+// expanded ($, backticks, \), double quotes for cmd.exe, which expands neither.
+static inline std::string q(const std::string& s){
+    std::string out;
+    out.reserve(s.size()+2);
+#if defined(_WIN32)
+    out.push_back('"');
+    for(char c: s){
+        if(c=='"') out.push_back('\\');
+        out.push_back(c);
+    }
+    out.push_back('"');
+#else
+    out.push_back('\'');
+    for(char c: s){
+        if(c=='\'') out += "'\\''";
+        else out.push_back(c);
+    }
+    out.push_back('\'');
+#endif
+    return out;
+}
+
+static inline bool truncateFile(const fs::path& p){
+    std::error_code ec;
+    std::ofstream f(p, std::ios::binary | std::ios::trunc);
+    if(!f) return false;
+    f.flush();
+    f.close();
+    return !fs::exists(p, ec) || fs::file_size(p, ec) == 0;
+}
+
+static inline uint16_t rd16le(const unsigned char* p){ return (uint16_t)p[0] | ((uint16_t)p[1]<<8); }
+static inline uint32_t rd32le(const unsigned char* p){ return (uint32_t)p[0] | ((uint32_t)p[1]<<8) | ((uint32_t)p[2]<<16) | ((uint32_t)p[3]<<24); }
+
+
+static inline std::string elfMachine(const std::vector<unsigned char>& buf){
+    if(buf.size()<20) return "";
+    uint16_t e = (uint16_t)buf[18] | ((uint16_t)buf[19]<<8);
+    switch(e){
+        case 3: return "i386";
+        case 62: return "i386:x86-64";
+        case 40: return "arm";
+        case 183: return "aarch64";
+        case 20: return "ppc";
+        case 21: return "ppc64";
+        default: return "";
+    }
+}
+
+static inline std::string peMachine(const std::vector<unsigned char>& buf){
+    if(buf.size() < 0x3C+4) return "";
+    uint32_t peoff = rd32le(&buf[0x3C]);
+    if(buf.size() < peoff + 6) return "";
+    if(!(buf[peoff]=='P' && buf[peoff+1]=='E' && buf[peoff+2]==0 && buf[peoff+3]==0)) return "";
+    uint16_t m = rd16le(&buf[peoff+4]);
+    switch(m){
+        case 0x014c: return "i386";
+        case 0x8664: return "i386:x86-64";
+        case 0x01c0: return "arm";
+        case 0x01c4: return "armv7";
+        case 0xAA64: return "aarch64";
+        default: return "";
+    }
+}
+
+static inline bool moveOrCopy(const fs::path& src, const fs::path& dst){
+    std::error_code ec;
+    fs::create_directories(dst.parent_path(), ec);
+    fs::rename(src, dst, ec);
+    if(!ec) return true;
+    std::ifstream in(src, std::ios::binary);
+    if(!in) return false;
+    std::ofstream out(dst, std::ios::binary | std::ios::trunc);
+    if(!out) return false;
+    std::vector<char> buf(1<<20);
+    while(in){
+        in.read(buf.data(), (std::streamsize)buf.size());
+        std::streamsize g = in.gcount();
+        if(g>0) out.write(buf.data(), g);
+    }
+    out.flush();
+    in.close();
+    fs::remove(src, ec);
+    return true;
+}
+
+static inline bool splitIntoTenBySize(const fs::path& asmPath, const fs::path& chunksDir, const std::string& hash){
+    std::error_code ec;
+    fs::create_directories(chunksDir, ec);
+    ec.clear();
+    auto total = fs::file_size(asmPath, ec);
+    if(ec || total == 0) return false;
+    std::ifstream in(asmPath, std::ios::binary);
+    if(!in) return false;
+    std::vector<uint64_t> parts(10, 0);
+    uint64_t base = total / 10;
+    uint64_t rem = total % 10;
+    for(int i=0;i<10;i++){ parts[i] = base + (i < (int)rem ? 1 : 0); }
+    const size_t BUFSZ = 1<<20;
+    std::vector<char> buf(BUFSZ);
+    for(int i=0;i<10;i++){
+        fs::path out = chunksDir / (hash + "_" + zpad(i+1,4) + ".asm");
+        std::ofstream o(out, std::ios::binary | std::ios::trunc);
+        if(!o) return false;
+        uint64_t left = parts[i];
+        while(left){
+            size_t take = (left > BUFSZ) ? BUFSZ : (size_t)left;
+            in.read(buf.data(), (std::streamsize)take);
+            std::streamsize got = in.gcount();
+            if(got <= 0) break;
+            o.write(buf.data(), got);
+            left -= (uint64_t)got;
+            if((uint64_t)got < take) break;
+        }
+        o.flush();
+    }
+    return true;
+}
+
+static inline size_t tryCmdChecked(const std::string& cmd, const fs::path& outAsm){
+    bool sawAsm = false;
+    size_t wrote = runCapture(cmd, outAsm, sawAsm);
+    if(wrote < 32 || !sawAsm) { truncateFile(outAsm); return 0; }
+    return wrote;
+}
+
+static inline size_t tryCmdSectionChecked(const std::string& baseCmd, const std::string& filePath, const std::string& section, const fs::path& outAsm){
+    return tryCmdChecked(baseCmd + " -j " + section + " " + q(filePath), outAsm);
+}
+
+static inline size_t disassembleWithCandidatesPE(const std::string& arch, const std::string& filePath, const fs::path& outAsm){
+    const char* sections[] = {".text","CODE",".code",".text$mn",".init",".text.startup"};
+    size_t wrote = 0;
+    if(arch=="i386"){
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("i686-w64-mingw32-objdump -d -M intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        // Try macOS homebrew llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("objdump -d -M intel -b pei-i386", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("i686-w64-mingw32-objdump -d -M intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        // Try macOS homebrew llvm-objdump
+        wrote = tryCmdChecked(std::string("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("objdump -d -M intel -b pei-i386 ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("objdump -D -M intel -b pei-i386 ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("objdump -D -M intel -b binary -m i386 ") + q(filePath), outAsm);
+        return wrote;
+    }else if(arch=="i386:x86-64"){
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("x86_64-w64-mingw32-objdump -d -M intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        // Try macOS homebrew llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("objdump -d -M intel -b pei-x86-64", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("x86_64-w64-mingw32-objdump -d -M intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        // Try macOS homebrew llvm-objdump
+        wrote = tryCmdChecked(std::string("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("objdump -d -M intel -b pei-x86-64 ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("objdump -D -M intel -b pei-x86-64 ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        wrote = tryCmdChecked(std::string("objdump -D -M intel -b binary -m i386:x86-64 ") + q(filePath), outAsm);
+        return wrote;
+    }else{
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        // Try macOS homebrew llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        // Try macOS homebrew llvm-objdump
+        wrote = tryCmdChecked(std::string("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn ") + q(filePath), outAsm);
+        return wrote;
+    }
+}
+
+static inline size_t disassembleWithCandidatesELF(const std::string& arch, const std::string& filePath, const fs::path& outAsm){
+    const char* sections[] = {".text",".init",".text.startup"};
+    size_t wrote = 0;
+    if(arch=="i386"||arch=="i386:x86-64"){
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("objdump -d -M intel --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("objdump -d -M intel --no-show-raw-insn ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        // Try macOS homebrew llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        // Try macOS homebrew llvm-objdump
+        wrote = tryCmdChecked(std::string("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        return wrote;
+    }else{
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("objdump -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("objdump -d --no-show-raw-insn ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        // Try macOS homebrew llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+        // Try macOS homebrew llvm-objdump
+        wrote = tryCmdChecked(std::string("/opt/homebrew/bin/llvm-objdump -d --no-show-raw-insn ") + q(filePath), outAsm);
+        return wrote;
+    }
+}
+
+static inline size_t disassembleWithCandidatesWindows(const std::string& arch, const std::string& filePath, const fs::path& outAsm){
+    const char* sections[] = {".text","CODE",".code",".text$mn",".init",".text.startup"};
+    size_t wrote = 0;
+
+    // Try llvm-objdump first (most likely to be available)
+    if(arch=="i386"){
+        // Intel 32-bit
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+        // Try alternative paths for llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("\"C:\\Program Files\\LLVM\\bin\\llvm-objdump.exe\" -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("\"C:\\Program Files\\LLVM\\bin\\llvm-objdump.exe\" -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+    }else if(arch=="i386:x86-64"){
+        // Intel 64-bit
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+        // Try alternative paths for llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("\"C:\\Program Files\\LLVM\\bin\\llvm-objdump.exe\" -d --no-show-raw-insn --x86-asm-syntax=intel", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("\"C:\\Program Files\\LLVM\\bin\\llvm-objdump.exe\" -d --no-show-raw-insn --x86-asm-syntax=intel ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+    }else{
+        // ARM or other architectures
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("llvm-objdump -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("llvm-objdump -d --no-show-raw-insn ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+        // Try alternative paths for llvm-objdump
+        for(const char* s: sections){
+            wrote = tryCmdSectionChecked("\"C:\\Program Files\\LLVM\\bin\\llvm-objdump.exe\" -d --no-show-raw-insn", filePath, s, outAsm);
+            if(wrote) return wrote;
+        }
+        wrote = tryCmdChecked(std::string("\"C:\\Program Files\\LLVM\\bin\\llvm-objdump.exe\" -d --no-show-raw-insn ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+    }
+
+    // Try dumpbin as fallback (part of Visual Studio)
+    if(arch=="i386" || arch=="i386:x86-64"){
+        wrote = tryCmdChecked(std::string("dumpbin /DISASM ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+        // Try with full path to dumpbin
+        wrote = tryCmdChecked(std::string("\"C:\\Program Files (x86)\\Microsoft Visual Studio\\2019\\Community\\VC\\Tools\\MSVC\\14.29.30133\\bin\\Hostx64\\x64\\dumpbin.exe\" /DISASM ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+
+        wrote = tryCmdChecked(std::string("\"C:\\Program Files\\Microsoft Visual Studio\\2022\\Community\\VC\\Tools\\MSVC\\14.39.33519\\bin\\Hostx64\\x64\\dumpbin.exe\" /DISASM ") + q(filePath), outAsm);
+        if(wrote) return wrote;
+    }
+
+    return 0;
+}
+
+static inline size_t disassembleTextOnlyToFile(const std::string& filePath, const std::vector<unsigned char>& buf, const fs::path& outAsm){
+#if defined(_WIN32)
+    if(isPE(buf)){
+        std::string m = peMachine(buf);
+        return disassembleWithCandidatesWindows(m, filePath, outAsm);
+    }else if(isELF(buf)){
+        // ELF on Windows (cross-compiled or WSL binaries)
+        std::string m = elfMachine(buf);
+        return disassembleWithCandidatesWindows(m, filePath, outAsm);
+    }else{
+        return 0;
+    }
+#else
+    if(isELF(buf)){
+        std::string m = elfMachine(buf);
+        return disassembleWithCandidatesELF(m, filePath, outAsm);
+    }else if(isPE(buf)){
+        std::string m = peMachine(buf);
+        return disassembleWithCandidatesPE(m, filePath, outAsm);
+    }else{
+        return 0;
+    }
+#endif
+}
+
+static inline bool splitOrPlaceAsmBySize(const fs::path& tmpAsm, const fs::path& finalAsm, const fs::path& chunksDir, const std::string& hash){
+    std::error_code ecf;
+    auto sz = fs::file_size(tmpAsm, ecf);
+    if(ecf || sz == 0) return false;
+    const uint64_t threshold = 10ull * 1024ull * 1024ull;
+    if(sz <= threshold){
+        return moveOrCopy(tmpAsm, finalAsm);
+    }else{
+        bool ok = splitIntoTenBySize(tmpAsm, chunksDir, hash);
+        std::error_code ecr; fs::remove(tmpAsm, ecr);
+        return ok;
+    }
+}
+
+
+}
+
+Exporter::~Exporter(){
+    finish();
+}
+
+bool Exporter::isExecutable(const std::vector<unsigned char>& bytes){
+    return isELF(bytes) || isPE(bytes) || isAr(bytes);
+}
+
+void Exporter::start(const ExportOptions& o){
+    finish();
+    opt = o;
+    root = opt.outDir.empty() ? (resultDirRoot() / "artifacts").string() : opt.outDir;
+    std::error_code ec;
+    fs::create_directories(root, ec);
+    {
+        std::lock_guard<std::mutex> lk(m);
+        stopping = false;
+        seen.clear();
+        st = ExportStats();
+    }
+    const unsigned n = std::max(1u, opt.workers);
+    for(unsigned i=0;i<n;i++) pool.emplace_back([this]{ work(); });
+}
+
+void Exporter::stage(const std::string& displayPath, const std::string& diskPath, const std::vector<unsigned char>& bytes){
+    if(!running() || !isExecutable(bytes)) return;
+    Job job;
+    job.displayPath = displayPath;
+    job.diskPath = diskPath;
+    if(diskPath.empty()) job.bytes = std::make_shared<const std::vector<unsigned char>>(bytes);
+    bool full;
+    {
+        std::lock_guard<std::mutex> lk(stageMutex);
+        stagedBytes += job.bytes ? job.bytes->size() : 0;
+        staged.push_back(std::move(job));
+        full = staged.size() >= opt.maxQueued || stagedBytes >= opt.maxQueuedBytes;
+    }
+    // Copies held for the next flush count against the same limits as the queue; past them the
+    // staging thread hands them over itself and waits for room like flush() does.
+    if(full) flush();
+}
+
+void Exporter::flush(){
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lk(stageMutex);
+        jobs.swap(staged);
+        stagedBytes = 0;
+    }
+    if(jobs.empty()) return;
+    std::unique_lock<std::mutex> lk(m);
+    for(auto& job : jobs){
+        const std::uint64_t n = job.bytes ? job.bytes->size() : 0;
+        space.wait(lk, [&]{
+            return stopping || queue.empty() || (queue.size() < opt.maxQueued && queuedBytes + n <= opt.maxQueuedBytes);
+        });
+        if(stopping) continue;
+        queuedBytes += n;
+        queue.push_back(std::move(job));
+        cv.notify_one();
+    }
+}
+
+void Exporter::finish(){
+    if(pool.empty()) return;
+    flush();
+    {
+        std::lock_guard<std::mutex> lk(m);
+        stopping = true;
+    }
+    cv.notify_all();
+    space.notify_all();
+    for(auto& t : pool) t.join();
+    pool.clear();
+}
+
+ExportStats Exporter::stats() const {
+    std::lock_guard<std::mutex> lk(m);
+    return st;
+}
+
+void Exporter::work(){
+    for(;;){
+        Job job;
+        {
+            std::unique_lock<std::mutex> lk(m);
+            cv.wait(lk, [&]{ return stopping || !queue.empty(); });
+            if(queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+            queuedBytes -= job.bytes ? job.bytes->size() : 0;
+        }
+        space.notify_all();
+        exportOne(job);
+    }
+}
+
+void Exporter::exportOne(const Job& job){
+    std::vector<unsigned char> local;
+    const std::vector<unsigned char>* data = job.bytes.get();
+    if(!data){
+        if(!readAll(job.diskPath, local)){
+            std::lock_guard<std::mutex> lk(m);
+            ++st.failed;
+            return;
+        }
+        data = &local;
+    }
+    const std::string hash = sha256Hex(*data);
+    if(hash.empty()){
+        std::lock_guard<std::mutex> lk(m);
+        ++st.failed;
+        return;
+    }
+    bool fresh = false;
+    {
+        std::lock_guard<std::mutex> lk(m);
+        fresh = seen.insert(hash).second;
+    }
+    const fs::path dir(root);
+    const fs::path bin = dir / (hash + ".bin");
+    std::error_code ec;
+    // Left by an earlier run.
+    if(fresh && fs::exists(bin, ec) && fs::file_size(bin, ec) == data->size()) fresh = false;
+
+    bool ok = true, disasm = false;
+    if(fresh){
+        ok = writeAll(bin, data->data(), data->size());
+        const fs::path tmpAsm = dir / (hash + ".text.tmp");
+        const fs::path finalAsm = dir / (hash + ".asm");
+        const fs::path chunksDir = dir / (hash + ".chunks");
+        // The disassemblers read the exported copy, so archive entries get a listing too.
+        if(ok && disassembleTextOnlyToFile(bin.string(), *data, tmpAsm)){
+            disasm = splitOrPlaceAsmBySize(tmpAsm, finalAsm, chunksDir, hash);
+        }
+        if(!disasm){
+            std::error_code ecd1; fs::remove(tmpAsm, ecd1);
+            std::error_code ecd2; fs::remove_all(chunksDir, ecd2);
+            std::error_code ecd3; fs::remove(finalAsm, ecd3);
+        }
+    }
+    if(ok){
+        std::lock_guard<std::mutex> lk(indexMutex);
+        std::ofstream idx(dir / "index.tsv", std::ios::binary | std::ios::app);
+        idx << hash << '\t' << job.displayPath << '\n';
+    }
+    std::lock_guard<std::mutex> lk(m);
+    if(!ok) ++st.failed;
+    else if(fresh) ++st.exported;
+    else ++st.deduped;
+    if(disasm) ++st.disassembled;
+}
+
+}
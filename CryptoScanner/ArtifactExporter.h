@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace artifact {
+
+struct ExportOptions {
+    std::string outDir;                    // empty: <result>/artifacts next to the executable
+    unsigned workers = 2;
+    std::size_t maxQueued = 64;
+    std::uint64_t maxQueuedBytes = 256ull << 20;
+};
+
+struct ExportStats {
+    std::uint64_t exported = 0;
+    std::uint64_t deduped = 0;
+    std::uint64_t disassembled = 0;
+    std::uint64_t failed = 0;
+};
+
+// Opt-in export of scanned executables (ELF, PE, ar) for offline review: a copy of the bytes and,
+// when an objdump is available, an Intel-syntax disassembly. Artifacts are content-addressed by
+// SHA-256 under outDir (<hash>.bin, <hash>.asm or <hash>.chunks/), each export is recorded in
+// index.tsv, and identical content is written once. Any thread may stage artifacts (archive
+// entry workers included); the thread that emits detections flushes them afterwards, and a
+// bounded pool does the I/O and runs the disassemblers, so flush() only blocks when the queue is
+// full.
+class Exporter {
+public:
+    Exporter() = default;
+    ~Exporter();
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+    void start(const ExportOptions& opt);
+    bool running() const { return !pool.empty(); }
+
+    // Records an artifact until the next flush(). diskPath names a file to read later; when it is
+    // empty the bytes are copied. Non-executables are ignored. Once the staged copies reach
+    // maxQueued or maxQueuedBytes they are flushed here, blocking while the queue is full.
+    void stage(const std::string& displayPath, const std::string& diskPath, const std::vector<unsigned char>& bytes);
+    // Hands everything staged so far, by any thread, to the pool.
+    void flush();
+    // Waits for queued exports and stops the pool.
+    void finish();
+
+    ExportStats stats() const;
+
+    static bool isExecutable(const std::vector<unsigned char>& bytes);
+
+private:
+    struct Job {
+        std::string displayPath;
+        std::string diskPath;
+        std::shared_ptr<const std::vector<unsigned char>> bytes;
+    };
+
+    void work();
+    void exportOne(const Job& job);
+
+    std::mutex stageMutex;
+    std::vector<Job> staged;
+    std::uint64_t stagedBytes = 0;
+
+    ExportOptions opt;
+    std::string root;
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::condition_variable space;
+    std::deque<Job> queue;
+    std::uint64_t queuedBytes = 0;
+    bool stopping = false;
+    std::vector<std::thread> pool;
+    std::unordered_set<std::string> seen;
+    std::mutex indexMutex;
+    ExportStats st;
+};
+
+}
@@ -0,0 +1,188 @@
+#include "AstRuleEngine.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace analyzers {
+
+namespace {
+
+std::string normalizeLang(std::string lang){
+    for(auto& c : lang) c = (char)std::tolower((unsigned char)c);
+    if(lang == "c" || lang == "c++" || lang == "cxx") return "cpp";
+    if(lang == "py") return "python";
+    if(lang == "cpp" || lang == "java" || lang == "python") return lang;
+    return {};
+}
+
+// Accepts a leading "(?i)" for case-insensitive matching, which ECMAScript std::regex lacks.
+bool compileRuleRegex(const std::string& src, std::regex& out){
+    auto flags = std::regex::ECMAScript;
+    std::string body = src;
+    if(body.rfind("(?i)", 0) == 0){
+        body = body.substr(4);
+        flags |= std::regex::icase;
+    }
+    try{
+        out = std::regex(body, flags);
+    }catch(...){
+        return false;
+    }
+    return true;
+}
+
+std::string compactCallee(std::string_view callee){
+    std::string key;
+    key.reserve(callee.size());
+    for(char c : callee) if(!std::isspace((unsigned char)c)) key.push_back(c);
+    return key;
+}
+
+std::string leadingSegment(const std::string& callee, bool& qualified){
+    std::size_t end = callee.size();
+    for(std::size_t i = 0; i < callee.size(); ++i){
+        const char c = callee[i];
+        if(c == '.' || (c == ':' && i + 1 < callee.size() && callee[i+1] == ':') || (c == '-' && i + 1 < callee.size() && callee[i+1] == '>')){
+            end = i;
+            break;
+        }
+    }
+    qualified = end < callee.size();
+    return callee.substr(0, end);
+}
+
+bool endsWithSegment(const std::string& callee, const std::string& seg){
+    if(callee.size() <= seg.size() || callee.compare(callee.size() - seg.size(), seg.size(), seg) != 0) return false;
+    const char c = callee[callee.size() - seg.size() - 1];
+    return c == '.' || c == ':' || c == '>';
+}
+
+bool regexSearch(const std::regex& re, const std::string& s){
+    try{
+        return std::regex_search(s, re);
+    }catch(...){
+        return false;
+    }
+}
+
+}
+
+std::size_t AstRuleEngine::load(const std::vector<pattern_loader::AstRule>& rules){
+    compiled.clear();
+    byLang.clear();
+    for(const auto& r : rules){
+        const std::string lang = normalizeLang(r.lang);
+        if(lang.empty()) continue;
+        std::vector<std::string> callees = r.callees;
+        if(!r.callee.empty()) callees.push_back(r.callee);
+        if(callees.empty()) continue;
+
+        Compiled c;
+        c.rule = r;
+        c.rule.lang = lang;
+        if(!r.arg_regex.empty()){
+            if(!compileRuleRegex(r.arg_regex, c.argRegex)) continue;
+            c.hasArgRegex = true;
+        }
+        if(!r.kw_value_regex.empty()){
+            if(!compileRuleRegex(r.kw_value_regex, c.kwRegex)) continue;
+            c.hasKwRegex = true;
+        }
+        const std::size_t idx = compiled.size();
+        compiled.push_back(std::move(c));
+        CalleeIndex& index = byLang[lang];
+        for(const auto& name : callees){
+            std::string key = compactCallee(name);
+            if(!key.empty()) index[key].push_back(idx);
+        }
+    }
+    return compiled.size();
+}
+
+template <class F>
+void AstRuleEngine::forEachRule(const std::string& lang, std::string_view callee, F&& fn) const {
+    auto li = byLang.find(lang);
+    if(li == byLang.end() || callee.empty()) return;
+    const CalleeIndex& index = li->second;
+    const std::string key = compactCallee(callee);
+    auto visit = [&](std::size_t from){
+        auto it = index.find(key.substr(from));
+        if(it == index.end()) return false;
+        for(std::size_t idx : it->second){
+            if(fn(compiled[idx])) return true;
+        }
+        return false;
+    };
+    if(visit(0)) return;
+    for(std::size_t i = 0; i + 1 < key.size(); ++i){
+        std::size_t from = 0;
+        if(key[i] == '.') from = i + 1;
+        else if((key[i] == ':' && key[i+1] == ':') || (key[i] == '-' && key[i+1] == '>')) from = i + 2;
+        if(!from || from >= key.size()) continue;
+        if(visit(from)) return;
+    }
+}
+
+bool AstRuleEngine::hasCallee(const std::string& lang, std::string_view callee) const {
+    bool hit = false;
+    forEachRule(lang, callee, [&](const Compiled&){ hit = true; return true; });
+    return hit;
+}
+
+bool AstRuleEngine::argsMatch(const Compiled& c, const AstSymbol& s) const {
+    const auto& r = c.rule;
+    if(r.arg_index >= 0){
+        if((std::size_t)r.arg_index >= s.args.size()) return false;
+        if(c.hasArgRegex && !regexSearch(c.argRegex, s.args[(std::size_t)r.arg_index])) return false;
+    }else if(c.hasArgRegex){
+        bool any = false;
+        for(const auto& a : s.args){
+            if(regexSearch(c.argRegex, a)){ any = true; break; }
+        }
+        if(!any) return false;
+    }
+    if(!r.kw.empty()){
+        const std::string* value = nullptr;
+        for(const auto& kv : s.kwargs){
+            if(kv.first == r.kw){ value = &kv.second; break; }
+        }
+        if(!value) return false;
+        if(c.hasKwRegex && !regexSearch(c.kwRegex, *value)) return false;
+    }
+    return true;
+}
+
+std::vector<const pattern_loader::AstRule*> AstRuleEngine::evaluate(const AstSymbol& s) const {
+    std::vector<const pattern_loader::AstRule*> out;
+    auto check = [&](const Compiled& c){
+        if(std::find(out.begin(), out.end(), &c.rule) == out.end() && argsMatch(c, s)) out.push_back(&c.rule);
+        return false;
+    };
+    forEachRule(s.lang, s.callee_full, check);
+    if(out.empty() && s.callee_base != s.callee_full) forEachRule(s.lang, s.callee_base, check);
+    return out;
+}
+
+std::vector<std::string> AstRuleEngine::calleeLiterals() const {
+    std::vector<std::string> out;
+    for(const auto& c : compiled){
+        std::vector<std::string> callees = c.rule.callees;
+        if(!c.rule.callee.empty()) callees.push_back(c.rule.callee);
+        for(const auto& name : callees){
+            bool qualified = false;
+            std::string lead = leadingSegment(compactCallee(name), qualified);
+            if(lead.empty()) continue;
+            if(!qualified){
+                bool alias = false;
+                for(const auto& other : callees){
+                    if(&other != &name && endsWithSegment(compactCallee(other), lead)){ alias = true; break; }
+                }
+                if(alias) continue;
+            }
+            out.push_back(lead);
+        }
+    }
+    return out;
+}
+
+}
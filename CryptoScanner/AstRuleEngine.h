@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ASTSymbol.h"
+#include "PatternLoader.h"
+
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace analyzers {
+
+// Evaluates pattern_loader::AstRule entries against collected call sites. Rules are indexed by
+// language and callee, so a call only pays for the rules whose callee it names exactly or as a
+// '.', '::' or '->' separated suffix.
+class AstRuleEngine {
+public:
+    // Skips rules without a callee, with an unknown language or with a regex that does not compile.
+    // Returns the number of rules indexed.
+    std::size_t load(const std::vector<pattern_loader::AstRule>& rules);
+
+    bool empty() const { return compiled.empty(); }
+    bool hasCallee(const std::string& lang, std::string_view callee) const;
+    std::vector<const pattern_loader::AstRule*> evaluate(const AstSymbol& s) const;
+    // Leading identifier of every rule callee, e.g. "hashlib" for "hashlib.new". A bare callee that
+    // also appears qualified in the same rule ("initialize" next to "KeyPairGenerator.initialize")
+    // is left out, since the qualifier is what a source file has to mention.
+    std::vector<std::string> calleeLiterals() const;
+
+private:
+    struct Compiled {
+        pattern_loader::AstRule rule;
+        bool hasArgRegex = false;
+        bool hasKwRegex = false;
+        std::regex argRegex;
+        std::regex kwRegex;
+    };
+    using CalleeIndex = std::unordered_map<std::string, std::vector<std::size_t>>;
+
+    template <class F> void forEachRule(const std::string& lang, std::string_view callee, F&& fn) const;
+    bool argsMatch(const Compiled& c, const AstSymbol& s) const;
+
+    std::vector<Compiled> compiled;
+    std::unordered_map<std::string, CalleeIndex> byLang;
+};
+
+}
@@ -0,0 +1,173 @@
+#include "ConstantScanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CONSTANT_SCANNER_SSSE3 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CONSTANT_SCANNER_NEON 1
+#endif
+
+namespace analyzers {
+
+namespace {
+
+using MaskTable = std::uint8_t[4][2][16];
+
+inline std::uint8_t probe(const MaskTable& masks, const unsigned char* p){
+    std::uint8_t m = 0xFF;
+    for(int k = 0; k < 4; ++k) m &= masks[k][0][p[k] & 15] & masks[k][1][p[k] >> 4];
+    return m;
+}
+
+#if defined(CONSTANT_SCANNER_SSSE3)
+__attribute__((target("ssse3")))
+bool scanSsse3(const unsigned char* p, std::size_t to, const MaskTable& masks, std::size_t& pos, std::uint8_t* lanes)
+{
+    const __m128i nib = _mm_set1_epi8(0x0F);
+    __m128i t[4][2];
+    for(int k = 0; k < 4; ++k)
+        for(int h = 0; h < 2; ++h) t[k][h] = _mm_loadu_si128((const __m128i*)masks[k][h]);
+    while(pos + 19 <= to){
+        __m128i m = _mm_set1_epi8((char)0xFF);
+        for(int k = 0; k < 4; ++k){
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + pos + k));
+            const __m128i lo = _mm_and_si128(v, nib);
+            const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nib);
+            m = _mm_and_si128(m, _mm_and_si128(_mm_shuffle_epi8(t[k][0], lo), _mm_shuffle_epi8(t[k][1], hi)));
+        }
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(m, _mm_setzero_si128())) != 0xFFFF){
+            _mm_storeu_si128((__m128i*)lanes, m);
+            return true;
+        }
+        pos += 16;
+    }
+    return false;
+}
+#endif
+
+#if defined(CONSTANT_SCANNER_NEON)
+bool scanNeon(const unsigned char* p, std::size_t to, const MaskTable& masks, std::size_t& pos, std::uint8_t* lanes)
+{
+    const uint8x16_t nib = vdupq_n_u8(0x0F);
+    uint8x16_t t[4][2];
+    for(int k = 0; k < 4; ++k)
+        for(int h = 0; h < 2; ++h) t[k][h] = vld1q_u8(masks[k][h]);
+    while(pos + 19 <= to){
+        uint8x16_t m = vdupq_n_u8(0xFF);
+        for(int k = 0; k < 4; ++k){
+            const uint8x16_t v = vld1q_u8(p + pos + k);
+            m = vandq_u8(m, vandq_u8(vqtbl1q_u8(t[k][0], vandq_u8(v, nib)), vqtbl1q_u8(t[k][1], vshrq_n_u8(v, 4))));
+        }
+        if(vmaxvq_u8(m) != 0){
+            vst1q_u8(lanes, m);
+            return true;
+        }
+        pos += 16;
+    }
+    return false;
+}
+#endif
+
+std::vector<unsigned char> encode(const ConstantPattern& t, bool bigEndian){
+    std::vector<unsigned char> out;
+    out.reserve(t.words.size() * t.wordBytes);
+    for(std::uint64_t w : t.words){
+        for(unsigned i = 0; i < t.wordBytes; ++i){
+            const unsigned shift = bigEndian ? (t.wordBytes - 1 - i) * 8 : i * 8;
+            out.push_back((unsigned char)(w >> shift));
+        }
+    }
+    return out;
+}
+
+}
+
+void ConstantScanner::build(const std::vector<ConstantPattern>& in){
+    tables = in;
+    needles.clear();
+    for(auto& b : bucketNeedles) b.clear();
+    std::memset(masks, 0, sizeof(masks));
+    for(std::size_t ti = 0; ti < tables.size(); ++ti){
+        const ConstantPattern& t = tables[ti];
+        if(t.wordBytes == 0 || t.words.size() * t.wordBytes < 4) continue;
+        const std::size_t required = (std::size_t)std::ceil(t.minMatch * (double)t.words.size());
+        for(int be = 0; be < (t.wordBytes > 1 ? 2 : 1); ++be){
+            Needle n{ ti, be != 0, encode(t, be != 0), std::max<std::size_t>(required, 1) };
+            // A table whose words read the same both ways (e.g. all bytes equal) needs one needle.
+            if(be && n.bytes == needles.back().bytes) continue;
+            const std::size_t id = needles.size();
+            const std::uint8_t bit = (std::uint8_t)(1u << (id % kBuckets));
+            for(int k = 0; k < 4; ++k){
+                masks[k][0][n.bytes[k] & 15] |= bit;
+                masks[k][1][n.bytes[k] >> 4] |= bit;
+            }
+            bucketNeedles[id % kBuckets].push_back((std::uint16_t)id);
+            needles.push_back(std::move(n));
+        }
+    }
+}
+
+void ConstantScanner::verify(const unsigned char* p, std::size_t to, std::size_t pos, std::uint8_t bits,
+                             std::vector<ConstantHit>& out) const {
+    for(int b = 0; b < kBuckets; ++b){
+        if(!(bits & (1u << b))) continue;
+        for(std::uint16_t id : bucketNeedles[b]){
+            const Needle& n = needles[id];
+            const ConstantPattern& t = tables[n.table];
+            const std::size_t w = t.wordBytes;
+            const std::size_t first = std::max<std::size_t>(w, 4);
+            if(pos + first > to || std::memcmp(p + pos, n.bytes.data(), first) != 0) continue;
+            const std::size_t total = t.words.size();
+            const std::size_t avail = std::min(total, (to - pos) / w);
+            if(avail < n.required) continue;
+            std::size_t matched = 0;
+            for(std::size_t i = 0; i < avail; ++i){
+                if(std::memcmp(p + pos + i * w, n.bytes.data() + i * w, w) == 0) ++matched;
+                // Stop as soon as the rest of the table can no longer reach the threshold.
+                if(matched + (avail - i - 1) < n.required) break;
+            }
+            if(matched >= n.required) out.push_back({ &t, pos, matched, n.bigEndian });
+        }
+    }
+}
+
+std::vector<ConstantHit> ConstantScanner::scan(const std::vector<unsigned char>& data, std::size_t from, std::size_t to) const {
+    std::vector<ConstantHit> out;
+    to = std::min(to, data.size());
+    if(needles.empty() || from >= to || to - from < 4) return out;
+    const unsigned char* p = data.data();
+    std::size_t pos = from;
+#if defined(CONSTANT_SCANNER_SSSE3) || defined(CONSTANT_SCANNER_NEON)
+#if defined(CONSTANT_SCANNER_SSSE3)
+    static const bool simd = __builtin_cpu_supports("ssse3");
+#else
+    static const bool simd = true;
+#endif
+    if(simd){
+        alignas(16) std::uint8_t lanes[16];
+        for(;;){
+#if defined(CONSTANT_SCANNER_SSSE3)
+            if(!scanSsse3(p, to, masks, pos, lanes)) break;
+#else
+            if(!scanNeon(p, to, masks, pos, lanes)) break;
+#endif
+            for(int i = 0; i < 16; ++i){
+                if(lanes[i]) verify(p, to, pos + i, lanes[i], out);
+            }
+            pos += 16;
+        }
+    }
+#endif
+    for(; pos + 4 <= to; ++pos){
+        const std::uint8_t bits = probe(masks, p + pos);
+        if(bits) verify(p, to, pos, bits, out);
+    }
+    return out;
+}
+
+}
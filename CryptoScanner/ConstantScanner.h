@@ -0,0 +1,53 @@
+#pragma once
+
+#include "PatternDefinitions.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace analyzers {
+
+struct ConstantHit {
+    const ConstantPattern* table = nullptr;    // owned by the scanner
+    std::size_t offset = 0;
+    std::size_t matched = 0;    // words equal to the table, counted in place
+    bool bigEndian = false;
+};
+
+// Finds crypto lookup tables (AES S-boxes and T-tables, SHA-2 round constants, the MD5 sine
+// table, DES S-boxes, ...) in binary data. Each table is encoded in both byte orders; the first
+// four bytes of every encoding are folded into per-bucket nibble masks that are probed 16
+// positions at a time (SSSE3 or NEON, scalar otherwise), so a region costs one pass however
+// many tables are loaded. A candidate whose first word matches is compared word by word and
+// reported when at least minMatch of the table is in place, which tolerates patched entries and
+// tables cut off by the end of the region.
+class ConstantScanner {
+public:
+    static constexpr int kBuckets = 8;
+
+    void build(const std::vector<ConstantPattern>& tables);
+    bool empty() const { return needles.empty(); }
+    // Hits in data[from, to); offsets stay relative to data.
+    std::vector<ConstantHit> scan(const std::vector<unsigned char>& data, std::size_t from, std::size_t to) const;
+
+private:
+    struct Needle {
+        std::size_t table;
+        bool bigEndian;
+        std::vector<unsigned char> bytes;    // the whole table, encoded
+        std::size_t required;                // words that must match
+    };
+
+    void verify(const unsigned char* p, std::size_t to, std::size_t pos, std::uint8_t bits,
+                std::vector<ConstantHit>& out) const;
+
+    std::vector<ConstantPattern> tables;
+    std::vector<Needle> needles;
+    std::vector<std::uint16_t> bucketNeedles[kBuckets];
+    // masks[anchor byte][0 = low nibble, 1 = high nibble][nibble value]
+    alignas(16) std::uint8_t masks[4][2][16] = {};
+};
+
+}
@@ -0,0 +1,643 @@
+#include "ContainerReader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+
+#ifdef USE_MINIZ
+#include "third_party/miniz/miniz.h"
+#endif
+
+namespace container {
+
+namespace {
+
+static bool endsWith(const std::string& s, const std::string& suf){
+    return s.size() >= suf.size() && std::equal(suf.rbegin(), suf.rend(), s.rbegin());
+}
+
+static std::string lower(std::string s){
+    for(auto& c : s) c = (char)std::tolower((unsigned char)c);
+    return s;
+}
+
+class Source {
+public:
+    virtual ~Source() = default;
+    virtual std::size_t read(unsigned char* dst, std::size_t n) = 0;
+
+    bool readExact(unsigned char* dst, std::size_t n){
+        std::size_t got = 0;
+        while(got < n){
+            std::size_t r = read(dst + got, n - got);
+            if(r == 0) return false;
+            got += r;
+        }
+        return true;
+    }
+
+    bool skip(std::uint64_t n){
+        unsigned char tmp[16384];
+        while(n > 0){
+            std::size_t want = (std::size_t)std::min<std::uint64_t>(n, sizeof(tmp));
+            std::size_t r = read(tmp, want);
+            if(r == 0) return false;
+            n -= r;
+        }
+        return true;
+    }
+};
+
+class FileSource : public Source {
+public:
+    explicit FileSource(const std::string& path){ f = std::fopen(path.c_str(), "rb"); }
+    ~FileSource() override { if(f) std::fclose(f); }
+    bool ok() const { return f != nullptr; }
+    std::size_t read(unsigned char* dst, std::size_t n) override { return f ? std::fread(dst, 1, n, f) : 0; }
+private:
+    std::FILE* f = nullptr;
+};
+
+class MemSource : public Source {
+public:
+    MemSource(const unsigned char* p, std::size_t n) : data(p), size(n) {}
+    std::size_t read(unsigned char* dst, std::size_t n) override {
+        std::size_t r = std::min(n, size - pos);
+        std::memcpy(dst, data + pos, r);
+        pos += r;
+        return r;
+    }
+private:
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t pos = 0;
+};
+
+class SliceSource : public Source {
+public:
+    SliceSource(Source& in, std::uint64_t n) : inner(in), left(n) {}
+    std::size_t read(unsigned char* dst, std::size_t n) override {
+        std::size_t want = (std::size_t)std::min<std::uint64_t>(n, left);
+        if(want == 0) return 0;
+        std::size_t r = inner.read(dst, want);
+        left -= r;
+        return r;
+    }
+    bool drain(){ return skip(left); }
+private:
+    Source& inner;
+    std::uint64_t left;
+};
+
+class PrefixSource : public Source {
+public:
+    PrefixSource(Source& in, const unsigned char* p, std::size_t n) : inner(in), pre(p, p + n) {}
+    std::size_t read(unsigned char* dst, std::size_t n) override {
+        if(pos < pre.size()){
+            std::size_t r = std::min(n, pre.size() - pos);
+            std::memcpy(dst, pre.data() + pos, r);
+            pos += r;
+            return r;
+        }
+        return inner.read(dst, n);
+    }
+private:
+    Source& inner;
+    std::vector<unsigned char> pre;
+    std::size_t pos = 0;
+};
+
+#ifdef USE_MINIZ
+// Streaming gzip (RFC 1952) on top of tinfl, using the 32 KiB dictionary itself as the output ring.
+class GzipSource : public Source {
+public:
+    explicit GzipSource(Source& in) : inner(in), inBuf(kInBufSize), dict(TINFL_LZ_DICT_SIZE), d(new tinfl_decompressor) {
+        tinfl_init(d.get());
+        ok = parseHeader();
+        if(!ok) done = true;
+    }
+
+    bool valid() const { return ok; }
+    const std::string& storedName() const { return fname; }
+
+    std::size_t read(unsigned char* dst, std::size_t n) override {
+        std::size_t total = 0;
+        while(total < n){
+            if(availLen){
+                std::size_t r = std::min(availLen, n - total);
+                std::memcpy(dst + total, dict.data() + availOfs, r);
+                availOfs += r; availLen -= r; total += r;
+                continue;
+            }
+            if(done) break;
+            if(inPos == inLen && !inEof) refill();
+            std::size_t inBytes = inLen - inPos;
+            std::size_t outBytes = dict.size() - dictOfs;
+            mz_uint32 flags = inEof ? 0 : TINFL_FLAG_HAS_MORE_INPUT;
+            tinfl_status st = tinfl_decompress(d.get(), inBuf.data() + inPos, &inBytes, dict.data(), dict.data() + dictOfs, &outBytes, flags);
+            inPos += inBytes;
+            availOfs = dictOfs;
+            availLen = outBytes;
+            dictOfs = (dictOfs + outBytes) & (dict.size() - 1);
+            if(st == TINFL_STATUS_DONE || st < 0) done = true;
+            else if(st == TINFL_STATUS_NEEDS_MORE_INPUT && inEof && inBytes == 0 && outBytes == 0) done = true;
+        }
+        return total;
+    }
+
+private:
+    static const std::size_t kInBufSize = 64 * 1024;
+
+    void refill(){
+        inLen = inner.read(inBuf.data(), inBuf.size());
+        inPos = 0;
+        if(inLen == 0) inEof = true;
+    }
+
+    bool byte(unsigned char& b){
+        if(inPos == inLen){ if(inEof) return false; refill(); if(inLen == 0) return false; }
+        b = inBuf[inPos++];
+        return true;
+    }
+
+    bool parseHeader(){
+        unsigned char h[10];
+        for(auto& c : h) if(!byte(c)) return false;
+        if(h[0] != 0x1f || h[1] != 0x8b || h[2] != 8) return false;
+        const unsigned char flg = h[3];
+        unsigned char c = 0;
+        if(flg & 4){
+            unsigned char a, b;
+            if(!byte(a) || !byte(b)) return false;
+            for(unsigned xlen = a | (b << 8); xlen > 0; --xlen) if(!byte(c)) return false;
+        }
+        if(flg & 8){
+            while(byte(c) && c) fname.push_back((char)c);
+        }
+        if(flg & 16){
+            while(byte(c) && c) {}
+        }
+        if(flg & 2){
+            if(!byte(c) || !byte(c)) return false;
+        }
+        return true;
+    }
+
+    Source& inner;
+    std::vector<unsigned char> inBuf;
+    std::vector<unsigned char> dict;
+    std::unique_ptr<tinfl_decompressor> d;
+    std::size_t inPos = 0, inLen = 0;
+    bool inEof = false;
+    std::size_t dictOfs = 0, availOfs = 0, availLen = 0;
+    bool done = false;
+    bool ok = false;
+    std::string fname;
+};
+#endif
+
+struct Walker {
+    const Limits& limits;
+    const WantFn& want;
+    const MemberFn& onMember;
+    const Hooks& hooks;
+    std::vector<unsigned char> buf;
+    std::uint64_t total = 0;
+    std::size_t members = 0;
+    bool stopped = false;
+
+    void skipped(const std::string& name, const std::string& reason){
+        if(hooks.skipped) hooks.skipped(name, reason);
+    }
+
+    // Reads (or skips) one member's data from src and dispatches it.
+    bool member(Source& src, const Member& m){
+        if(stopped) return false;
+        bool wanted = m.size > 0 && want(m);
+        if(wanted && limits.maxMembers && members >= limits.maxMembers) wanted = false;
+        if(wanted && m.size > limits.maxMember){
+            skipped(m.name, "larger than the " + std::to_string(limits.maxMember >> 20) + " MiB member limit");
+            wanted = false;
+        }
+        if(wanted && limits.maxTotal && total + m.size > limits.maxTotal){ stopped = true; return false; }
+        if(!wanted) return src.skip(m.size);
+        if(hooks.beforeRead && !hooks.beforeRead(m)){ stopped = true; return false; }
+        buf.resize((std::size_t)m.size);
+        if(!src.readExact(buf.data(), buf.size())) return false;
+        total += m.size;
+        members++;
+        if(!onMember(m, buf)) stopped = true;
+        return !stopped;
+    }
+};
+
+static std::uint64_t parseOctal(const unsigned char* p, std::size_t n){
+    if(n > 0 && (p[0] & 0x80)){
+        std::uint64_t v = 0;
+        for(std::size_t i = 1; i < n; ++i) v = (v << 8) | p[i];
+        return v;
+    }
+    std::uint64_t v = 0;
+    std::size_t i = 0;
+    while(i < n && (p[i] == ' ' || p[i] == 0)) ++i;
+    for(; i < n && p[i] >= '0' && p[i] <= '7'; ++i) v = (v << 3) | (std::uint64_t)(p[i] - '0');
+    return v;
+}
+
+static std::uint64_t parseHex(const unsigned char* p, std::size_t n){
+    std::uint64_t v = 0;
+    for(std::size_t i = 0; i < n; ++i){
+        unsigned char c = p[i];
+        int d = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if(d < 0) break;
+        v = (v << 4) | (std::uint64_t)d;
+    }
+    return v;
+}
+
+static std::string cstr(const unsigned char* p, std::size_t n){
+    std::size_t l = 0;
+    while(l < n && p[l]) ++l;
+    return std::string((const char*)p, l);
+}
+
+static void paxPath(const std::vector<unsigned char>& rec, std::string& path){
+    std::size_t i = 0;
+    while(i < rec.size()){
+        std::size_t sp = i;
+        while(sp < rec.size() && rec[sp] != ' ') ++sp;
+        std::size_t len = (std::size_t)std::strtoull(std::string((const char*)rec.data() + i, sp - i).c_str(), nullptr, 10);
+        if(len == 0 || i + len > rec.size() || sp + 1 >= i + len) break;
+        std::string kv((const char*)rec.data() + sp + 1, i + len - sp - 2);
+        if(kv.rfind("path=", 0) == 0) path = kv.substr(5);
+        i += len;
+    }
+}
+
+static bool walkTar(Source& src, const std::string& prefix, Walker& w){
+    unsigned char h[512];
+    std::string longName;
+    bool any = false;
+    while(!w.stopped){
+        if(!src.readExact(h, sizeof(h))) return any;
+        bool zero = true;
+        for(unsigned char c : h) if(c){ zero = false; break; }
+        if(zero) return true;
+        std::uint64_t sum = 0;
+        for(int i = 0; i < 512; ++i) sum += (i >= 148 && i < 156) ? ' ' : h[i];
+        if(sum != parseOctal(h + 148, 8)) return any;
+        any = true;
+        const char type = (char)h[156];
+        const std::uint64_t size = parseOctal(h + 124, 12);
+        const std::uint64_t padded = (size + 511) & ~511ull;
+        if(type == 'x' || type == 'L'){
+            if(size > (1u << 20)) return false;
+            std::vector<unsigned char> rec((std::size_t)size);
+            if(!src.readExact(rec.data(), rec.size()) || !src.skip(padded - size)) return false;
+            if(type == 'L') longName = cstr(rec.data(), rec.size());
+            else paxPath(rec, longName);
+            continue;
+        }
+        std::string name = longName;
+        longName.clear();
+        if(name.empty()){
+            name = cstr(h, 100);
+            if(std::memcmp(h + 257, "ustar", 5) == 0 && h[345]) name = cstr(h + 345, 155) + "/" + name;
+        }
+        if(type == '0' || type == '\0' || type == '7'){
+            Member m{ prefix + name, size, (std::uint32_t)parseOctal(h + 100, 8) };
+            if(!w.member(src, m)) return w.stopped;
+            if(!src.skip(padded - size)) return false;
+        }else{
+            if(!src.skip(padded)) return false;
+        }
+    }
+    return true;
+}
+
+static bool walkCpio(Source& src, const std::string& prefix, Walker& w){
+    unsigned char h[110];
+    while(!w.stopped){
+        if(!src.readExact(h, sizeof(h))) return false;
+        if(std::memcmp(h, "07070", 5) != 0 || (h[5] != '1' && h[5] != '2')) return false;
+        const std::uint32_t mode = (std::uint32_t)parseHex(h + 14, 8);
+        const std::uint64_t size = parseHex(h + 54, 8);
+        const std::uint64_t nameSize = parseHex(h + 94, 8);
+        if(nameSize == 0 || nameSize > 4096) return false;
+        std::vector<unsigned char> nm((std::size_t)nameSize);
+        if(!src.readExact(nm.data(), nm.size())) return false;
+        if(!src.skip((4 - ((110 + nameSize) & 3)) & 3)) return false;
+        std::string name = cstr(nm.data(), nm.size());
+        if(name == "TRAILER!!!") return true;
+        if((mode & 0170000) == 0100000){
+            Member m{ prefix + name, size, mode & 07777 };
+            if(!w.member(src, m)) return w.stopped;
+        }else if(!src.skip(size)){
+            return false;
+        }
+        if(!src.skip((4 - (size & 3)) & 3)) return false;
+    }
+    return true;
+}
+
+static bool walkTarMaybeGz(Source& src, bool gz, const std::string& prefix, Walker& w){
+    if(!gz) return walkTar(src, prefix, w);
+#ifdef USE_MINIZ
+    GzipSource g(src);
+    if(!g.valid()) return false;
+    return walkTar(g, prefix, w);
+#else
+    return false;
+#endif
+}
+
+static bool walkAr(Source& src, const std::string& prefix, Walker& w){
+    unsigned char magic[8];
+    if(!src.readExact(magic, 8) || std::memcmp(magic, "!<arch>\n", 8) != 0) return false;
+    unsigned char h[60];
+    while(!w.stopped){
+        if(!src.readExact(h, sizeof(h))) return true;
+        if(h[58] != 0x60 || h[59] != '\n') return false;
+        std::string name = cstr(h, 16);
+        while(!name.empty() && (name.back() == ' ' || name.back() == '/')) name.pop_back();
+        const std::uint64_t size = std::strtoull(std::string((const char*)h + 48, 10).c_str(), nullptr, 10);
+        SliceSource slice(src, size);
+        if(name.rfind("data.tar", 0) == 0){
+            if(name == "data.tar") walkTar(slice, prefix + name + "::", w);
+            else if(name == "data.tar.gz") walkTarMaybeGz(slice, true, prefix + name + "::", w);
+            else w.skipped(prefix + name, "payload compression not supported");
+        }
+        if(!slice.drain()) return false;
+        if((size & 1) && !src.skip(1)) return false;
+    }
+    return true;
+}
+
+static bool skipRpmHeader(Source& src, bool pad){
+    unsigned char h[16];
+    if(!src.readExact(h, sizeof(h))) return false;
+    if(h[0] != 0x8e || h[1] != 0xad || h[2] != 0xe8) return false;
+    const std::uint64_t nindex = ((std::uint64_t)h[8] << 24) | ((std::uint64_t)h[9] << 16) | ((std::uint64_t)h[10] << 8) | h[11];
+    const std::uint64_t hsize  = ((std::uint64_t)h[12] << 24) | ((std::uint64_t)h[13] << 16) | ((std::uint64_t)h[14] << 8) | h[15];
+    std::uint64_t body = nindex * 16 + hsize;
+    if(pad) body += (8 - ((16 + body) & 7)) & 7;
+    return src.skip(body);
+}
+
+static bool walkRpm(Source& src, const std::string& prefix, Walker& w){
+    unsigned char lead[96];
+    if(!src.readExact(lead, sizeof(lead))) return false;
+    if(lead[0] != 0xed || lead[1] != 0xab || lead[2] != 0xee || lead[3] != 0xdb) return false;
+    if(!skipRpmHeader(src, true) || !skipRpmHeader(src, false)) return false;
+    unsigned char sniff[6];
+    if(!src.readExact(sniff, sizeof(sniff))) return false;
+    PrefixSource payload(src, sniff, sizeof(sniff));
+    if(std::memcmp(sniff, "07070", 5) == 0) return walkCpio(payload, prefix, w);
+#ifdef USE_MINIZ
+    if(sniff[0] == 0x1f && sniff[1] == 0x8b){
+        GzipSource g(payload);
+        if(!g.valid()) return false;
+        return walkCpio(g, prefix, w);
+    }
+#endif
+    if(std::memcmp(sniff, "\xfd" "7zXZ", 5) == 0) w.skipped(prefix + "payload", "xz payload not supported");
+    else if(std::memcmp(sniff, "\x28\xb5\x2f\xfd", 4) == 0) w.skipped(prefix + "payload", "zstd payload not supported");
+    else if(std::memcmp(sniff, "BZh", 3) == 0) w.skipped(prefix + "payload", "bzip2 payload not supported");
+    else return false;
+    return true;
+}
+
+// `gzSize` is the ISIZE trailer of a gzip stream (uncompressed size mod 2^32), 0 if unknown.
+static bool walkSource(Source& src, const std::string& name, Kind kind, std::uint64_t gzSize, Walker& w){
+    switch(kind){
+        case Kind::Tar:   return walkTar(src, std::string(), w);
+        case Kind::TarGz: return walkTarMaybeGz(src, true, std::string(), w);
+        case Kind::Deb:   return walkAr(src, std::string(), w);
+        case Kind::Rpm:   return walkRpm(src, std::string(), w);
+        case Kind::Gzip: {
+#ifdef USE_MINIZ
+            GzipSource g(src);
+            if(!g.valid()) return false;
+            std::string inner = g.storedName();
+            if(inner.empty()){
+                std::string base = name.substr(name.find_last_of("/\\") + 1);
+                inner = base.size() > 3 ? base.substr(0, base.size() - 3) : base;
+            }
+            const std::string tooLarge = "larger than the " + std::to_string(w.limits.maxMember >> 20) + " MiB member limit";
+            Member m{ inner, gzSize, 0 };
+            if(!w.want(m)) return true;
+            if(gzSize > w.limits.maxMember){ w.skipped(inner, tooLarge); return true; }
+            if(w.hooks.beforeRead && !w.hooks.beforeRead(m)) return true;
+            std::vector<unsigned char> out;
+            out.reserve((std::size_t)gzSize);
+            unsigned char tmp[65536];
+            for(;;){
+                std::size_t r = g.read(tmp, sizeof(tmp));
+                if(r == 0) break;
+                if(out.size() + r > w.limits.maxMember){ w.skipped(inner, tooLarge); return true; }
+                out.insert(out.end(), tmp, tmp + r);
+            }
+            m.size = out.size();
+            if(!out.empty()) w.onMember(m, out);
+            return true;
+#else
+            (void)name; (void)gzSize;
+            return false;
+#endif
+        }
+        default: return false;
+    }
+}
+
+}
+
+Kind kindForName(const std::string& name){
+    std::string s = lower(name);
+    if(endsWith(s, ".tar.gz") || endsWith(s, ".tgz")) return Kind::TarGz;
+    if(endsWith(s, ".tar")) return Kind::Tar;
+    if(endsWith(s, ".deb")) return Kind::Deb;
+    if(endsWith(s, ".rpm")) return Kind::Rpm;
+    if(endsWith(s, ".gz")) return Kind::Gzip;
+    return Kind::None;
+}
+
+static std::uint64_t gzipTrailerSize(const unsigned char* tail){
+    return (std::uint64_t)tail[0] | ((std::uint64_t)tail[1] << 8) | ((std::uint64_t)tail[2] << 16) | ((std::uint64_t)tail[3] << 24);
+}
+
+bool walkFile(const std::string& path, Kind kind, const Limits& limits, const WantFn& want, const MemberFn& onMember,
+              const Hooks& hooks){
+    FileSource src(path);
+    if(!src.ok()) return false;
+    std::uint64_t gzSize = 0;
+    if(kind == Kind::Gzip){
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        unsigned char tail[4];
+        if(in && in.tellg() >= 18 && in.seekg(-4, std::ios::end) && in.read((char*)tail, 4)) gzSize = gzipTrailerSize(tail);
+    }
+    Walker w{ limits, want, onMember, hooks, {}, 0, 0, false };
+    return walkSource(src, path, kind, gzSize, w);
+}
+
+bool walkBuffer(const std::vector<unsigned char>& data, const std::string& name, Kind kind, const Limits& limits,
+                const WantFn& want, const MemberFn& onMember, const Hooks& hooks){
+    MemSource src(data.data(), data.size());
+    const std::uint64_t gzSize = kind == Kind::Gzip && data.size() >= 18 ? gzipTrailerSize(data.data() + data.size() - 4) : 0;
+    Walker w{ limits, want, onMember, hooks, {}, 0, 0, false };
+    return walkSource(src, name, kind, gzSize, w);
+}
+
+namespace {
+
+const std::size_t kArMaxMembers = 1u << 20;
+const std::uint64_t kArMaxTable = 256ull << 20;
+
+std::uint64_t arDecimal(const unsigned char* p, std::size_t n){
+    std::uint64_t v = 0;
+    std::size_t i = 0;
+    while(i < n && p[i] == ' ') ++i;
+    for(; i < n && p[i] >= '0' && p[i] <= '9'; ++i) v = v * 10 + (std::uint64_t)(p[i] - '0');
+    return v;
+}
+
+std::uint64_t arBE(const unsigned char* p, int width){
+    std::uint64_t v = 0;
+    for(int i = 0; i < width; ++i) v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t arLE(const unsigned char* p, int width){
+    std::uint64_t v = 0;
+    for(int i = width - 1; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+bool readAt(std::ifstream& in, std::uint64_t off, std::uint64_t n, std::vector<unsigned char>& out){
+    out.resize((std::size_t)n);
+    in.clear();
+    in.seekg((std::streamoff)off);
+    return n == 0 || (in.read((char*)out.data(), (std::streamsize)n) && (std::uint64_t)in.gcount() == n);
+}
+
+bool isBsdSymdef(const std::string& name){
+    return name == "__.SYMDEF" || name == "__.SYMDEF SORTED" || name == "__.SYMDEF_64" || name == "__.SYMDEF_64 SORTED";
+}
+
+// GNU tables hold big-endian counts and member header offsets ahead of the names; BSD ones hold
+// little-endian (string offset, header offset) pairs followed by a string table.
+void parseArSymbols(const std::vector<unsigned char>& t, std::uint64_t tableOff, bool gnu, int width,
+                    const std::unordered_map<std::uint64_t, std::size_t>& byHeader, std::vector<ArSymbol>& out){
+    auto add = [&](std::uint64_t nameOff, std::uint64_t header, std::size_t limit){
+        auto it = byHeader.find(header);
+        if(it == byHeader.end() || nameOff >= limit) return;
+        const void* z = std::memchr(t.data() + nameOff, 0, limit - (std::size_t)nameOff);
+        const std::size_t len = z ? (std::size_t)((const unsigned char*)z - (t.data() + nameOff)) : limit - (std::size_t)nameOff;
+        if(len) out.push_back({ std::string((const char*)t.data() + nameOff, len), it->second, tableOff + nameOff });
+    };
+    const std::size_t w = (std::size_t)width;
+    if(t.size() < w) return;
+    if(gnu){
+        const std::uint64_t n = arBE(t.data(), width);
+        if(n > (t.size() - w) / w) return;
+        std::size_t names = w + (std::size_t)n * w;
+        for(std::uint64_t i = 0; i < n && names < t.size(); ++i){
+            add(names, arBE(t.data() + w + i * w, width), t.size());
+            const void* z = std::memchr(t.data() + names, 0, t.size() - names);
+            if(!z) break;
+            names = (std::size_t)((const unsigned char*)z - t.data()) + 1;
+        }
+        return;
+    }
+    const std::uint64_t ranlibBytes = arLE(t.data(), width);
+    if(ranlibBytes > t.size() - w || t.size() - w - ranlibBytes < w) return;
+    const std::size_t strOff = w + (std::size_t)ranlibBytes + w;
+    const std::uint64_t strSize = std::min<std::uint64_t>(arLE(t.data() + w + ranlibBytes, width), t.size() - strOff);
+    for(std::uint64_t e = 0; e + 2 * w <= ranlibBytes; e += 2 * w){
+        add(strOff + arLE(t.data() + w + e, width), arLE(t.data() + w + e + w, width), strOff + (std::size_t)strSize);
+    }
+}
+
+}
+
+bool readArIndex(const std::string& path, ArIndex& out){
+    out = ArIndex();
+    std::ifstream in(path, std::ios::binary);
+    unsigned char magic[8];
+    if(!in || !in.read((char*)magic, 8) || std::memcmp(magic, "!<arch>\n", 8) != 0) return false;
+    in.seekg(0, std::ios::end);
+    const std::uint64_t fileSize = (std::uint64_t)in.tellg();
+
+    std::vector<unsigned char> symtab, longNames, tmp;
+    std::uint64_t symtabOff = 0;
+    bool gnuSymtab = false;
+    int symWidth = 0;
+    std::unordered_map<std::uint64_t, std::size_t> byHeader;
+    std::uint64_t pos = 8;
+    unsigned char h[60];
+    while(pos + sizeof(h) <= fileSize && out.members.size() < kArMaxMembers){
+        in.clear();
+        in.seekg((std::streamoff)pos);
+        if(!in.read((char*)h, sizeof(h)) || h[58] != 0x60 || h[59] != '\n') break;
+        std::string raw = cstr(h, 16);
+        while(!raw.empty() && raw.back() == ' ') raw.pop_back();
+        const std::uint64_t size = arDecimal(h + 48, 10);
+        std::uint64_t data = pos + sizeof(h);
+        if(size > fileSize - data) break;
+        std::uint64_t dataSize = size;
+        const std::uint64_t next = data + size + (size & 1);
+        std::string name;
+        if(raw == "/" || raw == "/SYM64/"){
+            // COFF import libraries follow the first "/" with a second one in another layout.
+            if(!symWidth && size <= kArMaxTable && readAt(in, data, size, symtab)){
+                symtabOff = data;
+                gnuSymtab = true;
+                symWidth = raw == "/" ? 4 : 8;
+            }
+            pos = next;
+            continue;
+        }
+        if(raw == "//"){
+            if(size <= kArMaxTable) readAt(in, data, size, longNames);
+            pos = next;
+            continue;
+        }
+        if(raw.compare(0, 3, "#1/") == 0){
+            const std::uint64_t n = arDecimal((const unsigned char*)raw.data() + 3, raw.size() - 3);
+            if(n > size || !readAt(in, data, n, tmp)) break;
+            name = cstr(tmp.data(), tmp.size());
+            data += n;
+            dataSize -= n;
+        }else if(raw.size() > 1 && raw[0] == '/' && std::isdigit((unsigned char)raw[1])){
+            const std::uint64_t o = arDecimal((const unsigned char*)raw.data() + 1, raw.size() - 1);
+            for(std::uint64_t i = o; i < longNames.size() && longNames[i] != '\n' && longNames[i] != 0; ++i) name.push_back((char)longNames[i]);
+        }else{
+            name = raw;
+        }
+        if(!name.empty() && name.back() == '/') name.pop_back();
+        if(isBsdSymdef(name)){
+            if(!symWidth && dataSize <= kArMaxTable && readAt(in, data, dataSize, symtab)){
+                symtabOff = data;
+                symWidth = name.find("_64") != std::string::npos ? 8 : 4;
+            }
+        }else{
+            byHeader[pos] = out.members.size();
+            out.members.push_back({ name, data, dataSize });
+        }
+        pos = next;
+    }
+    if(out.members.empty() && !symWidth) return pos >= fileSize;
+    if(symWidth) parseArSymbols(symtab, symtabOff, gnuSymtab, symWidth, byHeader, out.symbols);
+    return true;
+}
+
+bool readArMember(const std::string& path, const ArMember& m, std::vector<unsigned char>& out){
+    std::ifstream in(path, std::ios::binary);
+    return in && readAt(in, m.offset, m.size, out);
+}
+
+}
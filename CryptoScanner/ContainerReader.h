@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace container {
+
+enum class Kind { None, Tar, TarGz, Gzip, Deb, Rpm };
+
+Kind kindForName(const std::string& name);
+
+struct Member {
+    std::string name;
+    std::uint64_t size = 0;
+    std::uint32_t mode = 0;
+};
+
+struct Limits {
+    std::uint64_t maxMember = 64ull << 20;
+    std::uint64_t maxTotal = 0;
+    std::size_t maxMembers = 0;
+};
+
+using WantFn = std::function<bool(const Member&)>;
+// Called with the full contents of each wanted member. Returning false stops the walk.
+using MemberFn = std::function<bool(const Member&, const std::vector<unsigned char>&)>;
+
+struct Hooks {
+    // Called right before a wanted member's m.size bytes are read (for a gzip stream, the size
+    // its trailer records). Returning false stops the walk.
+    std::function<bool(const Member&)> beforeRead;
+    // Wanted members larger than Limits::maxMember, and payloads in a format this reader does
+    // not decode (xz, zstd), are passed over and reported here.
+    std::function<void(const std::string& name, const std::string& reason)> skipped;
+};
+
+// Streams the container once, handing wanted members to onMember. Member names of nested
+// layers (deb data.tar.*, gzip payload) are prefixed with "layer::". Returns false if the
+// container could not be recognised.
+bool walkFile(const std::string& path, Kind kind, const Limits& limits, const WantFn& want, const MemberFn& onMember,
+              const Hooks& hooks = Hooks());
+bool walkBuffer(const std::vector<unsigned char>& data, const std::string& name, Kind kind, const Limits& limits,
+                const WantFn& want, const MemberFn& onMember, const Hooks& hooks = Hooks());
+
+// Unix ar archives (static libraries) are indexed rather than streamed: member headers are
+// read by seeking over the data, names come from the GNU "//" table or BSD "#1/<len>" headers,
+// and the symbol table ("/", "/SYM64/" or "__.SYMDEF") maps each defined global to its member.
+struct ArMember {
+    std::string name;
+    std::uint64_t offset = 0;   // file offset of the member data
+    std::uint64_t size = 0;
+};
+
+struct ArSymbol {
+    std::string name;
+    std::size_t member = 0;     // index into ArIndex::members
+    std::uint64_t offset = 0;   // file offset of the name in the symbol table
+};
+
+struct ArIndex {
+    std::vector<ArMember> members;
+    std::vector<ArSymbol> symbols;  // empty when the archive has no symbol table
+};
+
+// False unless the file is a regular "!<arch>" archive; thin archives only reference their
+// members and are not indexed.
+bool readArIndex(const std::string& path, ArIndex& out);
+// Reads the data of one member; each call opens the file, so members can be read in parallel.
+bool readArMember(const std::string& path, const ArMember& m, std::vector<unsigned char>& out);
+
+}
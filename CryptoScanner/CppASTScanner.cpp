@@ -1,35 +1,35 @@
 #include "CppASTScanner.h"
 
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <cctype>
-#include <cstring>
-#include <tree_sitter/api.h>
-
-extern "C" const TSLanguage *tree_sitter_cpp();
+#include "ParserPool.h"
 
 namespace {
 
-std::string read_file(const std::string& path){
-    std::ifstream in(path, std::ios::binary);
-    std::ostringstream ss; ss<<in.rdbuf();
-    return ss.str();
-}
+const char* const kCallQuery = "(call_expression function: (_) @fn arguments: (argument_list) @args) @call";
 
-std::string trim(const std::string& s){
+std::string_view trim(std::string_view s){
     size_t i=0,j=s.size();
     while(i<j && std::isspace((unsigned char)s[i]))++i;
     while(j>i && std::isspace((unsigned char)s[j-1]))--j;
     return s.substr(i,j-i);
 }
 
-std::string node_text(TSNode n, const std::string& src){
-    uint32_t a=ts_node_start_byte(n), b=ts_node_end_byte(n);
-    if(b>src.size()) b=(uint32_t)src.size();
-    if(a>b) a=b;
-    return std::string(src.data()+a, src.data()+b);
+std::string arg_value(std::string_view a){
+    if(a.size()>=2 && (a.front()=='"' || a.front()=='\'')){
+        char q=a.front();
+        size_t i=1;
+        std::string v;
+        while(i<a.size()){
+            char c=a[i++];
+            if(c=='\\' && i<a.size()){ v.push_back(a[i++]); continue; }
+            if(c==q) break;
+            v.push_back(c);
+        }
+        return v;
+    }
+    return std::string(a);
 }
 
 std::string base_name_of(const std::string& s){
@@ -45,90 +45,71 @@ std::string base_name_of(const std::string& s){
 
 namespace analyzers {
 
-std::vector<AstSymbol> CppASTScanner::collectSymbols(const std::string& path){
+std::vector<AstSymbol> CppASTScanner::collectSymbols(const std::string& path, const CallSiteFilter& keep){
+    MappedFile src;
+    if(!src.open(path)) return {};
+    return collectSymbols(path, src.view(), keep);
+}
+
+std::vector<AstSymbol> CppASTScanner::collectSymbols(const std::string& path, std::string_view code, const CallSiteFilter& keep){
+    if(code.empty()) return {};
+    TSTree* tree = ParserPool::parse(SourceLang::Cpp, code);
+    if(!tree) return {};
+    std::vector<AstSymbol> out = collectFromTree(path, code, tree, 0, UINT32_MAX, keep);
+    ts_tree_delete(tree);
+    return out;
+}
+
+std::vector<AstSymbol> CppASTScanner::collectFromTree(const std::string& path, std::string_view code, const TSTree* tree,
+                                                      uint32_t fromByte, uint32_t toByte, const CallSiteFilter& keep){
     std::vector<AstSymbol> out;
-    std::string code = read_file(path);
-    if(code.empty()) return out;
-
-    TSParser* parser = ts_parser_new();
-    ts_parser_set_language(parser, tree_sitter_cpp());
-    TSTree* tree = ts_parser_parse_string(parser, nullptr, code.c_str(), (uint32_t)code.size());
-    if(!tree){ ts_parser_delete(parser); return out; }
-
-    TSNode root = ts_tree_root_node(tree);
-    std::vector<TSNode> stack; stack.push_back(root);
-
-    while(!stack.empty()){
-        TSNode n = stack.back(); stack.pop_back();
-        const char* t = ts_node_type(n);
-
-        if(std::strcmp(t,"call_expression")==0){
-            TSNode fn = ts_node_child_by_field_name(n, "function", 8);
-            TSNode args = ts_node_child_by_field_name(n, "arguments", 9);
-            std::string callee_full, callee_base, first_arg;
-
-            if(!ts_node_is_null(fn)){
-                callee_full = trim(node_text(fn, code));
-                callee_base = base_name_of(callee_full);
-            }else{
-                std::string seg = trim(node_text(n, code));
-                auto p = seg.find('(');
-                if(p!=std::string::npos) callee_full = trim(seg.substr(0,p));
-                callee_base = base_name_of(callee_full);
-            }
-
-            if(!ts_node_is_null(args)){
-                uint32_t nc = ts_node_named_child_count(args);
-                if(nc>0){
-                    TSNode a0 = ts_node_named_child(args, 0);
-                    if(!ts_node_is_null(a0)){
-                        std::string a0txt = trim(node_text(a0, code));
-                        if(!a0txt.empty()){
-                            if(a0txt.size()>=2 && (a0txt.front()=='"' || a0txt.front()=='\'')){
-                                char q=a0txt.front();
-                                size_t i=1;
-                                std::string v;
-                                while(i<a0txt.size()){
-                                    char c=a0txt[i++];
-                                    if(c=='\\' && i<a0txt.size()){ v.push_back(a0txt[i++]); continue; }
-                                    if(c==q) break;
-                                    v.push_back(c);
-                                }
-                                first_arg = v;
-                            }else{
-                                first_arg = a0txt;
-                            }
-                        }
-                    }
-                }
-            }
-
-            TSPoint p = ts_node_start_point(n);
-            size_t line = (size_t)p.row + 1;
-
-            if(!callee_full.empty()){
-                AstSymbol s;
-                s.filePath = path;
-                s.line = line;
-                s.lang = "cpp";
-                s.callee_full = callee_full;
-                s.callee_base = callee_base.empty()? callee_full : callee_base;
-                s.first_arg = first_arg;
-                out.push_back(std::move(s));
-            }
+    if(!tree) return out;
+
+    static const TSQuery* query = ParserPool::compileQuery(SourceLang::Cpp, kCallQuery);
+    if(!query) return out;
+    static const uint32_t capCall = ParserPool::captureIndex(query, "call");
+    static const uint32_t capFn = ParserPool::captureIndex(query, "fn");
+    static const uint32_t capArgs = ParserPool::captureIndex(query, "args");
+
+    TSQueryCursor* cur = ParserPool::cursor();
+    ts_query_cursor_set_byte_range(cur, fromByte, toByte);
+    ts_query_cursor_exec(cur, query, ts_tree_root_node(tree));
+    TSQueryMatch m;
+    while(ts_query_cursor_next_match(cur, &m)){
+        TSNode call{}, fn{}, args{};
+        for(uint16_t i=0;i<m.capture_count;++i){
+            const uint32_t ix = m.captures[i].index;
+            if(ix==capCall) call = m.captures[i].node;
+            else if(ix==capFn) fn = m.captures[i].node;
+            else if(ix==capArgs) args = m.captures[i].node;
         }
-
-        uint32_t c = ts_node_child_count(n);
-        for(uint32_t i=0;i<c;++i){
-            TSNode ch = ts_node_child(n,i);
-            if(ts_node_is_null(ch)) continue;
-            if(!ts_node_is_named(ch)) continue;
-            stack.push_back(ch);
+        if(ts_node_is_null(call) || ts_node_is_null(fn)) continue;
+
+        std::string_view callee = trim(nodeView(fn, code));
+        if(callee.empty()) continue;
+        std::string_view a0txt;
+        if(!ts_node_is_null(args) && ts_node_named_child_count(args)>0) a0txt = trim(nodeView(ts_node_named_child(args, 0), code));
+        if(keep && !keep(callee, a0txt)) continue;
+
+        AstSymbol s;
+        s.filePath = path;
+        s.line = (size_t)ts_node_start_point(call).row + 1;
+        s.lang = "cpp";
+        s.callee_full = std::string(callee);
+        std::string base = base_name_of(s.callee_full);
+        s.callee_base = base.empty()? s.callee_full : base;
+        s.first_arg = arg_value(a0txt);
+        uint32_t na = ts_node_is_null(args) ? 0 : ts_node_named_child_count(args);
+        for(uint32_t i=0;i<na;++i){
+            TSNode a = ts_node_named_child(args, i);
+            if(ts_node_is_extra(a)) continue;
+            s.args.push_back(arg_value(trim(nodeView(a, code))));
         }
+        s.startByte = ts_node_start_byte(call);
+        s.endByte = ts_node_end_byte(call);
+        out.push_back(std::move(s));
     }
 
-    ts_tree_delete(tree);
-    ts_parser_delete(parser);
     return out;
 }
 
@@ -1,12 +1,20 @@
 #include "CryptoScanner.h"
 #include "PatternLoader.h"
 #include "JavaBytecodeScanner.h"
+#include "DotNetMetadata.h"
+#include "GoBinaryScanner.h"
 #include "JavaASTScanner.h"
 #include "PythonASTScanner.h"
 #include "CppASTScanner.h"
+#include "LexerScanner.h"
+#include "TreeCache.h"
+#include "ParserPool.h"
 #include "ASTSymbol.h"
 #include "FileScanner.h"
 #include "DynLinkParser.h"
+#include "ContainerReader.h"
+#include "InsnScanner.h"
+#include "PEImage.h"
 
 #include <algorithm>
 #include <array>
@@ -38,6 +46,7 @@
 #include <openssl/bio.h>
 #include <openssl/evp.h>
 #include <openssl/objects.h>
+#include <openssl/pkcs7.h>
 
 namespace fs = std::filesystem;
 
@@ -84,7 +93,7 @@ static inline bool isVersionedSoName(const std::string& fileName) {
 }
 
 static inline bool isJarLikeExt(const std::string& ext) {
-    static const std::unordered_set<std::string> exts = { ".jar", ".zip", ".war", ".ear", ".apk", ".aar", ".jmod" };
+    static const std::unordered_set<std::string> exts = { ".jar", ".zip", ".war", ".ear", ".apk", ".aar", ".jmod", ".whl" };
     return exts.count(ext) > 0;
 }
 
@@ -119,6 +128,22 @@ static inline bool isOidType(const std::string& t) {
     return t == "oid" || t == "asn1-oid" || t == "asn1_oid";
 }
 
+// `stems` holds the literals required by the text patterns (TokenPrefilter::patternLiterals), so a
+// callee or identifier argument containing none of them cannot match any pattern. Quoted and
+// numeric literals always pass since OIDs, exponents and transforms live there.
+static bool callSiteMayMatch(const analyzers::ApiNameIndex& stems, std::string_view callee, std::string_view firstArg) {
+    if (!firstArg.empty()) {
+        std::size_t i = 0;
+        while (i < firstArg.size() && i < 2 && std::isalpha((unsigned char)firstArg[i])) ++i;
+        const char c = i < firstArg.size() ? firstArg[i] : firstArg[0];
+        if (c == '"' || c == '\'' || std::isdigit((unsigned char)firstArg[0])) return true;
+    }
+    std::vector<std::size_t> ids;
+    stems.candidates(callee, ids);
+    if (ids.empty() && !firstArg.empty()) stems.candidates(firstArg, ids);
+    return !ids.empty();
+}
+
 static inline bool nearAny(const std::vector<std::size_t>& anchors, std::size_t off, std::size_t win) {
     if (anchors.empty()) return false;
     auto it = std::lower_bound(anchors.begin(), anchors.end(), off);
@@ -199,6 +224,8 @@ bool CryptoScanner::readTextFile(const std::string& path, std::string& out) {
 }
 
 bool CryptoScanner::readAllBytes(const std::string& path, std::vector<unsigned char>& out) {
+    governor::PageCacheGuard* cache = governor::PageCacheGuard::current();
+    if (cache && cache->path() == path && governor::readFileDropBehind(*cache, out)) return true;
     std::ifstream in(path, std::ios::binary);
     if (!in) return false;
     out.assign(std::istreambuf_iterator<char>(in), {});
@@ -252,7 +279,8 @@ std::vector<unsigned char> CryptoScanner::b64decode(const std::string& s) {
     };
     std::vector<unsigned char> out;
     out.reserve(s.size() * 3 / 4 + 3);
-    unsigned int val = 0, valb = -8;
+    unsigned int val = 0;
+    int valb = -8;
     for (unsigned char c : s) {
         int d = T[c];
         if (d == -1) continue;
@@ -284,6 +312,19 @@ std::vector<std::vector<unsigned char>> CryptoScanner::pemDecodeAll(const std::s
     return all;
 }
 
+// PE imports whose name contains one of these (case-insensitively) use a weak primitive. Only
+// the import table gets this substring test; on exports, ELF symbols and archive maps it flags
+// every digest entry point of a crypto library and names like RAND_seed.
+static const std::vector<std::string> kWeakImportKeywords = { "md5", "sha1", "des_", "rc4", "rc2", "rsa_generate_key", "seed" };
+
+static bool hasWeakImportKeyword(std::string_view fn) {
+    const std::string low = toLowerStr(std::string(fn));
+    for (const auto& k : kWeakImportKeywords) {
+        if (low.find(k) != std::string::npos) return true;
+    }
+    return false;
+}
+
 CryptoScanner::CryptoScanner() {
     auto LR = pattern_loader::loadFromJson();
     if (!LR.error.empty()) {
@@ -291,14 +332,43 @@ CryptoScanner::CryptoScanner() {
     }
     patterns = LR.regexPatterns;
     oidBytePatterns = LR.bytePatterns;
+    constantTables.build(LR.constantPatterns);
+    classRules = analyzers::ClassRuleTable::build(oidBytePatterns);
+    dotnetRules = analyzers::DotNetRuleTable::build();
+    const auto& ruleList = LR.astRules.empty() ? crypto_patterns::getDefaultASTRules() : LR.astRules;
+    astRules.load(ruleList);
+    for (const auto& ap : patterns) {
+        ruleSetHash = analyzers::TreeCache::fingerprint(ap.name, ruleSetHash);
+        ruleSetHash = analyzers::TreeCache::fingerprint(ap.source, ruleSetHash ^ (std::uint64_t)ap.pattern.flags());
+    }
+    for (const auto& r : ruleList) ruleSetHash = analyzers::TreeCache::fingerprint(r.toJson(), ruleSetHash);
+    std::vector<std::string> literals = analyzers::TokenPrefilter::builtinLiterals();
+    std::vector<std::string> sources;
+    sources.reserve(patterns.size());
+    for (const auto& ap : patterns) sources.push_back(ap.source);
+    auto patternLiterals = analyzers::TokenPrefilter::patternLiterals(sources);
+    literals.insert(literals.end(), patternLiterals.begin(), patternLiterals.end());
+    // Patterns left out here have no literal of three bytes; the two basepoint forms ("u = 9")
+    // need an '=' and never match a callee or a bare identifier.
+    callSiteStems.build({ patternLiterals });
+    auto ruleLiterals = astRules.calleeLiterals();
+    literals.insert(literals.end(), ruleLiterals.begin(), ruleLiterals.end());
+    sourcePrefilter.build(literals);
     patternsApiOnly.clear();
     patternsApiOnly.reserve(patterns.size());
     for (const auto& ap : patterns) {
         std::string et = evidenceTypeForTextPattern(ap.name);
         if (et == "api" || et == "pem" || et == "oid") patternsApiOnly.push_back(ap);
     }
+    std::vector<std::vector<std::string>> apiLiterals(patternsApiOnly.size());
+    for (std::size_t i = 0; i < patternsApiOnly.size(); ++i) {
+        const std::string& src = patternsApiOnly[i].source;
+        if (src.empty() || !analyzers::ApiNameIndex::requiredPrefixes(src, apiLiterals[i])) apiLiterals[i].clear();
+    }
+    apiNames.build(apiLiterals);
     cancelCb = nullptr;
     activeOpt = ScanOptions();
+    memBudget.setLimit(governor::defaultMemoryBudget());
 }
 
 std::string CryptoScanner::severityForTextPattern(const std::string& algName, const std::string& matched) {
@@ -333,12 +403,90 @@ std::string CryptoScanner::evidenceLabelForByteType(const std::string& type) {
     return "bytes";
 }
 
+static std::string oidText(const ASN1_OBJECT* obj) {
+    char oid_buf[256];
+    OBJ_obj2txt(oid_buf, sizeof(oid_buf), obj, 1);
+    return std::string(oid_buf);
+}
+
+static const std::uint16_t kWinCertTypePkcsSignedData = 0x0002;
+
+static std::string oidShortName(const ASN1_OBJECT* obj) {
+    const char* sn = OBJ_nid2sn(OBJ_obj2nid(obj));
+    return sn ? std::string(sn) : oidText(obj);
+}
+
+// Signature algorithm and public key type of a certificate. OID detections are kept once per
+// algorithm label, so `named` puts the algorithm and key size into the label for files that
+// carry a whole chain.
+static void pushCertAlgorithms(std::vector<Detection>& out, const std::string& filePath, std::size_t offset, X509* cert, bool named = false) {
+    const X509_ALGOR* alg = nullptr; const ASN1_BIT_STRING* sig = nullptr;
+    X509_get0_signature(&sig, &alg, cert);
+    if (alg && alg->algorithm) {
+        const std::string label = named ? "x509.sig_alg (" + oidShortName(alg->algorithm) + ")" : std::string("x509.sig_alg");
+        out.push_back({ filePath, offset, label, oidText(alg->algorithm), "oid", "med", "" });
+    }
+    EVP_PKEY* pk = X509_get0_pubkey(cert);
+    if (pk) {
+        int nid = EVP_PKEY_base_id(pk);
+        const ASN1_OBJECT* obj = OBJ_nid2obj(nid);
+        const char* sn = OBJ_nid2sn(nid);
+        if (obj && sn) {
+            const std::string label = named ? std::string(sn) + " (" + std::to_string(EVP_PKEY_bits(pk)) + "-bit)" : std::string(sn);
+            out.push_back({ filePath, offset, label, oidText(obj), "oid", "high", "" });
+        }
+    }
+}
+
+// Authenticode PKCS#7 SignedData: the signers' digest and signature algorithms and every
+// certificate of the chain. Dual-signed files carry the second signature as a nested SignedData
+// in an unauthenticated attribute of the first signer.
+static bool pushAuthenticode(std::vector<Detection>& out, const std::string& filePath, std::size_t offset,
+                             const unsigned char* der, long len, int depth) {
+    const unsigned char* q = der;
+    PKCS7* p7 = d2i_PKCS7(nullptr, &q, len);
+    if (!p7) return false;
+    if (PKCS7_type_is_signed(p7) && p7->d.sign) {
+        STACK_OF(X509)* certs = p7->d.sign->cert;
+        for (int i = 0; i < sk_X509_num(certs); ++i) pushCertAlgorithms(out, filePath, offset, sk_X509_value(certs, i), true);
+        static const ASN1_OBJECT* nested = OBJ_txt2obj("1.3.6.1.4.1.311.2.4.1", 1);
+        STACK_OF(PKCS7_SIGNER_INFO)* signers = PKCS7_get_signer_info(p7);
+        for (int i = 0; i < sk_PKCS7_SIGNER_INFO_num(signers); ++i) {
+            PKCS7_SIGNER_INFO* si = sk_PKCS7_SIGNER_INFO_value(signers, i);
+            X509_ALGOR* dig = nullptr; X509_ALGOR* enc = nullptr;
+            PKCS7_SIGNER_INFO_get0_algs(si, nullptr, &dig, &enc);
+            if (dig && dig->algorithm) {
+                out.push_back({ filePath, offset, "authenticode.digest_alg (" + oidShortName(dig->algorithm) + ")", oidText(dig->algorithm), "oid", "med", "" });
+            }
+            if (enc && enc->algorithm) {
+                out.push_back({ filePath, offset, "authenticode.sig_alg (" + oidShortName(enc->algorithm) + ")", oidText(enc->algorithm), "oid", "med", "" });
+            }
+            if (!nested || depth >= 2) continue;
+            for (int at = -1; (at = X509at_get_attr_by_OBJ(si->unauth_attr, nested, at)) >= 0; ) {
+                X509_ATTRIBUTE* attr = X509at_get_attr(si->unauth_attr, at);
+                for (int k = 0; k < X509_ATTRIBUTE_count(attr); ++k) {
+                    const ASN1_TYPE* t = X509_ATTRIBUTE_get0_type(attr, k);
+                    if (t && t->type == V_ASN1_SEQUENCE) {
+                        pushAuthenticode(out, filePath, offset, t->value.sequence->data, t->value.sequence->length, depth + 1);
+                    }
+                }
+            }
+        }
+    }
+    PKCS7_free(p7);
+    return true;
+}
+
 std::vector<Detection> CryptoScanner::scanCertOrKeyFileDetailed(const std::string& filePath) {
-    std::vector<Detection> out;
     std::vector<unsigned char> buffer;
-    if (!readAllBytes(filePath, buffer)) return out;
+    if (!readAllBytes(filePath, buffer)) return {};
+    return scanCertOrKeyBytes(filePath, buffer);
+}
+
+std::vector<Detection> CryptoScanner::scanCertOrKeyBytes(const std::string& filePath, const std::vector<unsigned char>& buffer) {
+    std::vector<Detection> out;
     auto push = [&](const std::string& alg, const std::string& match, const std::string& sev){
-        Detection d{ filePath, 0, alg, match, "oid", sev };
+        Detection d{ filePath, 0, alg, match, "oid", sev, "" };
         out.push_back(std::move(d));
     };
     BIO* bio = BIO_new_mem_buf(buffer.data(), (int)buffer.size());
@@ -347,24 +495,7 @@ std::vector<Detection> CryptoScanner::scanCertOrKeyFileDetailed(const std::strin
     const unsigned char* p = buffer.data();
     X509* certDer = d2i_X509(nullptr, &p, (long)buffer.size());
     if (certDer) {
-        const X509_ALGOR* alg = nullptr; const ASN1_BIT_STRING* sig = nullptr;
-        X509_get0_signature(&sig, &alg, certDer);
-        if (alg && alg->algorithm) {
-            char oid_buf[256];
-            OBJ_obj2txt(oid_buf, sizeof(oid_buf), alg->algorithm, 1);
-            push("x509.sig_alg", std::string(oid_buf), "med");
-        }
-        EVP_PKEY* pk = X509_get0_pubkey(certDer);
-        if (pk) {
-            int nid = EVP_PKEY_base_id(pk);
-            const ASN1_OBJECT* obj = OBJ_nid2obj(nid);
-            const char* sn = OBJ_nid2sn(nid);
-            if (obj && sn) {
-                char oid_buf[256];
-                OBJ_obj2txt(oid_buf, sizeof(oid_buf), obj, 1);
-                push(std::string(sn), std::string(oid_buf), "high");
-            }
-        }
+        pushCertAlgorithms(out, filePath, 0, certDer);
         X509_free(certDer);
         parsed_any = true;
     }
@@ -372,24 +503,7 @@ std::vector<Detection> CryptoScanner::scanCertOrKeyFileDetailed(const std::strin
         BIO_reset(bio);
         X509* certPem = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr);
         if (certPem) {
-            const X509_ALGOR* alg = nullptr; const ASN1_BIT_STRING* sig = nullptr;
-            X509_get0_signature(&sig, &alg, certPem);
-            if (alg && alg->algorithm) {
-                char oid_buf[256];
-                OBJ_obj2txt(oid_buf, sizeof(oid_buf), alg->algorithm, 1);
-                push("x509.sig_alg", std::string(oid_buf), "med");
-            }
-            EVP_PKEY* pk = X509_get0_pubkey(certPem);
-            if (pk) {
-                int nid = EVP_PKEY_base_id(pk);
-                const ASN1_OBJECT* obj = OBJ_nid2obj(nid);
-                const char* sn = OBJ_nid2sn(nid);
-                if (obj && sn) {
-                    char oid_buf[256];
-                    OBJ_obj2txt(oid_buf, sizeof(oid_buf), obj, 1);
-                    push(std::string(sn), std::string(oid_buf), "high");
-                }
-            }
+            pushCertAlgorithms(out, filePath, 0, certPem);
             X509_free(certPem);
             parsed_any = true;
         }
@@ -433,7 +547,7 @@ std::vector<Detection> CryptoScanner::scanCertOrKeyFileDetailed(const std::strin
             const std::string t = typeByName.count(alg.first) ? typeByName[alg.first] : std::string();
             if (!isOidType(t)) continue;
             for (const auto& e : alg.second) {
-                Detection d{ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t) };
+                Detection d{ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t), "" };
                 out.push_back(std::move(d));
             }
         }
@@ -442,22 +556,98 @@ std::vector<Detection> CryptoScanner::scanCertOrKeyFileDetailed(const std::strin
 }
 
 std::vector<Detection> CryptoScanner::scanBinaryWholeFile(const std::string& filePath) {
-    std::vector<Detection> results;
     std::vector<unsigned char> buffer;
-    if (!readAllBytes(filePath, buffer)) return results;
-    FileScanner::setCurrentSourceName(filePath);
+    if (!readAllBytes(filePath, buffer)) return {};
     const std::string ext = lowercaseExt(filePath);
     bool isBin = quickIsExecutableByHeader(filePath) || ext == ".so" || ext == ".dll" || ext == ".exe" || ext == ".a" || ext == ".ld";
-    auto strings = FileScanner::extractAsciiStrings(buffer, 4);
-    auto strMatches = FileScanner::scanStringsWithOffsets(strings, patterns);
-    for (const auto& kv : strMatches) {
-        const std::string& alg = kv.first;
-        for (const auto& m : kv.second) {
-            Detection d{ filePath, m.second, alg, m.first, evidenceTypeForTextPattern(alg), severityForTextPattern(alg, m.first) };
-            results.push_back(std::move(d));
+    auto results = scanBinaryBytes(filePath, buffer, isBin);
+    exporter.stage(filePath, filePath, buffer);
+    return results;
+}
+
+std::vector<Detection> CryptoScanner::scanBinaryBytes(const std::string& filePath, const std::vector<unsigned char>& buffer, bool isBin) {
+    std::vector<Detection> results;
+    // ELF files are matched section by section: text patterns over string-bearing data, byte
+    // patterns over allocated data, nothing over code, symbol tables or relocations. Anything
+    // else is one region covering the whole buffer.
+    struct Region { std::size_t from, to; const std::string* name; };
+    static const std::string kNoSection;
+    std::vector<dyn::Section> sections;
+    if (isBin && dyn::isELF(buffer)) sections = dyn::parseELFSections(buffer);
+    std::vector<Region> textRegions, byteRegions;
+    if (sections.empty()) {
+        textRegions.push_back({ 0, buffer.size(), &kNoSection });
+        byteRegions = textRegions;
+    }
+    for (const auto& sec : sections) {
+        const bool debug = dyn::isELFDebugSection(sec);
+        if (debug && !activeOpt.scanDebugSections) continue;
+        const Region r{ (std::size_t)sec.offset, (std::size_t)(sec.offset + sec.size), &sec.name };
+        if (debug || dyn::isELFStringSection(sec)) textRegions.push_back(r);
+        if (debug || dyn::isELFDataSection(sec)) byteRegions.push_back(r);
+    }
+    // Authenticode signatures are decoded in place. When the certificate table (plus zero
+    // padding) is all that follows the section data, the OID byte search stops before it.
+    const dyn::PEImage peImage(buffer);
+    if (isBin && peImage.valid()) {
+        bool decoded = false, undecoded = false;
+        for (const auto& c : peImage.certificates()) {
+            const bool ok = c.type == kWinCertTypePkcsSignedData
+                && pushAuthenticode(results, filePath, c.offset, buffer.data() + c.offset, (long)c.size, 0);
+            (ok ? decoded : undecoded) = true;
+        }
+        std::uint32_t certOff = 0, certSize = 0;
+        peImage.directory(dyn::PEImage::kSecurity, certOff, certSize);
+        const std::size_t tail = peImage.imageDataEnd();
+        auto zeros = [&](std::size_t from, std::size_t to) {
+            return std::all_of(buffer.begin() + from, buffer.begin() + to, [](unsigned char b){ return b == 0; });
+        };
+        if (decoded && !undecoded && certOff >= tail && zeros(tail, certOff) && zeros((std::size_t)certOff + certSize, buffer.size())) {
+            for (auto& r : byteRegions) r.to = std::min(r.to, tail);
+        }
+        // Managed metadata is read table by table below; its #Strings heap would otherwise meet
+        // the text patterns as a run of bare identifiers.
+        std::size_t mdFrom = 0, mdTo = 0;
+        if (dotnetRules && analyzers::DotNetMetadataScanner::metadataRange(peImage, buffer, mdFrom, mdTo)) {
+            std::vector<Region> cut;
+            for (const auto& r : textRegions) {
+                if (r.from < mdFrom) cut.push_back({ r.from, std::min(r.to, mdFrom), r.name });
+                if (r.to > mdTo) cut.push_back({ std::max(r.from, mdTo), r.to, r.name });
+            }
+            textRegions.swap(cut);
+        }
+    }
+    // Go binaries are answered from the linker's own tables; the text patterns over their
+    // rodata are slow and mostly hit identifiers.
+    if (isBin && (!sections.empty() || peImage.valid())) {
+        bool isGo = false;
+        auto go = analyzers::GoBinaryScanner::scan(filePath, buffer, sections.empty() ? dyn::parsePESections(buffer) : sections, isGo);
+        if (isGo) textRegions.clear();
+        results.insert(results.end(), go.begin(), go.end());
+    }
+    auto byteSection = [&](std::size_t off) -> const std::string& {
+        for (const auto& r : byteRegions) if (off >= r.from && off < r.to) return *r.name;
+        return kNoSection;
+    };
+
+    for (const auto& r : textRegions) {
+        auto strings = FileScanner::extractAsciiStrings(buffer, r.from, r.to, 4);
+        auto strMatches = FileScanner::scanStringsWithOffsets(strings, patterns);
+        for (const auto& kv : strMatches) {
+            const std::string& alg = kv.first;
+            for (const auto& m : kv.second) {
+                Detection d{ filePath, m.second, alg, m.first, evidenceTypeForTextPattern(alg), severityForTextPattern(alg, m.first), *r.name };
+                results.push_back(std::move(d));
+            }
+        }
+    }
+    std::unordered_map<std::string, std::vector<std::pair<std::string, std::size_t>>> byteMatchesAll;
+    for (const auto& r : byteRegions) {
+        for (auto& kv : FileScanner::scanBytesWithOffsets(buffer, r.from, r.to, oidBytePatterns)) {
+            auto& dst = byteMatchesAll[kv.first];
+            dst.insert(dst.end(), kv.second.begin(), kv.second.end());
         }
     }
-    auto byteMatchesAll = FileScanner::scanBytesWithOffsets(buffer, oidBytePatterns);
     std::unordered_map<std::string, std::string> typeByName;
     for (const auto& bp : oidBytePatterns) typeByName[bp.name] = bp.type;
     std::vector<std::size_t> oidAnchors;
@@ -475,14 +665,29 @@ std::vector<Detection> CryptoScanner::scanBinaryWholeFile(const std::string& fil
             if (isCurveParamNName(alg.first)) continue;
             for (const auto& e : alg.second) {
                 if (!nearAny(oidAnchors, e.second, ctxWin)) continue;
-                results.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t) });
+                results.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t), byteSection(e.second) });
             }
         } else if (isOidType(t)) {
             for (const auto& e : alg.second) {
-                results.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t) });
+                results.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t), byteSection(e.second) });
             }
         }
     }
+    // Lookup tables of statically linked crypto sit in read-only data, or in .text next to
+    // hand-written assembly.
+    std::vector<Region> constRegions = byteRegions;
+    for (const auto& sec : sections) {
+        if (!sec.segment && dyn::isELFCodeSection(sec)) constRegions.push_back({ (std::size_t)sec.offset, (std::size_t)(sec.offset + sec.size), &sec.name });
+    }
+    for (const auto& r : constRegions) {
+        for (const auto& h : constantTables.scan(buffer, r.from, r.to)) {
+            const ConstantPattern& t = *h.table;
+            std::string shown = std::to_string(h.matched) + "/" + std::to_string(t.words.size());
+            if (t.wordBytes == 1) shown += " bytes";
+            else shown += " " + std::to_string(t.wordBytes * 8) + "-bit words " + (h.bigEndian ? "big-endian" : "little-endian");
+            results.push_back({ filePath, h.offset, t.name, shown, "constant", t.severity, *r.name });
+        }
+    }
     if (isBin) {
         bool elf = dyn::isELF(buffer);
         bool pe  = dyn::isPE(buffer);
@@ -492,45 +697,101 @@ std::vector<Detection> CryptoScanner::scanBinaryWholeFile(const std::string& fil
                 std::string sev = "low";
                 std::string low = toLowerStr(imp.lib);
                 if (low.find("crypto") != std::string::npos || low.find("openssl") != std::string::npos || low.find("mbed") != std::string::npos || low.find("wolf") != std::string::npos || low.find("gnutls") != std::string::npos || low.find("nss") != std::string::npos || low.find("gcrypt") != std::string::npos || low.find("sodium") != std::string::npos || low.find("nettle") != std::string::npos || low.find("botan") != std::string::npos) sev = "med";
-                results.push_back({ filePath, 0, std::string("ELF DT_NEEDED"), imp.lib, "import", sev });
+                results.push_back({ filePath, 0, std::string("ELF DT_NEEDED"), imp.lib, "import", sev, ".dynamic" });
+            }
+            for (const auto& sym : dyn::parseELFImports(buffer)) {
+                const auto& hits = importedApiHits(sym.name);
+                if (hits.empty()) continue;
+                const std::string shown = sym.version.empty() ? sym.name : sym.name + "@" + sym.version;
+                for (const auto& h : hits) {
+                    results.push_back({ filePath, (std::size_t)sym.offset, h.algorithm, shown, "api", h.severity, ".dynsym" });
+                }
             }
         } else if (pe) {
-            auto imps = dyn::parsePE(buffer);
-            for (const auto& imp : imps) {
+            for (const auto& imp : peImage.imports()) {
+                const std::string lib(imp.lib);
                 std::string sev = "low";
-                std::string low = toLowerStr(imp.lib);
+                std::string low = toLowerStr(lib);
                 if (low.find("crypt") != std::string::npos || low.find("bcrypt") != std::string::npos || low.find("crypt32") != std::string::npos || low.find("ncrypt") != std::string::npos || low.find("schannel") != std::string::npos || low.find("secur32") != std::string::npos || low.find("libcrypto") != std::string::npos || low.find("openssl") != std::string::npos) sev = "med";
-                results.push_back({ filePath, 0, std::string("PE IMPORT"), imp.lib, "import", sev });
+                const char* kind = imp.kind == dyn::PEImportKind::Delay ? "PE DELAY IMPORT" : "PE IMPORT";
+                results.push_back({ filePath, imp.offset, std::string(kind), lib, "import", sev, "" });
                 for (const auto& fn : imp.funcs) {
-                    for (const auto& ap : patternsApiOnly) {
-                        try {
-                            std::smatch m;
-                            if (std::regex_search(fn, m, ap.pattern)) {
-                                results.push_back({ filePath, 0, ap.name, fn, "api", severityForTextPattern(ap.name, fn) });
-                            }
-                        } catch (...) {}
+                    if (fn.name.empty()) continue;
+                    for (const auto& h : importedApiHits(fn.name)) {
+                        results.push_back({ filePath, fn.offset, h.algorithm, std::string(fn.name), "api", h.severity, "" });
                     }
-                    std::string fl = toLowerStr(fn);
-                    bool weak = fl.find("md5")!=std::string::npos || fl.find("sha1")!=std::string::npos || fl.find("des_")!=std::string::npos || fl.find("rc4")!=std::string::npos || fl.find("rc2")!=std::string::npos || fl.find("rsa_generate_key")!=std::string::npos || fl.find("seed")!=std::string::npos;
-                    if (weak) results.push_back({ filePath, 0, std::string("ImportedWeakCrypto"), fn, "api", "med" });
+                    if (hasWeakImportKeyword(fn.name)) {
+                        results.push_back({ filePath, fn.offset, std::string("ImportedWeakCrypto"), std::string(fn.name), "api", "med", "" });
+                    }
+                }
+            }
+            // A DLL that exports crypto entry points implements them rather than calling them.
+            for (const auto& ex : peImage.exports()) {
+                if (ex.name.empty()) continue;
+                for (const auto& h : importedApiHits(ex.name)) {
+                    results.push_back({ filePath, ex.offset, h.algorithm, std::string(ex.name), "export", h.severity, "" });
                 }
             }
+            if (dotnetRules && classRules) {
+                auto managed = analyzers::DotNetMetadataScanner::scan(filePath, buffer, peImage, *dotnetRules, *classRules);
+                results.insert(results.end(), managed.begin(), managed.end());
+            }
+        }
+        for (const auto& f : analyzers::InsnScanner::scan(buffer)) {
+            char range[64];
+            std::snprintf(range, sizeof(range), "[0x%llx-0x%llx]", (unsigned long long)f.startAddr, (unsigned long long)f.endAddr);
+            std::string shown = f.function.empty() ? std::string(range) : f.function + " " + range;
+            for (std::size_t i = 0; i < f.mnemonics.size(); ++i) {
+                shown += (i ? " " : ": ") + f.mnemonics[i].first + "*" + std::to_string(f.mnemonics[i].second);
+            }
+            const std::string sev = f.family.find("SHA-1") != std::string::npos ? "med" : "low";
+            results.push_back({ filePath, f.offset, f.family, shown, "instruction", sev, f.section });
         }
         postprocessDetections(results);
     }
-    FileScanner::clearCurrentSourceName();
     return results;
 }
 
+const std::vector<CryptoScanner::ApiHit>& CryptoScanner::importedApiHits(std::string_view fn) {
+    static const std::vector<ApiHit> kNone;
+    std::vector<std::size_t> ids;
+    apiNames.candidates(fn, ids);
+    if (ids.empty()) return kNone;
+    const std::string name(fn);
+    {
+        std::lock_guard<std::mutex> lk(importHitsMutex);
+        auto it = importHits.find(name);
+        if (it != importHits.end()) return it->second;
+    }
+    std::vector<ApiHit> hits;
+    for (std::size_t id : ids) {
+        const auto& ap = patternsApiOnly[id];
+        try {
+            std::smatch m;
+            if (std::regex_search(name, m, ap.pattern)) hits.push_back({ ap.name, severityForTextPattern(ap.name, name) });
+        } catch (...) {}
+    }
+    std::lock_guard<std::mutex> lk(importHitsMutex);
+    // unordered_map never moves its nodes, so the reference stays valid after later inserts.
+    return importHits.emplace(name, std::move(hits)).first->second;
+}
+
 std::vector<Detection> CryptoScanner::scanClassFileDetailed(const std::string& filePath) {
-    std::vector<Detection> out;
     std::vector<unsigned char> data;
-    if (!readAllBytes(filePath, data)) return out;
+    if (!readAllBytes(filePath, data)) return {};
+    return scanClassBytes(filePath, data);
+}
+
+std::vector<Detection> CryptoScanner::scanClassBytes(const std::string& filePath, const std::vector<unsigned char>& data) {
+    if (classRules && analyzers::JavaBytecodeScanner::isClassFile(data)) {
+        return analyzers::JavaBytecodeScanner::scanClassBytes(filePath, data, *classRules);
+    }
+    std::vector<Detection> out;
     auto strings = FileScanner::extractAsciiStrings(data, 4);
     auto strMatches = FileScanner::scanStringsWithOffsets(strings, patterns);
     for (const auto& kv : strMatches) {
         for (const auto& m : kv.second) {
-            out.push_back({ filePath, m.second, kv.first, m.first, evidenceTypeForTextPattern(kv.first), severityForTextPattern(kv.first, m.first) });
+            out.push_back({ filePath, m.second, kv.first, m.first, evidenceTypeForTextPattern(kv.first), severityForTextPattern(kv.first, m.first), "" });
         }
     }
     auto byteMatchesAll = FileScanner::scanBytesWithOffsets(data, oidBytePatterns);
@@ -551,212 +812,439 @@ std::vector<Detection> CryptoScanner::scanClassFileDetailed(const std::string& f
             if (isCurveParamNName(alg.first)) continue;
             for (const auto& e : alg.second) {
                 if (!nearAny(oidAnchors, e.second, ctxWin)) continue;
-                out.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t) });
+                out.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t), "" });
             }
         } else if (isOidType(t)) {
             for (const auto& e : alg.second) {
-                out.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t) });
+                out.push_back({ filePath, e.second, alg.first, e.first, evidenceLabelForByteType(t), severityForByteType(t), "" });
             }
         }
     }
     return out;
 }
 
-#ifdef USE_MINIZ
-static std::string sev_text_local(const std::string& algName, const std::string& matched) {
-    (void)matched;
-    if (algName.find("OID dotted") != std::string::npos) return "high";
-    if (algName.find("PEM Header") != std::string::npos) return "med";
-    if (algName.find("API (OpenSSL)") != std::string::npos
-        || algName.find("API (Windows CNG/CAPI)") != std::string::npos
-        || algName.find("API (libgcrypt)") != std::string::npos) return "med";
-    if (algName.find("MD5") != std::string::npos || algName.find("SHA-1") != std::string::npos) return "med";
-    return "low";
+std::vector<Detection> CryptoScanner::scanSource(const std::string& displayPath, analyzers::SourceLang lang, std::string_view code) {
+    if (!sourcePrefilter.matches(code)) {
+        astSkipped.fetch_add(1);
+        return {};
+    }
+    if (activeOpt.lexerOnly || (activeOpt.lexerOnlyAboveBytes && code.size() >= activeOpt.lexerOnlyAboveBytes)) {
+        astLexed.fetch_add(1);
+        const char* name = lang == analyzers::SourceLang::Java ? "java" : lang == analyzers::SourceLang::Python ? "python" : "cpp";
+        return matchAstSymbols(analyzers::LexerScanner::collectSymbols(displayPath, lang, code, callSiteFilter(name)));
+    }
+    astParsed.fetch_add(1);
+    if (activeOpt.astTreeCacheBytes) {
+        const char* name = lang == analyzers::SourceLang::Java ? "java" : lang == analyzers::SourceLang::Python ? "python" : "cpp";
+        auto& cache = analyzers::TreeCache::shared();
+        cache.setBudget((std::size_t)activeOpt.astTreeCacheBytes);
+        auto calls = cache.scan(displayPath, lang, code, ruleSetHash, callSiteFilter(name),
+                                [this](const AstSymbol& s) { return evaluateAstSymbol(s); });
+        std::vector<Detection> out;
+        for (const auto& c : calls) {
+            for (const auto& f : c.findings) {
+                out.push_back({ displayPath, c.sym.line, f.algorithm, f.matchString, f.evidenceType, f.severity, "" });
+            }
+        }
+        return out;
+    }
+    switch (lang) {
+        case analyzers::SourceLang::Java:
+            return matchAstSymbols(analyzers::JavaASTScanner::collectSymbols(displayPath, code, callSiteFilter("java")));
+        case analyzers::SourceLang::Python:
+            return matchAstSymbols(analyzers::PythonASTScanner::collectSymbols(displayPath, code, callSiteFilter("python")));
+        case analyzers::SourceLang::Cpp:
+            return matchAstSymbols(analyzers::CppASTScanner::collectSymbols(displayPath, code, callSiteFilter("cpp")));
+    }
+    return {};
 }
-static std::string sev_byte_local(const std::string& type) {
-    if (type == "oid" || type == "asn1-oid" || type == "asn1_oid") return "high";
-    if (type == "curve_param" || type == "prime") return "med";
-    return "low";
+
+std::vector<Detection> CryptoScanner::scanSourceFile(const std::string& filePath, analyzers::SourceLang lang) {
+    analyzers::MappedFile src;
+    if (!src.open(filePath)) return {};
+    return scanSource(filePath, lang, src.view());
 }
-static std::string evtype_text_local(const std::string& algName) {
-    std::string s = toLowerStr(algName);
-    if (s.find("oid") != std::string::npos) return "oid";
-    if (s.find("pem") != std::string::npos) return "pem";
-    if (s.find("api") != std::string::npos) return "api";
-    return "text";
+
+std::vector<Detection> CryptoScanner::matchAstSymbols(const std::vector<AstSymbol>& syms) {
+    std::vector<Detection> out;
+    for (const auto& s : syms) {
+        for (auto& f : evaluateAstSymbol(s)) {
+            out.push_back({ s.filePath, s.line, std::move(f.algorithm), std::move(f.matchString), std::move(f.evidenceType), std::move(f.severity), "" });
+        }
+    }
+    return out;
 }
-static std::string evlabel_byte_local(const std::string& type) {
-    if (type == "oid" || type == "asn1-oid" || type == "asn1_oid") return "oid";
-    if (type == "curve_param") return "curve_param";
-    if (type == "prime") return "prime";
-    return "bytes";
+
+std::vector<AstFinding> CryptoScanner::evaluateAstSymbol(const AstSymbol& s) {
+    std::vector<AstFinding> out;
+    auto hits = astRules.evaluate(s);
+    for (const auto* r : hits) {
+        out.push_back({ r->message.empty() ? r->id : r->message, r->id, "ast", r->severity.empty() ? "low" : r->severity });
+    }
+    if (!hits.empty()) return out;
+    std::vector<std::string> cands{ s.callee_full };
+    if (s.callee_base != s.callee_full) cands.push_back(s.callee_base);
+    if (!s.first_arg.empty()) cands.push_back(s.first_arg);
+    for (const auto& cand : cands) {
+        if (cand.empty()) continue;
+        for (const auto& ap : patterns) {
+            try {
+                std::smatch m;
+                if (std::regex_search(cand, m, ap.pattern)) {
+                    out.push_back({ ap.name, m.str(0), "ast", severityForTextPattern(ap.name, m.str(0)) });
+                }
+            } catch (...) {}
+        }
+    }
+    return out;
+}
+
+CallSiteFilter CryptoScanner::callSiteFilter(const char* lang) const {
+    const std::string l = lang;
+    return [this, l](std::string_view callee, std::string_view firstArg) {
+        return astRules.hasCallee(l, callee) || callSiteMayMatch(callSiteStems, callee, firstArg);
+    };
 }
-static std::vector<Detection> scanJarViaMiniZ_impl(const std::string& filePath,
-                                                   const std::vector<AlgorithmPattern>& patterns,
-                                                   const std::vector<BytePattern>& oidBytePatterns) {
+
+enum class ArchiveEntryKind { None, Java, Class, Archive, Container, Binary, Cert, Python, Cpp };
+
+static bool isCppSourceExt(const std::string& ext) {
+    return ext == ".c" || ext == ".cc" || ext == ".cpp" || ext == ".cxx" || ext == ".h" || ext == ".hpp" || ext == ".hh";
+}
+
+static ArchiveEntryKind archiveEntryKind(const std::string& entry) {
+    const std::string ext = CryptoScanner::lowercaseExt(entry);
+    if (ext == ".java") return ArchiveEntryKind::Java;
+    if (ext == ".class") return ArchiveEntryKind::Class;
+    if (isJarLikeExt(ext)) return ArchiveEntryKind::Archive;
+    if (container::kindForName(entry) != container::Kind::None) return ArchiveEntryKind::Container;
+    if (CryptoScanner::isCertOrKeyExt(ext)) return ArchiveEntryKind::Cert;
+    if (ext == ".py") return ArchiveEntryKind::Python;
+    if (isCppSourceExt(ext)) return ArchiveEntryKind::Cpp;
+    static const std::unordered_set<std::string> binExts = { ".so", ".dll", ".exe", ".dylib", ".dex", ".node", ".a", ".sys" };
+    if (binExts.count(ext)) return ArchiveEntryKind::Binary;
+    std::string base = entry.substr(entry.find_last_of('/') + 1);
+    if (base.find(".so.") != std::string::npos) return ArchiveEntryKind::Binary;
+    return ArchiveEntryKind::None;
+}
+
+struct ArchiveScanState {
+    scanprofile::JarLimits limits;
+    std::uint64_t inflateCap = 0;
+    std::atomic<std::uint64_t> inflated{0};
+};
+
+static const int kArchiveMaxDepth = 4;
+static const std::uint64_t kArchiveDefaultInflateCap = 1ull << 30;
+
+std::vector<Detection> CryptoScanner::scanBufferByName(const std::string& displayPath, const std::vector<unsigned char>& data, int depth, ArchiveScanState& st,
+                                                       const governor::MemoryReservation* holding) {
+    const ArchiveEntryKind kind = archiveEntryKind(displayPath);
+    switch (kind) {
+        case ArchiveEntryKind::Java:
+            return scanSource(displayPath, analyzers::SourceLang::Java, std::string_view((const char*)data.data(), data.size()));
+        case ArchiveEntryKind::Class:
+            return scanClassBytes(displayPath, data);
+        case ArchiveEntryKind::Cert:
+            return scanCertOrKeyBytes(displayPath, data);
+        case ArchiveEntryKind::Python:
+            return scanSource(displayPath, analyzers::SourceLang::Python, std::string_view((const char*)data.data(), data.size()));
+        case ArchiveEntryKind::Cpp:
+            return scanSource(displayPath, analyzers::SourceLang::Cpp, std::string_view((const char*)data.data(), data.size()));
+        case ArchiveEntryKind::Archive:
+#ifdef USE_MINIZ
+            if (depth < kArchiveMaxDepth) return scanZipArchive(displayPath, std::string(), &data, depth + 1, st, holding);
+#endif
+            return {};
+        case ArchiveEntryKind::Container:
+            if (depth < kArchiveMaxDepth) return scanContainer(displayPath, std::string(), &data, depth + 1, st, holding);
+            return {};
+        case ArchiveEntryKind::Binary:
+        case ArchiveEntryKind::None: {
+            bool isBin = dyn::isELF(data) || dyn::isPE(data);
+            if (!isBin && kind == ArchiveEntryKind::None) return {};
+            auto v = scanBinaryBytes(displayPath, data, isBin);
+            exporter.stage(displayPath, std::string(), data);
+            return v;
+        }
+    }
+    return {};
+}
+
+std::vector<Detection> CryptoScanner::scanContainer(const std::string& displayPath, const std::string& filePath,
+                                                    const std::vector<unsigned char>* mem, int depth, ArchiveScanState& st,
+                                                    const governor::MemoryReservation* holding) {
     std::vector<Detection> results;
-    mz_zip_archive zip; std::memset(&zip, 0, sizeof(zip));
-    if (!mz_zip_reader_init_file(&zip, filePath.c_str(), 0)) return results;
-    const int n = (int)mz_zip_reader_get_num_files(&zip);
-    for (int i = 0; i < n; ++i) {
-        mz_zip_archive_file_stat st; std::memset(&st, 0, sizeof(st));
-        if (!mz_zip_reader_file_stat(&zip, i, &st)) continue;
-        if (st.m_is_directory) continue;
-        std::string entry = st.m_filename[0] ? st.m_filename : "";
-        std::string ext = CryptoScanner::lowercaseExt(entry);
-        if (!(ext == ".class" || ext == ".java")) continue;
-        size_t out_size = 0;
-        void* p = mz_zip_reader_extract_to_heap(&zip, i, &out_size, 0);
-        if (!p) continue;
-        std::vector<unsigned char> data((unsigned char*)p, (unsigned char*)p + out_size);
-        mz_free(p);
-        std::string display = filePath + "::" + entry;
-        if (ext == ".java") {
-            std::string src((const char*)data.data(), data.size());
-            auto syms = analyzers::JavaASTScanner::collectSymbols(display, src);
-            for (const auto& s : syms) {
-                std::vector<std::string> cands;
-                cands.push_back(s.callee_full);
-                if (s.callee_base != s.callee_full) cands.push_back(s.callee_base);
-                if (!s.first_arg.empty()) cands.push_back(s.first_arg);
-                for (const auto& cand : cands) {
-                    if (cand.empty()) continue;
-                    for (const auto& ap : patterns) {
-                        try {
-                            std::smatch m;
-                            if (std::regex_search(cand, m, ap.pattern)) {
-                                results.push_back({ s.filePath, s.line, ap.name, m.str(0), "ast", sev_text_local(ap.name, m.str(0)) });
-                            }
-                        } catch (...) {}
-                    }
-                }
+    const container::Kind kind = container::kindForName(displayPath);
+    container::Limits lim;
+    lim.maxTotal = st.inflateCap;
+    lim.maxMembers = st.limits.maxEntries;
+    auto want = [&](const container::Member& m) {
+        if (kind == container::Kind::Gzip) return true;
+        ArchiveEntryKind k = archiveEntryKind(m.name);
+        if (k == ArchiveEntryKind::Java && st.limits.maxEntryJava && m.size > st.limits.maxEntryJava) return false;
+        if (k == ArchiveEntryKind::Class && st.limits.maxEntryClass && m.size > st.limits.maxEntryClass) return false;
+        if ((k == ArchiveEntryKind::Archive || k == ArchiveEntryKind::Container) && depth >= kArchiveMaxDepth) return false;
+        return k != ArchiveEntryKind::None || (m.mode & 0111) != 0;
+    };
+    // Each member is reserved before the walker reads it and stays reserved while it is
+    // scanned, including the walk of a nested archive or container, whose members reserve
+    // under it.
+    std::unique_ptr<governor::MemoryReservation> held;
+    container::Hooks hooks;
+    hooks.beforeRead = [&](const container::Member& m) {
+        held.reset();
+        if (cancelCb && cancelCb()) return false;
+        if (st.inflated.fetch_add(m.size) + m.size > st.inflateCap) return false;
+        held = std::make_unique<governor::MemoryReservation>(&memBudget, m.size, cancelCb, holding);
+        return held->ok();
+    };
+    hooks.skipped = [&](const std::string& name, const std::string& reason) {
+        results.push_back({ displayPath + "::" + name, 0, "Not scanned", reason, "skipped", "low", "" });
+    };
+    auto onMember = [&](const container::Member& m, const std::vector<unsigned char>& data) {
+        std::unique_ptr<governor::MemoryReservation> res = std::move(held);
+        const std::string display = displayPath + "::" + m.name;
+        const ArchiveEntryKind entryKind = archiveEntryKind(m.name);
+        std::vector<Detection> v;
+        if (kind == container::Kind::Gzip && entryKind == ArchiveEntryKind::None && !dyn::isELF(data) && !dyn::isPE(data)) {
+            v = scanBinaryBytes(display, data, false);
+        } else {
+            v = scanBufferByName(display, data, depth, st, res.get());
+        }
+        results.insert(results.end(), v.begin(), v.end());
+        return true;
+    };
+    if (mem) container::walkBuffer(*mem, displayPath, kind, lim, want, onMember, hooks);
+    else container::walkFile(filePath, kind, lim, want, onMember, hooks);
+    return results;
+}
+
+std::vector<Detection> CryptoScanner::scanContainerFile(const std::string& filePath) {
+    if (!activeOpt.deepJar) return {};
+    ArchiveScanState st;
+    st.limits = effectiveJarLimits();
+    st.inflateCap = st.limits.maxTotalUncomp ? st.limits.maxTotalUncomp : kArchiveDefaultInflateCap;
+    return scanContainer(filePath, filePath, nullptr, 0, st);
+}
+
+static const std::size_t kArParallelMinMembers = 16;
+static const std::uint64_t kArMaxMember = 256ull << 20;
+
+std::vector<Detection> CryptoScanner::scanStaticArchiveFile(const std::string& filePath) {
+    container::ArIndex ar;
+    if (!container::readArIndex(filePath, ar)) {
+        governor::MemoryReservation mem(&memBudget, (std::uint64_t)getFileSizeSafe(filePath), cancelCb);
+        if (!mem.ok()) return {};
+        return scanBinaryWholeFile(filePath);
+    }
+    std::vector<Detection> results;
+    // The armap lists every global each member defines, so API names need no member reads. The
+    // detection names the defining member but its offset is the name's in the archive's symbol
+    // table, which section "armap" says.
+    for (const auto& s : ar.symbols) {
+        for (const auto& h : importedApiHits(s.name)) {
+            results.push_back({ filePath + "::" + ar.members[s.member].name, (std::size_t)s.offset, h.algorithm, s.name, "armap", h.severity, "armap" });
+        }
+    }
+    std::vector<std::vector<Detection>> perMember(ar.members.size());
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> stop{false};
+    auto worker = [&]() {
+        std::vector<unsigned char> data;
+        while (!stop.load()) {
+            const std::size_t k = next.fetch_add(1);
+            if (k >= ar.members.size()) break;
+            if (cancelCb && cancelCb()) { stop = true; break; }
+            const container::ArMember& m = ar.members[k];
+            if (m.size == 0) continue;
+            if (m.size > kArMaxMember) {
+                perMember[k].push_back({ filePath + "::" + m.name, 0, "Not scanned",
+                                         "larger than the " + std::to_string(kArMaxMember >> 20) + " MiB member limit", "skipped", "low", "" });
+                continue;
             }
-            return results;
-        }
-        if (ext == ".class") {
-            auto strings = FileScanner::extractAsciiStrings(data, 4);
-            auto strMatches = FileScanner::scanStringsWithOffsets(strings, patterns);
-            for (const auto& kv : strMatches) {
-                for (const auto& m : kv.second) {
-                    results.push_back({ display, m.second, kv.first, m.first, evtype_text_local(kv.first), sev_text_local(kv.first, m.first) });
-                }
+            governor::MemoryReservation res(&memBudget, m.size, cancelCb);
+            if (!res.ok()) { stop = true; break; }
+            if (!container::readArMember(filePath, m, data)) continue;
+            // ELF objects go through the section-aware path; anything else (COFF, bitcode) is one region.
+            perMember[k] = scanBinaryBytes(filePath + "::" + m.name, data, dyn::isELF(data) || dyn::isPE(data));
+        }
+    };
+    unsigned int th = 1;
+    if (ar.members.size() >= kArParallelMinMembers) {
+        th = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+        th = (unsigned int)std::min<std::size_t>(th, ar.members.size() / (kArParallelMinMembers / 4));
+    }
+    if (th <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned int t = 0; t < th; ++t) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
+    }
+    for (auto& v : perMember) results.insert(results.end(), v.begin(), v.end());
+    // The exporter reads the archive from disk itself; the magic is all it needs to classify it.
+    static const std::vector<unsigned char> kArMagic = { '!', '<', 'a', 'r', 'c', 'h', '>', '\n' };
+    exporter.stage(filePath, filePath, kArMagic);
+    return results;
+}
+
+#ifdef USE_MINIZ
+struct JarEntryPlan {
+    mz_uint index;
+    std::string name;
+    ArchiveEntryKind kind;
+    std::size_t size;
+};
+
+static const std::size_t kJarMaxRatio = 200;
+static const std::size_t kJarParallelMinEntries = 64;
+static const std::size_t kJarReadBufSize = 64 * 1024;
+
+static bool openZipReader(mz_zip_archive& zip, const std::string& filePath, const std::vector<unsigned char>* mem) {
+    std::memset(&zip, 0, sizeof(zip));
+    if (mem) return mz_zip_reader_init_mem(&zip, mem->data(), mem->size(), 0) != 0;
+    return mz_zip_reader_init_file(&zip, filePath.c_str(), 0) != 0;
+}
+
+std::vector<Detection> CryptoScanner::scanZipArchive(const std::string& displayPath, const std::string& filePath,
+                                                     const std::vector<unsigned char>* mem, int depth, ArchiveScanState& st,
+                                                     const governor::MemoryReservation* holding) {
+    std::vector<Detection> results;
+    std::vector<JarEntryPlan> plan;
+    {
+        mz_zip_archive zip;
+        if (!openZipReader(zip, filePath, mem)) return results;
+        const mz_uint n = mz_zip_reader_get_num_files(&zip);
+        std::size_t total = 0;
+        for (mz_uint i = 0; i < n; ++i) {
+            if (st.limits.maxEntries && plan.size() >= st.limits.maxEntries) break;
+            mz_zip_archive_file_stat fst; std::memset(&fst, 0, sizeof(fst));
+            if (!mz_zip_reader_file_stat(&zip, i, &fst)) continue;
+            if (fst.m_is_directory || !fst.m_is_supported) continue;
+            std::string entry = fst.m_filename[0] ? fst.m_filename : "";
+            ArchiveEntryKind kind = archiveEntryKind(entry);
+            if (kind == ArchiveEntryKind::None) continue;
+            if (kind == ArchiveEntryKind::Archive && depth >= kArchiveMaxDepth) continue;
+            const std::size_t usz = (std::size_t)fst.m_uncomp_size;
+            if (usz == 0) continue;
+            std::size_t entryCap = 0;
+            if (kind == ArchiveEntryKind::Java) entryCap = st.limits.maxEntryJava;
+            else if (kind == ArchiveEntryKind::Class) entryCap = st.limits.maxEntryClass;
+            // Entries left out for size or ratio are reported like the container walker's skips.
+            if (entryCap && usz > entryCap) {
+                results.push_back({ displayPath + "::" + entry, 0, "Not scanned",
+                                    "larger than the " + std::to_string(entryCap >> 10) + " KiB entry limit", "skipped", "low", "" });
+                continue;
             }
-            auto byteMatchesAll = FileScanner::scanBytesWithOffsets(data, oidBytePatterns);
-            std::unordered_map<std::string, std::string> typeByName;
-            for (const auto& bp : oidBytePatterns) typeByName[bp.name] = bp.type;
-            std::vector<std::size_t> oidAnchors;
-            for (const auto& alg : byteMatchesAll) {
-                const std::string t = typeByName.count(alg.first) ? typeByName[alg.first] : std::string();
-                if (!isOidType(t)) continue;
-                for (const auto& e : alg.second) oidAnchors.push_back(e.second);
+            if (fst.m_comp_size > 0 && usz / (std::size_t)fst.m_comp_size > kJarMaxRatio) {
+                results.push_back({ displayPath + "::" + entry, 0, "Not scanned",
+                                    "compression ratio above " + std::to_string(kJarMaxRatio) + ":1", "skipped", "low", "" });
+                continue;
             }
-            std::sort(oidAnchors.begin(), oidAnchors.end());
-            oidAnchors.erase(std::unique(oidAnchors.begin(), oidAnchors.end()), oidAnchors.end());
-            const std::size_t ctxWin = 2048;
-            for (const auto& alg : byteMatchesAll) {
-                const std::string t = typeByName.count(alg.first) ? typeByName[alg.first] : std::string();
-                if (t == "curve_param" || t == "prime") {
-                    if (isCurveParamNName(alg.first)) continue;
-                    for (const auto& e : alg.second) {
-                        if (!nearAny(oidAnchors, e.second, ctxWin)) continue;
-                        results.push_back({ display, e.second, alg.first, e.first, evlabel_byte_local(t), sev_byte_local(t) });
-                    }
-                } else if (isOidType(t)) {
-                    for (const auto& e : alg.second) {
-                        results.push_back({ display, e.second, alg.first, e.first, evlabel_byte_local(t), sev_byte_local(t) });
-                    }
-                }
+            if (st.limits.maxTotalUncomp && total + usz > st.limits.maxTotalUncomp) break;
+            total += usz;
+            plan.push_back({ i, entry, kind, usz });
+        }
+        mz_zip_reader_end(&zip);
+    }
+    if (plan.empty()) return results;
+
+    std::vector<std::vector<Detection>> perEntry(plan.size());
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> stop{false};
+    auto worker = [&]() {
+        mz_zip_archive zip;
+        if (!openZipReader(zip, filePath, mem)) return;
+        std::vector<unsigned char> outBuf;
+        std::vector<unsigned char> readBuf(kJarReadBufSize);
+        while (!stop.load()) {
+            const std::size_t k = next.fetch_add(1);
+            if (k >= plan.size()) break;
+            if (cancelCb && cancelCb()) { stop = true; break; }
+            const JarEntryPlan& e = plan[k];
+            if (st.inflated.fetch_add(e.size) + e.size > st.inflateCap) { stop = true; break; }
+            governor::MemoryReservation res(&memBudget, (std::uint64_t)e.size, cancelCb, holding);
+            if (!res.ok()) { stop = true; break; }
+            const std::string display = displayPath + "::" + e.name;
+            // The inflated bytes stay reserved while a nested archive or container is walked;
+            // its entries reserve under this one.
+            if (e.kind == ArchiveEntryKind::Archive) {
+                std::vector<unsigned char> inner(e.size);
+                if (!mz_zip_reader_extract_to_mem_no_alloc(&zip, e.index, inner.data(), inner.size(), 0, readBuf.data(), readBuf.size())) continue;
+                perEntry[k] = scanZipArchive(display, std::string(), &inner, depth + 1, st, &res);
+                continue;
             }
-            return results;
+            outBuf.resize(e.size);
+            if (!mz_zip_reader_extract_to_mem_no_alloc(&zip, e.index, outBuf.data(), e.size, 0, readBuf.data(), readBuf.size())) continue;
+            perEntry[k] = scanBufferByName(display, outBuf, depth, st, &res);
         }
+        mz_zip_reader_end(&zip);
+    };
+    unsigned int th = 1;
+    if (depth == 0 && plan.size() >= kJarParallelMinEntries) {
+        th = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+        th = (unsigned int)std::min<std::size_t>(th, plan.size() / (kJarParallelMinEntries / 4));
+    }
+    if (th <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned int t = 0; t < th; ++t) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
     }
-    mz_zip_reader_end(&zip);
+    for (auto& v : perEntry) results.insert(results.end(), v.begin(), v.end());
     return results;
 }
 #endif
 
 std::vector<Detection> CryptoScanner::scanJarViaMiniZ(const std::string& filePath) {
 #ifdef USE_MINIZ
-    return scanJarViaMiniZ_impl(filePath, patterns, oidBytePatterns);
+    ArchiveScanState st;
+    st.limits = effectiveJarLimits();
+    st.inflateCap = st.limits.maxTotalUncomp ? st.limits.maxTotalUncomp : kArchiveDefaultInflateCap;
+    return scanZipArchive(filePath, filePath, nullptr, 0, st);
 #else
     return {};
 #endif
 }
 
 std::vector<Detection> CryptoScanner::scanJarFileDetailed(const std::string& filePath) {
+    if (!activeOpt.deepJar) return {};
     return scanJarViaMiniZ(filePath);
 }
 
+scanprofile::JarLimits CryptoScanner::effectiveJarLimits() const {
+    scanprofile::JarLimits lim = { activeOpt.jarMaxEntryJava, activeOpt.jarMaxEntryClass, activeOpt.jarMaxTotalUncomp, activeOpt.jarMaxEntries };
+    if (activeOpt.profile == ScanProfile::InstitutionStrict) {
+        const auto& inst = scanprofile::kInstitutionJarLimits;
+        if (!lim.maxEntryJava) lim.maxEntryJava = inst.maxEntryJava;
+        if (!lim.maxEntryClass) lim.maxEntryClass = inst.maxEntryClass;
+        if (!lim.maxTotalUncomp) lim.maxTotalUncomp = inst.maxTotalUncomp;
+        if (!lim.maxEntries) lim.maxEntries = inst.maxEntries;
+    }
+    return lim;
+}
+
 std::vector<Detection> CryptoScanner::scanFileDetailed(const std::string& filePath) {
     std::vector<Detection> out;
     const std::string ext = lowercaseExt(filePath);
+    const bool streamed = isJarLikeExt(ext) || ext == ".a" || container::kindForName(filePath) != container::Kind::None;
+    governor::MemoryReservation mem(&memBudget, streamed ? 0 : (std::uint64_t)getFileSizeSafe(filePath), cancelCb);
+    if (!mem.ok()) return out;
     if (isCertOrKeyExt(ext) || isLikelyPem(filePath)) {
         auto v = scanCertOrKeyFileDetailed(filePath);
         out.insert(out.end(), v.begin(), v.end());
         return out;
     }
     if (ext == ".py") {
-        auto syms = analyzers::PythonASTScanner::collectSymbols(filePath);
-        for (const auto& s : syms) {
-            std::vector<std::string> cands{ s.callee_full };
-            if (s.callee_base != s.callee_full) cands.push_back(s.callee_base);
-            if (!s.first_arg.empty()) cands.push_back(s.first_arg);
-            for (const auto& cand : cands) {
-                if (cand.empty()) continue;
-                for (const auto& ap : patterns) {
-                    try {
-                        std::smatch m;
-                        if (std::regex_search(cand, m, ap.pattern)) {
-                            out.push_back({ s.filePath, s.line, ap.name, m.str(0), "ast", severityForTextPattern(ap.name, m.str(0)) });
-                        }
-                    } catch (...) {}
-                }
-            }
-        }
-        return out;
+        return scanSourceFile(filePath, analyzers::SourceLang::Python);
     }
     if (ext == ".java") {
-        std::string src;
-        if (readTextFile(filePath, src)) {
-            auto syms = analyzers::JavaASTScanner::collectSymbols(filePath, src);
-            for (const auto& s : syms) {
-                std::vector<std::string> cands{ s.callee_full };
-                if (s.callee_base != s.callee_full) cands.push_back(s.callee_base);
-                if (!s.first_arg.empty()) cands.push_back(s.first_arg);
-                for (const auto& cand : cands) {
-                    if (cand.empty()) continue;
-                    for (const auto& ap : patterns) {
-                        try {
-                            std::smatch m;
-                            if (std::regex_search(cand, m, ap.pattern)) {
-                                out.push_back({ s.filePath, s.line, ap.name, m.str(0), "ast", severityForTextPattern(ap.name, m.str(0)) });
-                            }
-                        } catch (...) {}
-                    }
-                }
-            }
-            return out;
-        }
-    }
-    if (ext == ".c" || ext == ".cc" || ext == ".cpp" || ext == ".cxx" || ext == ".h" || ext == ".hpp" || ext == ".hh") {
-        auto syms = analyzers::CppASTScanner::collectSymbols(filePath);
-        for (const auto& s : syms) {
-            std::vector<std::string> cands{ s.callee_full };
-            if (s.callee_base != s.callee_full) cands.push_back(s.callee_base);
-            if (!s.first_arg.empty()) cands.push_back(s.first_arg);
-            for (const auto& cand : cands) {
-                if (cand.empty()) continue;
-                for (const auto& ap : patterns) {
-                    try {
-                        std::smatch m;
-                        if (std::regex_search(cand, m, ap.pattern)) {
-                            out.push_back({ s.filePath, s.line, ap.name, m.str(0), "ast", severityForTextPattern(ap.name, m.str(0)) });
-                        }
-                    } catch (...) {}
-                }
-            }
-        }
-        return out;
+        return scanSourceFile(filePath, analyzers::SourceLang::Java);
+    }
+    if (isCppSourceExt(ext)) {
+        return scanSourceFile(filePath, analyzers::SourceLang::Cpp);
     }
     if (ext == ".class") {
         auto v = scanClassFileDetailed(filePath);
@@ -768,6 +1256,16 @@ std::vector<Detection> CryptoScanner::scanFileDetailed(const std::string& filePa
         out.insert(out.end(), v.begin(), v.end());
         return out;
     }
+    if (container::kindForName(filePath) != container::Kind::None) {
+        auto v = scanContainerFile(filePath);
+        out.insert(out.end(), v.begin(), v.end());
+        return out;
+    }
+    if (ext == ".a") {
+        auto v = scanStaticArchiveFile(filePath);
+        out.insert(out.end(), v.begin(), v.end());
+        return out;
+    }
     auto v = scanBinaryWholeFile(filePath);
     out.insert(out.end(), v.begin(), v.end());
     return out;
@@ -776,33 +1274,61 @@ std::vector<Detection> CryptoScanner::scanFileDetailed(const std::string& filePa
 std::vector<Detection> CryptoScanner::scanPathRecursive(const std::string& rootPath) {
     std::vector<Detection> out;
     std::error_code ec;
-    if (fs::is_regular_file(rootPath, ec)) {
-        auto v = scanFileDetailed(rootPath);
-        out.insert(out.end(), v.begin(), v.end());
-        return out;
+    const bool single = fs::is_regular_file(rootPath, ec);
+    if (!single && !fs::is_directory(rootPath, ec)) return out;
+    memBudget.setLimit(activeOpt.memoryBudgetBytes ? activeOpt.memoryBudgetBytes : governor::defaultMemoryBudget());
+    memBudget.resetPeak();
+    cacheLeftBytes = 0;
+    cacheTrackedFiles = 0;
+    astParsed = 0;
+    astSkipped = 0;
+    astLexed = 0;
+
+    // First pass: list the files, with their canonical paths when dependencies are resolved.
+    // Symlinks are skipped, as in scanPathLikeAntivirus, so a library reached through a link is
+    // not scanned again under a second key and the root's canonical path prefixes every file.
+    std::vector<std::string> files;
+    std::vector<std::string> canonFiles;
+    std::string rootCanon = fs::weakly_canonical(rootPath, ec).string();
+    if (ec) rootCanon = rootPath;
+    if (single) {
+        files.push_back(rootPath);
+    } else {
+        for (fs::recursive_directory_iterator it(rootPath, fs::directory_options::skip_permission_denied, ec), end; it != end; ++it) {
+            const auto& de = *it;
+            if (de.is_symlink(ec)) continue;
+            if (!de.is_regular_file(ec)) continue;
+            files.push_back(de.path().string());
+        }
     }
-    if (!fs::is_directory(rootPath, ec)) return out;
+    if (activeOpt.resolveLibraries) {
+        for (const auto& f : files) canonFiles.push_back(rootCanon + f.substr(rootPath.size()));
+    }
+    resetLibraryGraph(canonFiles);
 
-    // First pass: count total files
-    int totalFiles = 0;
-    for (fs::recursive_directory_iterator it(rootPath, fs::directory_options::skip_permission_denied, ec), end; it != end; ++it) {
-        const auto& de = *it;
-        if (!de.is_regular_file(ec)) continue;
-        totalFiles++;
+    if (single) {
+        try { out = scanWalkedFile(rootPath, canonFiles.empty() ? std::string() : canonFiles[0], (std::uint64_t)getFileSizeSafe(rootPath)); }
+        catch (...) { out.clear(); }
+        exporter.flush();
+        return out;
     }
+    const int totalFiles = (int)files.size();
 
     // Second pass: scan files with progress reporting
+    governor::BackgroundPriorityScope priority(activeOpt.lowImpact);
     int scannedFiles = 0;
-    for (fs::recursive_directory_iterator it(rootPath, fs::directory_options::skip_permission_denied, ec), end; it != end; ++it) {
-        const auto& de = *it;
-        if (!de.is_regular_file(ec)) continue;
-
-        std::string currentFile = de.path().string();
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const std::string& currentFile = files[i];
+        if (!governor::waitWhilePaused(activeOpt.isPaused, cancelCb)) break;
+        const std::uint64_t size = (std::uint64_t)getFileSizeSafe(currentFile);
+        if (!throttle.beforeFile(size, cancelCb)) break;
 
         // Report progress before scanning each file
         std::cout << "PROGRESS:FILE:" << currentFile << ":" << scannedFiles << ":" << totalFiles << std::endl;
 
-        auto v = scanFileDetailed(currentFile);
+        std::vector<Detection> v;
+        try { v = scanWalkedFile(currentFile, canonFiles.empty() ? std::string() : canonFiles[i], size); }
+        catch (...) { v.clear(); }
         out.insert(out.end(), v.begin(), v.end());
 
         // Output detections immediately as they are found
@@ -813,8 +1339,10 @@ std::vector<Detection> CryptoScanner::scanPathRecursive(const std::string& rootP
                       << detection.algorithm << ","
                       << detection.matchString << ","
                       << detection.evidenceType << ","
-                      << detection.severity << std::endl;
+                      << detection.severity << ","
+                      << detection.section << std::endl;
         }
+        exporter.flush();
 
         scannedFiles++;
 
@@ -825,6 +1353,188 @@ std::vector<Detection> CryptoScanner::scanPathRecursive(const std::string& rootP
     return out;
 }
 
+void CryptoScanner::setThrottle(std::uint64_t bytesPerSec, std::uint64_t filesPerSec) {
+    throttle.setBudget(bytesPerSec, filesPerSec);
+}
+
+void CryptoScanner::setLowImpact(bool on) {
+    activeOpt.lowImpact = on;
+}
+
+void CryptoScanner::setPauseCheck(const std::function<bool()>& isPaused) {
+    activeOpt.isPaused = isPaused;
+}
+
+void CryptoScanner::setMemoryBudget(std::uint64_t bytes) {
+    activeOpt.memoryBudgetBytes = bytes;
+    memBudget.setLimit(bytes ? bytes : governor::defaultMemoryBudget());
+}
+
+void CryptoScanner::setCacheNeutral(bool on) {
+    activeOpt.cacheNeutral = on;
+}
+
+void CryptoScanner::setLexerOnly(bool on) {
+    activeOpt.lexerOnly = on;
+}
+
+void CryptoScanner::setExportArtifacts(bool on, const std::string& outDir) {
+    activeOpt.exportArtifacts = on;
+    activeOpt.exportDir = outDir;
+    if (!on) {
+        exporter.finish();
+        return;
+    }
+    artifact::ExportOptions eo;
+    eo.outDir = outDir;
+    eo.workers = activeOpt.exportWorkers;
+    exporter.start(eo);
+}
+
+void CryptoScanner::finishExport() {
+    exporter.finish();
+}
+
+ScanStats CryptoScanner::scanStats() const {
+    ScanStats st;
+    st.memBudgetBytes = memBudget.limit();
+    st.memReservedBytes = memBudget.current();
+    st.memReservedPeak = memBudget.peak();
+    st.pageCacheLeftBytes = cacheLeftBytes.load();
+    st.pageCacheTrackedFiles = cacheTrackedFiles.load();
+    st.astParses = astParsed.load();
+    st.astParsesSkipped = astSkipped.load();
+    st.astLexed = astLexed.load();
+    const auto trees = analyzers::TreeCache::shared().stats();
+    st.astTreesUnchanged = trees.unchanged;
+    st.astTreesIncremental = trees.incremental;
+    st.astCallsReused = trees.callsReused;
+    st.astTreeCacheBytes = trees.bytes;
+    const auto ex = exporter.stats();
+    st.artifactsExported = ex.exported;
+    st.artifactsDeduped = ex.deduped;
+    st.artifactsDisassembled = ex.disassembled;
+    {
+        std::lock_guard<std::mutex> lk(librariesMutex);
+        st.elfObjectsAnalysed = libraries.size();
+    }
+    st.libraryResultsReused = librariesReused.load();
+    return st;
+}
+
+std::vector<Detection> CryptoScanner::scanFileCacheNeutral(const std::string& filePath, std::uint64_t size) {
+    if (!activeOpt.cacheNeutral) return scanFileDetailed(filePath);
+    std::vector<Detection> dets;
+    governor::PageCacheGuard cache(filePath, true, size >= governor::kCacheNeutralMinBytes);
+    try { dets = scanFileDetailed(filePath); } catch (...) { dets.clear(); }
+    cacheLeftBytes.fetch_add(cache.finish());
+    cacheTrackedFiles.fetch_add(1);
+    return dets;
+}
+
+// Weak primitives named by a detection, looked for as tokens in its algorithm and match so that
+// "EVP_md5", "md5WithRSAEncryption" and "SHA-NI (SHA-1)" count but "describe" does not.
+static void addWeakPrimitives(const Detection& d, std::set<std::string>& out) {
+    static const std::array<std::pair<const char*, const char*>, 10> kTokens = {{
+        { "md2", "MD2" }, { "md4", "MD4" }, { "md5", "MD5" }, { "sha1", "SHA-1" }, { "sha-1", "SHA-1" },
+        { "rc2", "RC2" }, { "rc4", "RC4" }, { "arc4", "RC4" }, { "arcfour", "RC4" }, { "des", "DES" },
+    }};
+    const std::string text = toLowerStr(d.algorithm + " " + d.matchString);
+    for (const auto& t : kTokens) {
+        const std::size_t len = std::strlen(t.first);
+        for (std::size_t at = text.find(t.first); at != std::string::npos; at = text.find(t.first, at + 1)) {
+            if (at > 0 && std::isalpha((unsigned char)text[at - 1])) continue;
+            const char next = at + len < text.size() ? text[at + len] : '\0';
+            if (std::isdigit((unsigned char)next)) continue;
+            // "des" also starts words; only DES-EDE and DESX continue it with letters.
+            if (len == 3 && t.second[0] == 'D' && std::isalpha((unsigned char)next)
+                && text.compare(at, 6, "desede") != 0 && text.compare(at, 4, "desx") != 0) continue;
+            out.insert(t.second);
+            break;
+        }
+    }
+}
+
+std::shared_ptr<CryptoScanner::LibraryScan> CryptoScanner::libraryEntry(const std::string& canonicalPath) {
+    std::lock_guard<std::mutex> lk(librariesMutex);
+    auto& e = libraries[canonicalPath];
+    if (!e) e = std::make_shared<LibraryScan>();
+    return e;
+}
+
+const CryptoScanner::LibraryScan& CryptoScanner::scanLibraryOnce(const std::string& canonicalPath) {
+    auto lib = libraryEntry(canonicalPath);
+    bool ran = false;
+    std::call_once(lib->once, [&] {
+        ran = true;
+        dyn::readELFDynamic(canonicalPath, lib->dynamic);
+        const std::uint64_t sz = (std::uint64_t)getFileSizeSafe(canonicalPath);
+        if (!throttle.beforeFile(sz, cancelCb)) return;
+        std::vector<Detection> dets;
+        try { dets = scanFileCacheNeutral(canonicalPath, sz); } catch (...) { dets.clear(); }
+        std::set<std::string> weak;
+        for (const auto& d : dets) addWeakPrimitives(d, weak);
+        lib->weak.assign(weak.begin(), weak.end());
+        // Libraries outside the walk only contribute what their users inherit.
+        if (walkFiles.count(canonicalPath)) lib->pending = std::move(dets);
+    });
+    if (!ran) librariesReused.fetch_add(1);
+    return *lib;
+}
+
+std::vector<Detection> CryptoScanner::scanWithDependencies(const std::string& path, const std::string& canonicalPath,
+                                                           std::uint64_t size, const dyn::DynamicInfo& info) {
+    auto self = libraryEntry(canonicalPath);
+    std::vector<Detection> dets;
+    bool ran = false;
+    std::call_once(self->once, [&] {
+        ran = true;
+        self->dynamic = info;
+        try { dets = scanFileCacheNeutral(path, size); } catch (...) { dets.clear(); }
+        std::set<std::string> weak;
+        for (const auto& d : dets) addWeakPrimitives(d, weak);
+        self->weak.assign(weak.begin(), weak.end());
+    });
+    if (!ran) {
+        // Some binary's closure got here first; report what it found under the walk's path.
+        librariesReused.fetch_add(1);
+        std::lock_guard<std::mutex> lk(librariesMutex);
+        dets.swap(self->pending);
+        for (auto& d : dets) d.filePath = path;
+    }
+    const auto deps = libResolver->closure(canonicalPath, self->dynamic, [&](const std::string& lib) {
+        return &scanLibraryOnce(lib).dynamic;
+    });
+    for (const auto& dep : deps) {
+        std::string chain;
+        for (const auto& n : dep.via) chain += (chain.empty() ? "via " : " > ") + n;
+        for (const auto& w : scanLibraryOnce(dep.path).weak) {
+            dets.push_back({ path, 0, "Transitive weak crypto (" + w + ")", chain, "dependency", "med", "" });
+        }
+    }
+    return dets;
+}
+
+void CryptoScanner::resetLibraryGraph(const std::vector<std::string>& canonFiles) {
+    {
+        std::lock_guard<std::mutex> lk(librariesMutex);
+        libraries.clear();
+    }
+    librariesReused = 0;
+    libResolver.reset();
+    walkFiles.clear();
+    if (activeOpt.resolveLibraries) {
+        libResolver = std::make_unique<dyn::LibraryResolver>(activeOpt.libraryRoot);
+        walkFiles.insert(canonFiles.begin(), canonFiles.end());
+    }
+}
+
+std::vector<Detection> CryptoScanner::scanWalkedFile(const std::string& path, const std::string& canonicalPath, std::uint64_t size) {
+    dyn::DynamicInfo dynInfo;
+    if (libResolver && dyn::readELFDynamic(path, dynInfo)) return scanWithDependencies(path, canonicalPath, size, dynInfo);
+    return scanFileCacheNeutral(path, size);
+}
+
 static bool pathStartsWith(const std::string& s, const std::string& prefix) {
     return s.rfind(prefix, 0) == 0;
 }
@@ -838,14 +1548,28 @@ void CryptoScanner::scanPathLikeAntivirus(
 ) {
     cancelCb = isCancelled;
     activeOpt = opt;
+    if (activeOpt.exportArtifacts) {
+        artifact::ExportOptions eo;
+        eo.outDir = activeOpt.exportDir;
+        eo.workers = activeOpt.exportWorkers;
+        exporter.start(eo);
+    }
+    throttle.setBudget(activeOpt.maxBytesPerSec, activeOpt.maxFilesPerSec);
+    memBudget.setLimit(activeOpt.memoryBudgetBytes ? activeOpt.memoryBudgetBytes : governor::defaultMemoryBudget());
+    memBudget.resetPeak();
+    cacheLeftBytes = 0;
+    cacheTrackedFiles = 0;
+    astParsed = 0;
+    astSkipped = 0;
+    astLexed = 0;
     if (rootPath == "/" && activeOpt.profile == ScanProfile::Default) {
         activeOpt.profile = ScanProfile::InstitutionStrict;
         activeOpt.excludeSystemDirs = true;
         activeOpt.excludeDevDirs = true;
-        activeOpt.jarMaxEntryJava = 0;
-        activeOpt.jarMaxEntryClass = 0;
-        activeOpt.jarMaxTotalUncomp = 0;
-        activeOpt.jarMaxEntries = 0;
+        activeOpt.jarMaxEntryJava = scanprofile::kInstitutionJarLimits.maxEntryJava;
+        activeOpt.jarMaxEntryClass = scanprofile::kInstitutionJarLimits.maxEntryClass;
+        activeOpt.jarMaxTotalUncomp = scanprofile::kInstitutionJarLimits.maxTotalUncomp;
+        activeOpt.jarMaxEntries = scanprofile::kInstitutionJarLimits.maxEntries;
     }
     auto shouldSkipByProfile = [&](const fs::path& p) -> bool {
         std::string s = p.string();
@@ -875,15 +1599,19 @@ void CryptoScanner::scanPathLikeAntivirus(
         return false;
     };
     std::vector<std::string> files;
+    // Canonical path of each file, kept only when resolving libraries. The walk follows no
+    // symlinks, so a file's canonical path is its root's with the rest of the path appended.
+    std::vector<std::string> canonFiles;
+    std::string walkRoot, walkRootCanon;
     auto pushCandidate = [&](const fs::path& p) {
         std::string s = p.string();
         const std::string ext = lowercaseExt(s);
         bool isCandidate = false;
         if (isCertOrKeyExt(ext) || isLikelyPem(s)) isCandidate = true;
-        else if (ext == ".c" || ext == ".cc" || ext == ".cpp" || ext == ".cxx" || ext == ".h" || ext == ".hpp" || ext == ".hh") isCandidate = true;
+        else if (isCppSourceExt(ext)) isCandidate = true;
         else if (ext == ".py" || ext == ".java") isCandidate = true;
         else if (ext == ".class") isCandidate = true;
-        else if (isJarLikeExt(ext)) isCandidate = true;
+        else if (isJarLikeExt(ext) || container::kindForName(s) != container::Kind::None) isCandidate = activeOpt.deepJar;
         else if (isVersionedSoName(s) || ext == ".so" || ext == ".dll" || ext == ".exe" || ext == ".a" || ext == ".ld" || quickIsExecutableByHeader(s)) isCandidate = true;
         if (!isCandidate) return;
         if (!activeOpt.includeGlobs.empty()) {
@@ -892,6 +1620,7 @@ void CryptoScanner::scanPathLikeAntivirus(
         if (shouldSkipByProfile(p)) return;
         if (globMatches(s, activeOpt.excludeGlobs)) return;
         files.push_back(s);
+        if (activeOpt.resolveLibraries) canonFiles.push_back(walkRootCanon + s.substr(walkRoot.size()));
     };
     std::vector<fs::path> roots;
     if (activeOpt.profile == ScanProfile::InstitutionStrict && rootPath == "/") {
@@ -901,7 +1630,11 @@ void CryptoScanner::scanPathLikeAntivirus(
         roots.push_back(rootPath);
     }
     std::error_code ec;
+    governor::BackgroundPriorityScope enumPriority(activeOpt.lowImpact);
     auto addFromRoot = [&](const fs::path& r) {
+        walkRoot = r.string();
+        walkRootCanon = fs::weakly_canonical(r, ec).string();
+        if (ec) walkRootCanon = walkRoot;
         if (fs::is_regular_file(r, ec)) { pushCandidate(r); return; }
         if (!fs::is_directory(r, ec)) return;
         if (activeOpt.recurse) {
@@ -920,12 +1653,14 @@ void CryptoScanner::scanPathLikeAntivirus(
         } else {
             for (fs::directory_iterator it(r, ec), end; it != end; ++it) {
                 const auto& de = *it;
+                if (de.is_symlink(ec)) continue;
                 if (!de.is_regular_file(ec)) continue;
                 pushCandidate(de.path());
             }
         }
     };
     for (const auto& r : roots) addFromRoot(r);
+    resetLibraryGraph(canonFiles);
     std::uint64_t totalFiles = files.size();
     std::uint64_t totalBytes = 0;
     for (const auto& f : files) totalBytes += (std::uint64_t)getFileSizeSafe(f);
@@ -933,22 +1668,28 @@ void CryptoScanner::scanPathLikeAntivirus(
     std::atomic<std::uint64_t> bytesDone{0};
     std::mutex cbMutex;
     const unsigned int th = std::min(32u, std::max(2u, std::thread::hardware_concurrency() * 2));
-    std::atomic<std::size_t> idx{0};
+    devsched::DeviceScheduler sched;
+    sched.build(files, activeOpt.deviceLimits);
     auto worker = [&]() {
+        governor::BackgroundPriorityScope workerPriority(activeOpt.lowImpact);
         while (true) {
-            if (isCancelled && isCancelled()) break;
-            std::size_t i = idx.fetch_add(1);
-            if (i >= files.size()) break;
-            if (isCancelled && isCancelled()) break;
+            if (!governor::waitWhilePaused(activeOpt.isPaused, isCancelled)) break;
+            std::size_t i = 0, q = 0;
+            if (!sched.acquire(i, q, isCancelled)) break;
             const std::string path = files[i];
             const std::uint64_t sz = (std::uint64_t)getFileSizeSafe(path);
+            if (!throttle.beforeFile(sz, isCancelled)) { sched.release(q); break; }
             std::vector<Detection> dets;
-            try { dets = scanFileDetailed(path); } catch (...) { dets.clear(); }
+            try {
+                dets = scanWalkedFile(path, libResolver ? canonFiles[i] : std::string(), sz);
+            } catch (...) { dets.clear(); }
+            sched.release(q);
             {
                 std::lock_guard<std::mutex> lk(cbMutex);
                 for (const auto& d : dets) onDetect(d);
                 onProgress(path, filesDone.load() + 1, totalFiles, bytesDone.load() + sz, totalBytes);
             }
+            exporter.flush();
             filesDone.fetch_add(1);
             bytesDone.fetch_add(sz);
         }
@@ -956,4 +1697,5 @@ void CryptoScanner::scanPathLikeAntivirus(
     std::vector<std::thread> pool;
     for (unsigned int t = 0; t < th; t++) pool.emplace_back(worker);
     for (auto& t : pool) t.join();
+    exporter.finish();
 }
@@ -2,12 +2,26 @@
 
 #include "PatternDefinitions.h"
 #include "FileScanner.h"
+#include "ScanGovernor.h"
+#include "DeviceScheduler.h"
+#include "ASTSymbol.h"
+#include "AstRuleEngine.h"
+#include "TokenPrefilter.h"
+#include "ArtifactExporter.h"
+#include "ConstantScanner.h"
+#include "ApiNameIndex.h"
+#include "LibraryResolver.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 struct Detection {
     std::string filePath;
@@ -16,6 +30,8 @@ struct Detection {
     std::string matchString;
     std::string evidenceType;
     std::string severity;
+    std::string section;    // ELF section the evidence was found in, when known; "armap" when the
+                            // offset is into a static library's symbol table
 };
 
 enum class ScanProfile {
@@ -37,17 +53,72 @@ struct ScanOptions {
     std::vector<std::string> includeGlobs;
     std::vector<std::string> excludeGlobs;
     std::string csvSkipPath;
+    bool lowImpact = false;
+    std::uint64_t maxBytesPerSec = 0;
+    std::uint64_t maxFilesPerSec = 0;
+    std::function<bool()> isPaused;
+    std::uint64_t memoryBudgetBytes = 0;
+    bool cacheNeutral = false;
+    // Sources at or above this size (or all sources with lexerOnly) are scanned for call sites
+    // by a lexer instead of tree-sitter; 0 disables the size trigger.
+    bool lexerOnly = false;
+    std::uint64_t lexerOnlyAboveBytes = 2ull << 20;
+    // Memory for syntax trees kept between scans so an edited source is reparsed incrementally and
+    // only its changed call sites are re-evaluated; 0 parses every source from scratch.
+    std::uint64_t astTreeCacheBytes = 0;
+    // ELF .debug_* sections are left out of binary scans unless this is set.
+    bool scanDebugSections = false;
+    // Copies executables (and their disassembly) into a content-addressed store after their
+    // detections are emitted; see artifact::Exporter.
+    bool exportArtifacts = false;
+    std::string exportDir;
+    unsigned exportWorkers = 2;
+    devsched::DeviceLimits deviceLimits;
+    // ELF files found by a directory scan get their DT_NEEDED libraries resolved as ld.so
+    // would under libraryRoot ("" for this system) and inherit the weak primitives found in
+    // anything they load. Each library is analysed once per scan, however many binaries use it.
+    bool resolveLibraries = true;
+    std::string libraryRoot;
 };
 
+struct ScanStats {
+    std::uint64_t memBudgetBytes = 0;
+    std::uint64_t memReservedBytes = 0;
+    std::uint64_t memReservedPeak = 0;
+    std::uint64_t pageCacheLeftBytes = 0;
+    std::uint64_t pageCacheTrackedFiles = 0;
+    std::uint64_t astParses = 0;
+    std::uint64_t astParsesSkipped = 0;
+    std::uint64_t astLexed = 0;
+    std::uint64_t astTreesUnchanged = 0;
+    std::uint64_t astTreesIncremental = 0;
+    std::uint64_t astCallsReused = 0;
+    std::uint64_t astTreeCacheBytes = 0;
+    std::uint64_t artifactsExported = 0;
+    std::uint64_t artifactsDeduped = 0;
+    std::uint64_t artifactsDisassembled = 0;
+    std::uint64_t elfObjectsAnalysed = 0;
+    std::uint64_t libraryResultsReused = 0;
+};
+
+namespace scanprofile { struct JarLimits; }
+struct ArchiveScanState;
+namespace analyzers { class ClassRuleTable; class DotNetRuleTable; enum class SourceLang; }
+
 class CryptoScanner {
 public:
     CryptoScanner();
 
     std::vector<Detection> scanFileDetailed(const std::string& filePath);
+    std::vector<Detection> scanFileCacheNeutral(const std::string& filePath, std::uint64_t size);
     std::vector<Detection> scanPathRecursive(const std::string& rootPath);
 
     std::vector<Detection> scanClassFileDetailed(const std::string& filePath);
     std::vector<Detection> scanJarFileDetailed(const std::string& filePath);
+    std::vector<Detection> scanContainerFile(const std::string& filePath);
+    // Static libraries: API names defined per member come from the armap, and each member is
+    // scanned on its own as "lib.a::member.o", in parallel for larger archives.
+    std::vector<Detection> scanStaticArchiveFile(const std::string& filePath);
     std::vector<Detection> scanCertOrKeyFileDetailed(const std::string& filePath);
 
     std::vector<Detection> scanBinaryWholeFile(const std::string& filePath);
@@ -67,12 +138,87 @@ public:
         const std::function<bool()>& isCancelled
     );
 
+    // Settings for scanPathRecursive and the single-file scans; scanPathLikeAntivirus takes
+    // them from its ScanOptions instead.
+    void setThrottle(std::uint64_t bytesPerSec, std::uint64_t filesPerSec);
+    void setLowImpact(bool on);
+    void setPauseCheck(const std::function<bool()>& isPaused);
+    // Bytes of file and entry buffers in flight at once; 0 picks governor::defaultMemoryBudget().
+    void setMemoryBudget(std::uint64_t bytes);
+    void setCacheNeutral(bool on);
+    void setLexerOnly(bool on);
+    void setExportArtifacts(bool on, const std::string& outDir = std::string());
+    void finishExport();
+    ScanStats scanStats() const;
+
 private:
     std::vector<Detection> scanJarViaMiniZ(const std::string& filePath);
+    scanprofile::JarLimits effectiveJarLimits() const;
+
+    std::vector<Detection> scanCertOrKeyBytes(const std::string& displayPath, const std::vector<unsigned char>& buffer);
+    std::vector<Detection> scanBinaryBytes(const std::string& displayPath, const std::vector<unsigned char>& buffer, bool isBin);
+    std::vector<Detection> scanClassBytes(const std::string& displayPath, const std::vector<unsigned char>& data);
+    std::vector<Detection> scanSource(const std::string& displayPath, analyzers::SourceLang lang, std::string_view code);
+    std::vector<Detection> scanSourceFile(const std::string& filePath, analyzers::SourceLang lang);
+    std::vector<Detection> matchAstSymbols(const std::vector<AstSymbol>& syms);
+    std::vector<AstFinding> evaluateAstSymbol(const AstSymbol& s);
+    CallSiteFilter callSiteFilter(const char* lang) const;
+    struct ApiHit {
+        std::string algorithm;
+        std::string severity;
+    };
+    const std::vector<ApiHit>& importedApiHits(std::string_view fn);
+    // holding covers data/mem while it is scanned; entries of a nested archive reserve under it.
+    std::vector<Detection> scanBufferByName(const std::string& displayPath, const std::vector<unsigned char>& data, int depth, ArchiveScanState& st,
+                                            const governor::MemoryReservation* holding = nullptr);
+    std::vector<Detection> scanZipArchive(const std::string& displayPath, const std::string& filePath,
+                                          const std::vector<unsigned char>* mem, int depth, ArchiveScanState& st,
+                                          const governor::MemoryReservation* holding = nullptr);
+    std::vector<Detection> scanContainer(const std::string& displayPath, const std::string& filePath,
+                                         const std::vector<unsigned char>* mem, int depth, ArchiveScanState& st,
+                                         const governor::MemoryReservation* holding = nullptr);
+
+    // An ELF object analysed during a directory scan, by the walk or by the dependency
+    // closure of some binary, whichever reached it first.
+    struct LibraryScan {
+        std::once_flag once;
+        dyn::DynamicInfo dynamic;
+        std::vector<std::string> weak;      // weak primitives in the object's own detections
+        std::vector<Detection> pending;     // scanned for a closure, held until the walk reports them
+    };
+    std::shared_ptr<LibraryScan> libraryEntry(const std::string& canonicalPath);
+    const LibraryScan& scanLibraryOnce(const std::string& canonicalPath);
+    std::vector<Detection> scanWithDependencies(const std::string& path, const std::string& canonicalPath,
+                                                std::uint64_t size, const dyn::DynamicInfo& info);
+    // Starts a new library graph for a walk over canonFiles (a no-op graph unless resolveLibraries).
+    void resetLibraryGraph(const std::vector<std::string>& canonFiles);
+    // A file of the walk: ELF objects with dynamic sections go through scanWithDependencies.
+    std::vector<Detection> scanWalkedFile(const std::string& path, const std::string& canonicalPath, std::uint64_t size);
 
     std::vector<AlgorithmPattern> patterns;
     std::vector<AlgorithmPattern> patternsApiOnly;
+    // Literal prefixes of patternsApiOnly (plus the weak-primitive keywords as the last id), so
+    // a function name only meets the regexes that can match it.
+    analyzers::ApiNameIndex       apiNames;
+    // Literals required by the text patterns, all under id 0; a call site whose callee and
+    // identifier argument contain none of them is not extracted (see callSiteFilter).
+    analyzers::ApiNameIndex       callSiteStems;
+    analyzers::AstRuleEngine      astRules;
+    analyzers::TokenPrefilter     sourcePrefilter;
+    // Identifies the loaded regex patterns and AST rules, so cached syntax trees built under other
+    // rules are not trusted for their findings.
+    std::uint64_t                 ruleSetHash = 0;
     std::vector<BytePattern>      oidBytePatterns;
+    analyzers::ConstantScanner    constantTables;
+    std::shared_ptr<const analyzers::ClassRuleTable> classRules;
+    std::shared_ptr<const analyzers::DotNetRuleTable> dotnetRules;
+    // Imported function name -> API pattern hits; import tables repeat the same few hundred names.
+    std::mutex importHitsMutex;
+    std::unordered_map<std::string, std::vector<ApiHit>> importHits;
+    std::unique_ptr<dyn::LibraryResolver> libResolver;
+    std::unordered_set<std::string> walkFiles;      // canonical paths of the files the walk queued
+    mutable std::mutex librariesMutex;
+    std::unordered_map<std::string, std::shared_ptr<LibraryScan>> libraries;
 
     static std::string severityForTextPattern(const std::string& algName, const std::string& matched);
     static std::string severityForByteType(const std::string& type);
@@ -87,6 +233,15 @@ private:
 
     std::function<bool()> cancelCb;
     ScanOptions activeOpt;
+    governor::IoThrottle throttle;
+    governor::MemoryBudget memBudget;
+    artifact::Exporter exporter;
+    std::atomic<std::uint64_t> cacheLeftBytes{0};
+    std::atomic<std::uint64_t> cacheTrackedFiles{0};
+    std::atomic<std::uint64_t> astParsed{0};
+    std::atomic<std::uint64_t> astSkipped{0};
+    std::atomic<std::uint64_t> astLexed{0};
+    std::atomic<std::uint64_t> librariesReused{0};
 };
 
 namespace scanprofile {
@@ -24,6 +24,22 @@ SOURCES += \
     PythonASTScanner.cpp \
     CppASTScanner.cpp \
     DynLinkParser.cpp \
+    ScanGovernor.cpp \
+    DeviceScheduler.cpp \
+    ContainerReader.cpp \
+    ParserPool.cpp \
+    AstRuleEngine.cpp \
+    TokenPrefilter.cpp \
+    LexerScanner.cpp \
+    TreeCache.cpp \
+    ArtifactExporter.cpp \
+    ConstantScanner.cpp \
+    InsnScanner.cpp \
+    PEImage.cpp \
+    ApiNameIndex.cpp \
+    LibraryResolver.cpp \
+    DotNetMetadata.cpp \
+    GoBinaryScanner.cpp \
     third_party/miniz/miniz.c \
     third_party/miniz/miniz_zip.c \
     third_party/miniz/miniz_tinfl.c \
@@ -44,7 +60,23 @@ HEADERS += \
     PythonASTScanner.h \
     CppASTScanner.h \
     ASTSymbol.h \
-    DynLinkParser.h
+    DynLinkParser.h \
+    ScanGovernor.h \
+    DeviceScheduler.h \
+    ContainerReader.h \
+    ParserPool.h \
+    AstRuleEngine.h \
+    TokenPrefilter.h \
+    LexerScanner.h \
+    TreeCache.h \
+    ArtifactExporter.h \
+    ConstantScanner.h \
+    InsnScanner.h \
+    PEImage.h \
+    ApiNameIndex.h \
+    LibraryResolver.h \
+    DotNetMetadata.h \
+    GoBinaryScanner.h
 
 QMAKE_CFLAGS   += -w -D_FILE_OFFSET_BITS=64 -D_LARGEFILE64_SOURCE -fPIC
 QMAKE_CXXFLAGS += -w -fno-diagnostics-show-caret -fno-diagnostics-color -fno-diagnostics-show-option \
@@ -34,6 +34,22 @@ SOURCES += \
     PythonASTScanner.cpp \
     CppASTScanner.cpp \
     DynLinkParser.cpp \
+    ScanGovernor.cpp \
+    DeviceScheduler.cpp \
+    ContainerReader.cpp \
+    ParserPool.cpp \
+    AstRuleEngine.cpp \
+    TokenPrefilter.cpp \
+    LexerScanner.cpp \
+    TreeCache.cpp \
+    ArtifactExporter.cpp \
+    ConstantScanner.cpp \
+    InsnScanner.cpp \
+    PEImage.cpp \
+    ApiNameIndex.cpp \
+    LibraryResolver.cpp \
+    DotNetMetadata.cpp \
+    GoBinaryScanner.cpp \
     third_party/miniz/miniz.c \
     third_party/miniz/miniz_zip.c \
     third_party/miniz/miniz_tinfl.c \
@@ -49,4 +65,20 @@ HEADERS += \
     JavaASTScanner.h \
     PythonASTScanner.h \
     CppASTScanner.h \
-    DynLinkParser.h
+    DynLinkParser.h \
+    ScanGovernor.h \
+    DeviceScheduler.h \
+    ContainerReader.h \
+    ParserPool.h \
+    AstRuleEngine.h \
+    TokenPrefilter.h \
+    LexerScanner.h \
+    TreeCache.h \
+    ArtifactExporter.h \
+    ConstantScanner.h \
+    InsnScanner.h \
+    PEImage.h \
+    ApiNameIndex.h \
+    LibraryResolver.h \
+    DotNetMetadata.h \
+    GoBinaryScanner.h
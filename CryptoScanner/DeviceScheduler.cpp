@@ -0,0 +1,168 @@
+#include "DeviceScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/statfs.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif
+
+namespace devsched {
+
+namespace {
+
+struct FileKey {
+    std::uint64_t dev = 0;
+    std::uint64_t ino = 0;
+    std::uint64_t phys = 0;
+};
+
+#if defined(__linux__)
+constexpr long kNfsMagic   = 0x6969;
+constexpr long kSmbMagic   = 0x517B;
+constexpr long kCifsMagic  = (long)0xFF534D42;
+constexpr long kSmb2Magic  = (long)0xFE534D42;
+constexpr long kFuseMagic  = 0x65735546;
+constexpr long kCephMagic  = 0x00C36400;
+constexpr long kAfsMagic   = 0x5346414F;
+
+static bool isNetworkFs(const std::string& path){
+    struct statfs sf{};
+    if(statfs(path.c_str(), &sf) != 0) return false;
+    long t = (long)sf.f_type;
+    return t == kNfsMagic || t == kSmbMagic || t == kCifsMagic || t == kSmb2Magic || t == kFuseMagic || t == kCephMagic || t == kAfsMagic;
+}
+
+static int readRotational(const std::filesystem::path& dir){
+    std::ifstream in(dir / "queue" / "rotational");
+    int v = -1;
+    if(in >> v) return v;
+    return -1;
+}
+
+static std::uint64_t firstPhysicalExtent(const std::string& path){
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return 0;
+    alignas(struct fiemap) unsigned char buf[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+    auto* fm = reinterpret_cast<struct fiemap*>(buf);
+    fm->fm_start = 0;
+    fm->fm_length = ~0ull;
+    fm->fm_extent_count = 1;
+    std::uint64_t phys = 0;
+    if(ioctl(fd, FS_IOC_FIEMAP, fm) == 0 && fm->fm_mapped_extents > 0) phys = fm->fm_extents[0].fe_physical;
+    ::close(fd);
+    return phys;
+}
+#endif
+
+}
+
+const char* deviceKindName(DeviceKind k){
+    switch(k){
+        case DeviceKind::SolidState: return "ssd";
+        case DeviceKind::Rotational: return "hdd";
+        case DeviceKind::Network:    return "network";
+        default:                     return "unknown";
+    }
+}
+
+DeviceKind classifyDevice(std::uint64_t dev, const std::string& samplePath){
+#if defined(__linux__)
+    if(!samplePath.empty() && isNetworkFs(samplePath)) return DeviceKind::Network;
+    unsigned maj = major((dev_t)dev), min = minor((dev_t)dev);
+    if(maj == 0) return DeviceKind::Unknown;
+    std::error_code ec;
+    std::filesystem::path sys = std::filesystem::canonical("/sys/dev/block/" + std::to_string(maj) + ":" + std::to_string(min), ec);
+    if(ec) return DeviceKind::Unknown;
+    int rot = readRotational(sys);
+    if(rot < 0) rot = readRotational(sys.parent_path());
+    if(rot == 1) return DeviceKind::Rotational;
+    if(rot == 0) return DeviceKind::SolidState;
+#else
+    (void)dev; (void)samplePath;
+#endif
+    return DeviceKind::Unknown;
+}
+
+void DeviceScheduler::build(const std::vector<std::string>& files, const DeviceLimits& limits){
+    std::lock_guard<std::mutex> lk(m);
+    queues.clear();
+    cursor = 0;
+    std::vector<FileKey> keys(files.size());
+    std::unordered_map<std::uint64_t, std::size_t> byDev;
+    for(std::size_t i = 0; i < files.size(); ++i){
+#if !defined(_WIN32)
+        struct stat st{};
+        if(::stat(files[i].c_str(), &st) == 0){
+            keys[i].dev = (std::uint64_t)st.st_dev;
+            keys[i].ino = (std::uint64_t)st.st_ino;
+        }
+#endif
+        auto it = byDev.find(keys[i].dev);
+        if(it == byDev.end()){
+            Queue q;
+            q.dev = keys[i].dev;
+            q.kind = classifyDevice(q.dev, files[i]);
+            switch(q.kind){
+                case DeviceKind::Rotational: q.limit = limits.rotational; break;
+                case DeviceKind::Network:    q.limit = limits.network; break;
+                default:                     q.limit = limits.solidState; break;
+            }
+            it = byDev.emplace(q.dev, queues.size()).first;
+            queues.push_back(std::move(q));
+        }
+        queues[it->second].order.push_back(i);
+    }
+    for(auto& q : queues){
+        if(q.kind != DeviceKind::Rotational) continue;
+#if defined(__linux__)
+        for(std::size_t i : q.order) keys[i].phys = firstPhysicalExtent(files[i]);
+#endif
+        std::stable_sort(q.order.begin(), q.order.end(), [&](std::size_t a, std::size_t b){
+            if(keys[a].phys != keys[b].phys) return keys[a].phys < keys[b].phys;
+            return keys[a].ino < keys[b].ino;
+        });
+    }
+}
+
+bool DeviceScheduler::acquire(std::size_t& fileIndex, std::size_t& queue, const std::function<bool()>& abort){
+    std::unique_lock<std::mutex> lk(m);
+    for(;;){
+        bool pending = false;
+        for(std::size_t k = 0; k < queues.size(); ++k){
+            std::size_t qi = (cursor + k) % queues.size();
+            Queue& q = queues[qi];
+            if(q.next >= q.order.size()) continue;
+            pending = true;
+            if(q.limit && q.active >= q.limit) continue;
+            fileIndex = q.order[q.next++];
+            q.active++;
+            queue = qi;
+            cursor = qi + 1;
+            return true;
+        }
+        if(!pending) return false;
+        if(abort && abort()) return false;
+        cv.wait_for(lk, std::chrono::milliseconds(50));
+    }
+}
+
+void DeviceScheduler::release(std::size_t queue){
+    std::lock_guard<std::mutex> lk(m);
+    if(queue < queues.size() && queues[queue].active > 0) queues[queue].active--;
+    cv.notify_all();
+}
+
+}
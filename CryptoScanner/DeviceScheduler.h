@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace devsched {
+
+enum class DeviceKind { Unknown, SolidState, Rotational, Network };
+
+struct DeviceLimits {
+    unsigned rotational = 2;
+    unsigned network = 4;
+    unsigned solidState = 0;
+};
+
+DeviceKind classifyDevice(std::uint64_t dev, const std::string& samplePath);
+const char* deviceKindName(DeviceKind k);
+
+class DeviceScheduler {
+public:
+    // Groups files by st_dev. Rotational queues are sorted by physical extent (FIEMAP) when
+    // available and by inode otherwise; other queues keep enumeration order.
+    void build(const std::vector<std::string>& files, const DeviceLimits& limits);
+
+    // Picks the next file round-robin from a device with a free slot; blocks while every
+    // device with pending work is saturated. Returns false when drained or abort() fired.
+    bool acquire(std::size_t& fileIndex, std::size_t& queue, const std::function<bool()>& abort);
+    void release(std::size_t queue);
+
+    std::size_t deviceCount() const { return queues.size(); }
+    std::uint64_t deviceId(std::size_t q) const { return queues[q].dev; }
+    DeviceKind deviceKind(std::size_t q) const { return queues[q].kind; }
+    std::size_t deviceFiles(std::size_t q) const { return queues[q].order.size(); }
+
+private:
+    struct Queue {
+        std::uint64_t dev = 0;
+        DeviceKind kind = DeviceKind::Unknown;
+        unsigned limit = 0;
+        unsigned active = 0;
+        std::size_t next = 0;
+        std::vector<std::size_t> order;
+    };
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<Queue> queues;
+    std::size_t cursor = 0;
+};
+
+}
@@ -0,0 +1,327 @@
+#include "DotNetMetadata.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <string>
+
+namespace analyzers {
+
+namespace {
+
+uint16_t rd16(const unsigned char* p){ return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t rd32(const unsigned char* p){ return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+const uint32_t kMetadataMagic = 0x424A5342;     // "BSJB"
+const size_t kMaxVersionLength = 255;
+const size_t kMaxNameLength = 1024;
+const size_t kMaxLiteral = 512;
+const int kMaxNesting = 16;
+
+// Table numbers from ECMA-335 II.22; tables stay in number order in the #~ stream, so everything
+// before MemberRef needs a row size.
+enum Table {
+    kModule = 0x00, kTypeRef = 0x01, kTypeDef = 0x02, kFieldPtr = 0x03, kField = 0x04, kMethodPtr = 0x05,
+    kMethodDef = 0x06, kParamPtr = 0x07, kParam = 0x08, kInterfaceImpl = 0x09, kMemberRef = 0x0A,
+    kModuleRef = 0x1A, kTypeSpec = 0x1B, kAssemblyRef = 0x23
+};
+
+struct Stream {
+    size_t off = 0;     // file offset
+    size_t size = 0;
+};
+
+class Metadata {
+public:
+    bool parse(const unsigned char* data, size_t n, size_t root, size_t rootSize){
+        p = data;
+        if(root >= n || rootSize < 20 || rootSize > n - root || rd32(p + root) != kMetadataMagic) return false;
+        const size_t end = root + rootSize;
+        const uint32_t verLen = rd32(p + root + 12);
+        if(verLen > kMaxVersionLength) return false;
+        size_t pos = root + 16 + ((verLen + 3) & ~3u);
+        if(pos + 4 > end) return false;
+        const uint16_t count = rd16(p + pos + 2);
+        pos += 4;
+        bool haveTables = false;
+        for(uint16_t i = 0; i < count; ++i){
+            if(pos + 8 > end) return false;
+            Stream s{ root + rd32(p + pos), rd32(p + pos + 4) };
+            const void* z = std::memchr(p + pos + 8, 0, std::min<size_t>(32, end - pos - 8));
+            if(!z) return false;
+            const std::string_view name((const char*)p + pos + 8, (size_t)((const unsigned char*)z - (p + pos + 8)));
+            pos += 8 + ((name.size() + 4) & ~(size_t)3);
+            if(s.off > end || s.size > end - s.off) continue;
+            if(name == "#~" || name == "#-"){ tables = s; haveTables = true; }
+            else if(name == "#Strings") strings = s;
+            else if(name == "#US") userStrings = s;
+        }
+        return haveTables && parseTables();
+    }
+
+    std::string_view string(uint32_t idx) const {
+        if(idx >= strings.size) return {};
+        const size_t lim = std::min(strings.size - idx, kMaxNameLength);
+        const void* z = std::memchr(p + strings.off + idx, 0, lim);
+        if(!z) return {};
+        return std::string_view((const char*)p + strings.off + idx, (size_t)((const unsigned char*)z - (p + strings.off + idx)));
+    }
+
+    uint32_t rows(int t) const { return rowCount[t]; }
+    size_t row(int t, uint32_t i) const { return tableOff[t] + (size_t)(i - 1) * rowSize[t]; }     // 1-based, as in tokens
+
+    // Reads one column and advances `pos`.
+    uint32_t column(size_t& pos, int width) const {
+        const uint32_t v = width == 2 ? rd16(p + pos) : rd32(p + pos);
+        pos += width;
+        return v;
+    }
+
+    int stringWidth() const { return strWidth; }
+    int resolutionScopeWidth() const { return coded({ kModule, kModuleRef, kAssemblyRef, kTypeRef }, 2); }
+    int memberRefParentWidth() const { return coded({ kTypeDef, kTypeRef, kModuleRef, kMethodDef, kTypeSpec }, 3); }
+
+    const Stream& userStringHeap() const { return userStrings; }
+
+private:
+    bool parseTables(){
+        if(tables.size < 24) return false;
+        const unsigned char* t = p + tables.off;
+        const uint8_t heaps = t[6];
+        strWidth = (heaps & 0x01) ? 4 : 2;
+        guidWidth = (heaps & 0x02) ? 4 : 2;
+        blbWidth = (heaps & 0x04) ? 4 : 2;
+        const uint64_t valid = (uint64_t)rd32(t + 8) | ((uint64_t)rd32(t + 12) << 32);
+        size_t pos = 24;
+        for(int i = 0; i < 64; ++i){
+            if(!(valid >> i & 1)) continue;
+            if(pos + 4 > tables.size) return false;
+            rowCount[i] = rd32(t + pos);
+            pos += 4;
+        }
+        // Uncompressed (#-) streams written during edit-and-continue carry four extra bytes here.
+        if(heaps & 0x40) pos += 4;
+
+        const int field = simple(kField), method = simple(kMethodDef), param = simple(kParam);
+        const int typeDefOrRef = coded({ kTypeDef, kTypeRef, kTypeSpec }, 2);
+        rowSize[kModule] = 2 + strWidth + 3 * guidWidth;
+        rowSize[kTypeRef] = resolutionScopeWidth() + 2 * strWidth;
+        rowSize[kTypeDef] = 4 + 2 * strWidth + typeDefOrRef + field + method;
+        rowSize[kFieldPtr] = field;
+        rowSize[kField] = 2 + strWidth + blbWidth;
+        rowSize[kMethodPtr] = method;
+        rowSize[kMethodDef] = 8 + strWidth + blbWidth + param;
+        rowSize[kParamPtr] = param;
+        rowSize[kParam] = 4 + strWidth;
+        rowSize[kInterfaceImpl] = simple(kTypeDef) + typeDefOrRef;
+        rowSize[kMemberRef] = memberRefParentWidth() + strWidth + blbWidth;
+
+        uint64_t off = pos;
+        for(int i = 0; i <= kMemberRef; ++i){
+            tableOff[i] = tables.off + (size_t)off;
+            off += (uint64_t)rowCount[i] * rowSize[i];
+            if(off > tables.size) return false;
+        }
+        return true;
+    }
+
+    int simple(int t) const { return rowCount[t] < 0x10000 ? 2 : 4; }
+
+    int coded(std::initializer_list<int> tags, int bits) const {
+        uint32_t most = 0;
+        for(int t : tags) most = std::max(most, rowCount[t]);
+        return most < (1u << (16 - bits)) ? 2 : 4;
+    }
+
+    const unsigned char* p = nullptr;
+    Stream tables, strings, userStrings;
+    int strWidth = 2, guidWidth = 2, blbWidth = 2;
+    uint32_t rowCount[64] = {};
+    size_t rowSize[kMemberRef + 1] = {};
+    size_t tableOff[kMemberRef + 1] = {};
+};
+
+// "Namespace.Name" of every TypeRef row; nested types are "Outer+Inner" as reflection prints them.
+std::vector<std::string> typeRefNames(const Metadata& md){
+    const uint32_t n = md.rows(kTypeRef);
+    std::vector<std::string> names(n + 1);
+    std::vector<uint32_t> outer(n + 1, 0);
+    const int scopeWidth = md.resolutionScopeWidth(), sw = md.stringWidth();
+    for(uint32_t i = 1; i <= n; ++i){
+        size_t pos = md.row(kTypeRef, i);
+        const uint32_t scope = md.column(pos, scopeWidth);
+        const std::string_view name = md.string(md.column(pos, sw));
+        const std::string_view ns = md.string(md.column(pos, sw));
+        if((scope & 3) == 3) outer[i] = scope >> 2;
+        names[i] = ns.empty() ? std::string(name) : std::string(ns) + "." + std::string(name);
+    }
+    std::vector<std::string> full(names);
+    for(uint32_t i = 1; i <= n; ++i){
+        uint32_t o = outer[i];
+        for(int depth = 0; o && o <= n && o != i && depth < kMaxNesting; ++depth){
+            full[i] = names[o] + "+" + full[i];
+            o = outer[o];
+        }
+    }
+    return full;
+}
+
+std::string upper(std::string_view s){
+    std::string r(s);
+    for(auto& c : r) c = (char)std::toupper((unsigned char)c);
+    return r;
+}
+
+// UTF-16LE to UTF-8; unpaired surrogates become U+FFFD.
+std::string fromUtf16(const unsigned char* p, size_t units){
+    std::string out;
+    out.reserve(units);
+    auto put = [&](uint32_t cp){
+        if(cp < 0x80) out.push_back((char)cp);
+        else if(cp < 0x800){ out.push_back((char)(0xC0 | (cp >> 6))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+        else if(cp < 0x10000){ out.push_back((char)(0xE0 | (cp >> 12))); out.push_back((char)(0x80 | ((cp >> 6) & 0x3F))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+        else { out.push_back((char)(0xF0 | (cp >> 18))); out.push_back((char)(0x80 | ((cp >> 12) & 0x3F))); out.push_back((char)(0x80 | ((cp >> 6) & 0x3F))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+    };
+    for(size_t i = 0; i < units; ++i){
+        const uint16_t u = rd16(p + i * 2);
+        if(u >= 0xD800 && u <= 0xDBFF && i + 1 < units){
+            const uint16_t lo = rd16(p + i * 2 + 2);
+            if(lo >= 0xDC00 && lo <= 0xDFFF){
+                put(0x10000 + ((uint32_t)(u - 0xD800) << 10) + (uint32_t)(lo - 0xDC00));
+                ++i;
+                continue;
+            }
+        }
+        put((u >= 0xD800 && u <= 0xDFFF) ? 0xFFFD : u);
+    }
+    return out;
+}
+
+const char* const kMed = "med";
+const char* const kLow = "low";
+
+}
+
+std::shared_ptr<const DotNetRuleTable> DotNetRuleTable::build(){
+    auto t = std::make_shared<DotNetRuleTable>();
+    auto type = [&](std::initializer_list<const char*> names, const char* alg, const char* sev){
+        for(auto n : names) t->types[std::string("System.Security.Cryptography.") + n] = ClassRule{ alg, sev, "metadata" };
+    };
+    type({"MD5", "MD5CryptoServiceProvider", "MD5Cng", "HMACMD5"}, "MD5", kMed);
+    type({"SHA1", "SHA1Managed", "SHA1CryptoServiceProvider", "SHA1Cng", "HMACSHA1"}, "SHA", kMed);
+    type({"SHA256", "SHA256Managed", "SHA256CryptoServiceProvider", "SHA256Cng", "SHA384", "SHA384Managed", "SHA384CryptoServiceProvider",
+          "SHA384Cng", "SHA512", "SHA512Managed", "SHA512CryptoServiceProvider", "SHA512Cng", "HMACSHA256", "HMACSHA384", "HMACSHA512"}, "SHA", kLow);
+    type({"DES", "DESCryptoServiceProvider", "TripleDES", "TripleDESCryptoServiceProvider", "TripleDESCng"}, "3DES", kMed);
+    type({"RC2", "RC2CryptoServiceProvider"}, "RC2", kMed);
+    type({"RSA", "RSACryptoServiceProvider", "RSACng", "RSAOpenSsl", "RSAParameters", "RSAEncryptionPadding", "RSASignaturePadding",
+          "RSAPKCS1SignatureFormatter", "RSAPKCS1SignatureDeformatter", "RSAOAEPKeyExchangeFormatter"}, "RSA", kLow);
+    type({"RSAPKCS1KeyExchangeFormatter", "RSAPKCS1KeyExchangeDeformatter"}, "RSA", kMed);
+    type({"DSA", "DSACryptoServiceProvider", "DSACng", "DSAOpenSsl", "DSAParameters", "DSASignatureFormatter"}, "DSA", kLow);
+    type({"ECDsa", "ECDsaCng", "ECDsaOpenSsl", "ECDiffieHellman", "ECDiffieHellmanCng", "ECDiffieHellmanOpenSsl", "ECCurve",
+          "ECParameters"}, "ECC/ECDSA/ECDH", kLow);
+    type({"Aes", "AesManaged", "AesCryptoServiceProvider", "AesCng", "AesGcm", "AesCcm", "Rijndael", "RijndaelManaged"}, "AES-128/modes", kLow);
+    type({"PasswordDeriveBytes"}, "PBKDF1", kMed);
+    type({"Rfc2898DeriveBytes"}, "PBKDF2", kLow);
+    type({"ChaCha20Poly1305"}, "ChaCha20-Poly1305", kLow);
+
+    auto member = [&](std::initializer_list<const char*> names, const char* alg, const char* sev){
+        for(auto n : names) t->members[std::string("System.Security.Cryptography.") + n] = ClassRule{ alg, sev, "metadata" };
+    };
+    // Algorithm-neutral APIs (IncrementalHash, RSA.SignData, Rfc2898DeriveBytes) take the hash as a
+    // HashAlgorithmName property.
+    member({"HashAlgorithmName::get_MD5"}, "MD5", kMed);
+    member({"HashAlgorithmName::get_SHA1"}, "SHA", kMed);
+    member({"HashAlgorithmName::get_SHA256", "HashAlgorithmName::get_SHA384", "HashAlgorithmName::get_SHA512"}, "SHA", kLow);
+    member({"RSAEncryptionPadding::get_Pkcs1", "RSASignaturePadding::get_Pkcs1"}, "RSA PKCS#1 v1.5", kMed);
+    member({"RSACryptoServiceProvider::Encrypt", "RSACryptoServiceProvider::Decrypt"}, "RSA PKCS#1 v1.5", kLow);
+    member({"PasswordDeriveBytes::CryptDeriveKey"}, "PBKDF1", kMed);
+    member({"CryptoConfig::CreateFromName", "HashAlgorithm::Create", "SymmetricAlgorithm::Create", "AsymmetricAlgorithm::Create",
+            "KeyedHashAlgorithm::Create", "HMAC::Create"}, "Crypto algorithm by name", kLow);
+    member({"SymmetricAlgorithm::set_Mode"}, "AES-128/modes", kLow);
+    return t;
+}
+
+const ClassRule* DotNetRuleTable::type(std::string_view fullName) const {
+    auto it = types.find(std::string(fullName));
+    return it == types.end() ? nullptr : &it->second;
+}
+
+const ClassRule* DotNetRuleTable::member(std::string_view qualifiedName) const {
+    auto it = members.find(std::string(qualifiedName));
+    return it == members.end() ? nullptr : &it->second;
+}
+
+bool DotNetMetadataScanner::metadataRange(const dyn::PEImage& pe, const std::vector<unsigned char>& buf, size_t& from, size_t& to){
+    dyn::PEClrHeader clr;
+    if(!pe.clrHeader(clr) || clr.metadataOffset == dyn::PEImage::npos) return false;
+    if(clr.metadataOffset + 4 > buf.size() || rd32(buf.data() + clr.metadataOffset) != kMetadataMagic) return false;
+    from = clr.metadataOffset;
+    to = clr.metadataOffset + clr.metadataSize;
+    return true;
+}
+
+std::vector<Detection> DotNetMetadataScanner::scan(const std::string& displayName,
+                                                   const std::vector<unsigned char>& buf,
+                                                   const dyn::PEImage& pe,
+                                                   const DotNetRuleTable& rules,
+                                                   const ClassRuleTable& literals)
+{
+    std::vector<Detection> out;
+    size_t from = 0, to = 0;
+    Metadata md;
+    if(!metadataRange(pe, buf, from, to) || !md.parse(buf.data(), buf.size(), from, to - from)) return out;
+
+    std::set<std::pair<std::string, std::string>> seen;
+    auto emit = [&](size_t off, const ClassRule& r, const std::string& match, const char* stream){
+        if(!seen.insert({ r.algorithm, match }).second) return;
+        out.push_back({ displayName, off, r.algorithm, match, "metadata", r.severity, stream });
+    };
+
+    const std::vector<std::string> types = typeRefNames(md);
+    for(uint32_t i = 1; i < types.size(); ++i){
+        if(const ClassRule* r = rules.type(types[i])) emit(md.row(kTypeRef, i), *r, types[i], "#~");
+    }
+    const int parentWidth = md.memberRefParentWidth(), sw = md.stringWidth();
+    for(uint32_t i = 1; i <= md.rows(kMemberRef); ++i){
+        size_t pos = md.row(kMemberRef, i);
+        const uint32_t parent = md.column(pos, parentWidth);
+        // Members of generic instantiations (TypeSpec) and of this assembly's own types are not
+        // framework APIs.
+        if((parent & 7) != 1 || (parent >> 3) == 0 || (parent >> 3) >= types.size()) continue;
+        const std::string qualified = types[parent >> 3] + "::" + std::string(md.string(md.column(pos, sw)));
+        if(const ClassRule* r = rules.member(qualified)) emit(md.row(kMemberRef, i), *r, qualified, "#~");
+    }
+
+    // #US entries are length-prefixed (ECMA-335 II.24.2.4): UTF-16LE code units plus one flag byte.
+    const Stream& us = md.userStringHeap();
+    const unsigned char* h = buf.data() + us.off;
+    std::vector<std::string_view> toks;
+    for(size_t pos = 1; pos < us.size; ){
+        size_t len = 0, hdr = 0;
+        const unsigned char b = h[pos];
+        if(!(b & 0x80)){ len = b; hdr = 1; }
+        else if((b & 0xC0) == 0x80 && pos + 2 <= us.size){ len = ((size_t)(b & 0x3F) << 8) | h[pos + 1]; hdr = 2; }
+        else if((b & 0xE0) == 0xC0 && pos + 4 <= us.size){ len = ((size_t)(b & 0x1F) << 24) | ((size_t)h[pos + 1] << 16) | ((size_t)h[pos + 2] << 8) | h[pos + 3]; hdr = 4; }
+        else break;
+        if(len > us.size - pos - hdr) break;
+        const size_t units = len / 2, off = us.off + pos + hdr;
+        pos += hdr + len;
+        if(units == 0 || units > kMaxLiteral) continue;
+        const std::string text = fromUtf16(buf.data() + off, units);
+        if(ClassRuleTable::looksLikeDottedOid(text)){
+            if(const ClassRule* r = literals.oid(text)) emit(off, *r, text, "#US");
+            continue;
+        }
+        const std::string up = upper(text);
+        ClassRuleTable::literalTokens(up, toks);
+        for(const auto& t : toks){
+            if(const ClassRule* r = literals.token(t)) emit(off, *r, std::string(t), "#US");
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Detection& a, const Detection& b){ return a.offset < b.offset; });
+    return out;
+}
+
+} // namespace analyzers
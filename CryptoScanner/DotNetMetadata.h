@@ -0,0 +1,44 @@
+#pragma once
+
+#include "JavaBytecodeScanner.h"
+#include "PEImage.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace analyzers {
+
+// Fully qualified .NET type names ("System.Security.Cryptography.MD5") and members on them
+// ("System.Security.Cryptography.RSACryptoServiceProvider::Encrypt"), hashed for exact lookup.
+class DotNetRuleTable {
+public:
+    static std::shared_ptr<const DotNetRuleTable> build();
+
+    const ClassRule* type(std::string_view fullName) const;
+    const ClassRule* member(std::string_view qualifiedName) const;
+
+private:
+    std::unordered_map<std::string, ClassRule> types;
+    std::unordered_map<std::string, ClassRule> members;
+};
+
+// ECMA-335 metadata of a managed PE image, reached through the CLR header. Only TypeRef and
+// MemberRef rows are matched, so the result is what the assembly actually calls, not every name
+// in #Strings; algorithm-name literals come from the #US heap, which holds exactly the strings
+// `ldstr` loads.
+class DotNetMetadataScanner {
+public:
+    // File range of the metadata, false when the image has no CLR header or the root is not "BSJB".
+    static bool metadataRange(const dyn::PEImage& pe, const std::vector<unsigned char>& buf, size_t& from, size_t& to);
+
+    static std::vector<Detection> scan(const std::string& displayName,
+                                       const std::vector<unsigned char>& buf,
+                                       const dyn::PEImage& pe,
+                                       const DotNetRuleTable& rules,
+                                       const ClassRuleTable& literals);
+};
+
+} // namespace analyzers
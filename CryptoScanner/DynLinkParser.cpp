@@ -1,5 +1,9 @@
 #include "DynLinkParser.h"
+#include "PEImage.h"
+#include <algorithm>
 #include <cstring>
+#include <fstream>
+#include <string>
 
 namespace dyn {
 
@@ -35,6 +39,7 @@ struct Phdr64 { uint32_t p_type; uint32_t p_flags; uint64_t p_offset; uint64_t p
 struct Phdr32 { uint32_t p_type; uint32_t p_offset; uint32_t p_vaddr; uint32_t p_paddr; uint32_t p_filesz; uint32_t p_memsz; uint32_t p_flags; uint32_t p_align; };
 
 static size_t vaddr_to_off_64(const std::vector<unsigned char>& b, bool be, uint64_t va, uint64_t phoff, uint16_t phentsize, uint16_t phnum){
+    if(phoff > b.size()) return (size_t)0;
     for(uint16_t i=0;i<phnum;i++){
         size_t off = (size_t)phoff + (size_t)i * phentsize;
         if(off + sizeof(Phdr64) > b.size()) break;
@@ -104,201 +109,518 @@ static size_t vaddr_to_off_32(const std::vector<unsigned char>& b, bool be, uint
     return (size_t)0;
 }
 
+static const size_t kMaxDynamicBytes = 1u << 20;
+
+// `at(off, n, dst)` copies n bytes at file offset off into dst and fails if they are not all
+// there, so the same walk serves a loaded buffer and a file read piecewise. `fileSize` bounds
+// the program header table before it is allocated.
+template <class ReadAt>
+static bool readDynamic(const ReadAt& at, uint64_t fileSize, DynamicInfo& out){
+    unsigned char eh[64];
+    if(!at(0, 52, eh) || eh[0]!=0x7F || eh[1]!='E' || eh[2]!='L' || eh[3]!='F') return false;
+    const bool is64 = eh[4] == 2;
+    if(eh[4] != 1 && !is64) return false;
+    if(is64 && !at(0, 64, eh)) return false;
+    const bool be = eh[5] == 2;
+    auto u16 = [be](const unsigned char* p){ return be ? r16be(p) : r16le(p); };
+    auto u32 = [be](const unsigned char* p){ return be ? r32be(p) : r32le(p); };
+    auto word = [be, is64](const unsigned char* p) -> uint64_t { return is64 ? (be ? r64be(p) : r64le(p)) : (be ? r32be(p) : r32le(p)); };
+    out = DynamicInfo();
+    out.elfClass = eh[4];
+    out.bigEndian = be;
+    out.machine = u16(eh + 18);
+
+    const uint64_t phoff = word(eh + (is64 ? 0x20 : 0x1C));
+    const uint16_t phentsize = u16(eh + (is64 ? 0x36 : 0x2A));
+    const uint16_t phnum = u16(eh + (is64 ? 0x38 : 0x2C));
+    if(phnum == 0 || phentsize < (is64 ? 56 : 32)) return true;
+    if(phoff > fileSize || (uint64_t)phentsize * phnum > fileSize - phoff) return true;
+    std::vector<unsigned char> ph((size_t)phentsize * phnum);
+    if(!at(phoff, ph.size(), ph.data())) return true;
+    struct Load { uint64_t vaddr, offset, filesz; };
+    std::vector<Load> loads;
+    uint64_t dynOff = 0, dynSize = 0;
+    for(uint16_t i=0;i<phnum;i++){
+        const unsigned char* e = ph.data() + (size_t)i * phentsize;
+        const uint32_t type = u32(e);
+        const uint64_t off = is64 ? word(e+8) : word(e+4);
+        const uint64_t vaddr = is64 ? word(e+16) : word(e+8);
+        const uint64_t filesz = is64 ? word(e+32) : word(e+16);
+        if(type == 1) loads.push_back({ vaddr, off, filesz });
+        else if(type == 2){ dynOff = off; dynSize = filesz; }
+    }
+    if(dynSize == 0) return true;
+    std::vector<unsigned char> dyn((size_t)std::min<uint64_t>(dynSize, kMaxDynamicBytes));
+    if(!at(dynOff, dyn.size(), dyn.data())) return true;
+
+    const size_t ent = is64 ? 16 : 8;
+    uint64_t strtab = 0, strsz = 0;
+    bool hasRunpath = false;
+    std::vector<std::pair<uint64_t, uint64_t>> refs;    // (d_tag, string table offset)
+    for(size_t i=0;i+ent<=dyn.size();i+=ent){
+        const uint64_t tag = word(dyn.data()+i), val = word(dyn.data()+i+ent/2);
+        if(tag == 0) break;
+        if(tag == 5) strtab = val;
+        else if(tag == 10) strsz = val;
+        else if(tag == 1 || tag == 14 || tag == 15 || tag == 29) refs.emplace_back(tag, val);
+        if(tag == 29) hasRunpath = true;
+    }
+    const Load* seg = nullptr;
+    for(const auto& l : loads){
+        if(strtab >= l.vaddr && strtab - l.vaddr < l.filesz){ seg = &l; break; }
+    }
+    if(!seg) return true;
+    const uint64_t avail = seg->filesz - (strtab - seg->vaddr);
+    if(strsz == 0 || strsz > avail) strsz = avail;
+    std::vector<unsigned char> str((size_t)std::min<uint64_t>(strsz, kMaxDynamicBytes));
+    if(!at(seg->offset + (strtab - seg->vaddr), str.size(), str.data())) return true;
+    auto stringAt = [&](uint64_t o) -> std::string {
+        if(o >= str.size()) return {};
+        const void* z = std::memchr(str.data() + o, 0, str.size() - (size_t)o);
+        if(!z) return {};
+        return std::string((const char*)str.data() + o, (const char*)z);
+    };
+    auto split = [](const std::string& s, std::vector<std::string>& dst){
+        for(size_t b = 0; b <= s.size(); ){
+            size_t e = s.find(':', b);
+            if(e == std::string::npos) e = s.size();
+            if(e > b) dst.push_back(s.substr(b, e - b));
+            b = e + 1;
+        }
+    };
+    for(const auto& r : refs){
+        std::string s = stringAt(r.second);
+        if(s.empty()) continue;
+        if(r.first == 1) out.needed.push_back(std::move(s));
+        else if(r.first == 14) out.soname = std::move(s);
+        else if(r.first == 15){ if(!hasRunpath) split(s, out.rpath); }
+        else split(s, out.runpath);
+    }
+    return true;
+}
+
+bool parseELFDynamic(const std::vector<unsigned char>& buf, DynamicInfo& out){
+    return readDynamic([&buf](uint64_t off, size_t n, void* dst){
+        if(off > buf.size() || n > buf.size() - off) return false;
+        std::memcpy(dst, buf.data() + off, n);
+        return true;
+    }, buf.size(), out);
+}
+
+bool readELFDynamic(const std::string& path, DynamicInfo& out){
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if(!in) return false;
+    const std::streamoff size = in.tellg();
+    if(size < 0) return false;
+    return readDynamic([&in](uint64_t off, size_t n, void* dst){
+        in.clear();
+        in.seekg((std::streamoff)off);
+        in.read((char*)dst, (std::streamsize)n);
+        return in && (size_t)in.gcount() == n;
+    }, (uint64_t)size, out);
+}
+
 std::vector<Import> parseELF(const std::vector<unsigned char>& buf){
     std::vector<Import> out;
-    if(!isELF(buf)) return out;
-    if(buf.size() < 0x40) return out;
-    unsigned char ei_class = buf[4];
-    unsigned char ei_data  = buf[5];
-    bool be = (ei_data == 2);
-    if(ei_class == 2){
-        uint64_t e_phoff = be ? r64be(buf.data()+0x20) : r64le(buf.data()+0x20);
-        uint16_t e_phentsize = be ? r16be(buf.data()+0x36) : r16le(buf.data()+0x36);
-        uint16_t e_phnum     = be ? r16be(buf.data()+0x38) : r16le(buf.data()+0x38);
-        uint64_t dyn_off = 0, dyn_sz = 0;
-        for(uint16_t i=0;i<e_phnum;i++){
-            size_t off = (size_t)e_phoff + (size_t)i * e_phentsize;
-            if(off + 56 > buf.size()) break;
-            uint32_t p_type  = be ? r32be(buf.data()+off+0) : r32le(buf.data()+off+0);
-            uint64_t p_offset= be ? r64be(buf.data()+off+8) : r64le(buf.data()+off+8);
-            uint64_t p_filesz= be ? r64be(buf.data()+off+32): r64le(buf.data()+off+32);
-            if(p_type==2){ dyn_off = p_offset; dyn_sz = p_filesz; }
+    DynamicInfo info;
+    if(!parseELFDynamic(buf, info)) return out;
+    for(auto& name : info.needed) out.push_back({ std::move(name), {} });
+    return out;
+}
+
+std::vector<Import> parsePE(const std::vector<unsigned char>& buf){
+    std::vector<Import> out;
+    const PEImage img(buf);
+    for(const auto& m : img.imports()){
+        if(m.kind != PEImportKind::Regular) continue;
+        Import imp{ std::string(m.lib), {} };
+        for(const auto& f : m.funcs){
+            if(!f.name.empty()) imp.funcs.emplace_back(f.name);
         }
-        if(dyn_off==0 || dyn_sz==0) return out;
-        uint64_t strtab_va = 0; uint64_t strsz = 0;
-        std::vector<uint64_t> needed;
-        for(uint64_t i=0;i+16<=dyn_sz;i+=16){
-            size_t off = (size_t)dyn_off + (size_t)i;
-            if(off + 16 > buf.size()) break;
-            uint64_t d_tag = be ? r64be(buf.data()+off+0) : r64le(buf.data()+off+0);
-            uint64_t d_val = be ? r64be(buf.data()+off+8) : r64le(buf.data()+off+8);
-            if(d_tag==0) break;
-            if(d_tag==5) strtab_va = d_val;
-            else if(d_tag==10) strsz = d_val;
-            else if(d_tag==1) needed.push_back(d_val);
+        out.push_back(std::move(imp));
+    }
+    return out;
+}
+
+
+static const uint64_t kDtNull = 0;
+static const uint64_t kDtHash = 4;
+static const uint64_t kDtStrtab = 5;
+static const uint64_t kDtSymtab = 6;
+static const uint64_t kDtStrsz = 10;
+static const uint64_t kDtGnuHash = 0x6ffffef5;
+static const uint64_t kDtVersym = 0x6ffffff0;
+static const uint64_t kDtVerneed = 0x6ffffffe;
+static const uint64_t kDtVerneednum = 0x6fffffff;
+static const uint64_t kMaxDynSymbols = 1u << 20;
+static const uint32_t kShtDynsym = 11;
+
+static std::string cstrAt(const std::vector<unsigned char>& b, uint64_t off, uint64_t end){
+    std::string s;
+    if(end > b.size()) end = b.size();
+    for(uint64_t j=off; j<end && b[(size_t)j]; ++j){
+        s.push_back((char)b[(size_t)j]);
+        if(s.size() > 4096) break;
+    }
+    return s;
+}
+
+std::vector<ImportedSymbol> parseELFImports(const std::vector<unsigned char>& buf){
+    std::vector<ImportedSymbol> out;
+    if(!isELF(buf) || buf.size() < 0x40) return out;
+    const bool is64 = buf[4] == 2;
+    const bool be = buf[5] == 2;
+    auto in = [&](uint64_t off, uint64_t n){ return off <= buf.size() && n <= buf.size() - off; };
+    auto u16 = [&](uint64_t o){ return be ? r16be(buf.data()+o) : r16le(buf.data()+o); };
+    auto u32 = [&](uint64_t o){ return be ? r32be(buf.data()+o) : r32le(buf.data()+o); };
+    auto u64 = [&](uint64_t o){ return be ? r64be(buf.data()+o) : r64le(buf.data()+o); };
+    auto word = [&](uint64_t o){ return is64 ? u64(o) : (uint64_t)u32(o); };
+    const uint64_t phoff = is64 ? u64(0x20) : u32(0x1C);
+    const uint16_t phentsize = is64 ? u16(0x36) : u16(0x2A);
+    const uint16_t phnum = is64 ? u16(0x38) : u16(0x2C);
+    if(phentsize < (is64 ? 56 : 32)) return out;
+    auto toOff = [&](uint64_t va) -> uint64_t {
+        return is64 ? vaddr_to_off_64(buf, be, va, phoff, phentsize, phnum)
+                    : vaddr_to_off_32(buf, be, (uint32_t)va, (uint32_t)phoff, phentsize, phnum);
+    };
+
+    uint64_t dynOff = 0, dynSize = 0;
+    for(uint16_t i=0;i<phnum;i++){
+        const uint64_t ph = phoff + (uint64_t)i * phentsize;
+        if(!in(ph, phentsize)) break;
+        if(u32(ph) != 2) continue;
+        dynOff = is64 ? u64(ph+8) : u32(ph+4);
+        dynSize = is64 ? u64(ph+32) : u32(ph+16);
+    }
+    if(!dynOff || !in(dynOff, 0)) return out;
+    if(dynSize > buf.size() - dynOff) dynSize = buf.size() - dynOff;
+
+    uint64_t symtab = 0, strtab = 0, strsz = 0, hash = 0, gnuHash = 0, versym = 0, verneed = 0, verneednum = 0;
+    const uint64_t dynEnt = is64 ? 16 : 8;
+    for(uint64_t i=0; i+dynEnt<=dynSize; i+=dynEnt){
+        const uint64_t tag = word(dynOff+i);
+        const uint64_t val = word(dynOff+i+dynEnt/2);
+        if(tag == kDtNull) break;
+        switch(tag){
+            case kDtSymtab: symtab = val; break;
+            case kDtStrtab: strtab = val; break;
+            case kDtStrsz: strsz = val; break;
+            case kDtHash: hash = val; break;
+            case kDtGnuHash: gnuHash = val; break;
+            case kDtVersym: versym = val; break;
+            case kDtVerneed: verneed = val; break;
+            case kDtVerneednum: verneednum = val; break;
+            default: break;
         }
-        if(strtab_va==0) return out;
-        size_t strtab_off = vaddr_to_off_64(buf, be, strtab_va, e_phoff, e_phentsize, e_phnum);
-        if(strtab_off==0 || strtab_off >= buf.size()) return out;
-        for(uint64_t noff : needed){
-            size_t s = strtab_off + (size_t)noff;
-            if(s >= buf.size()) continue;
-            std::string name;
-            for(size_t j=s;j<buf.size();++j){ unsigned char c = buf[j]; if(c==0) break; name.push_back((char)c); if(name.size()>4096) break; }
-            if(!name.empty()) out.push_back({name, {}});
+    }
+    const uint64_t symOff = symtab ? toOff(symtab) : 0;
+    const uint64_t strOff = strtab ? toOff(strtab) : 0;
+    if(!symOff || !strOff) return out;
+    const uint64_t strEnd = (strsz && in(strOff, strsz)) ? strOff + strsz : buf.size();
+    const uint64_t symEnt = is64 ? 24 : 16;
+
+    // DT_SYMTAB carries no size. The .dynsym section header is exact; DT_HASH's nchain is the
+    // symbol count; GNU_HASH only bounds the hashed tail and says nothing when every bucket is
+    // empty, so it is paired with the gap up to the string table, which usually follows.
+    uint64_t count = 0;
+    for(const auto& s : parseELFSections(buf)){
+        if(s.type == kShtDynsym && s.offset == symOff){ count = s.size / symEnt; break; }
+    }
+    if(!count && hash){
+        const uint64_t h = toOff(hash);
+        if(h && in(h, 8)) count = u32(h+4);
+    }
+    if(!count && gnuHash){
+        const uint64_t h = toOff(gnuHash);
+        if(h && in(h, 16)){
+            const uint32_t nbuckets = u32(h), symoffset = u32(h+4), bloomSize = u32(h+8);
+            const uint64_t buckets = h + 16 + (uint64_t)bloomSize * (is64 ? 8 : 4);
+            const uint64_t chains = buckets + (uint64_t)nbuckets * 4;
+            if(in(buckets, (uint64_t)nbuckets * 4)){
+                uint32_t last = 0;
+                for(uint32_t i=0;i<nbuckets;i++) last = std::max(last, u32(buckets + (uint64_t)i*4));
+                if(last < symoffset){
+                    count = symoffset;
+                }else{
+                    uint64_t c = chains + (uint64_t)(last - symoffset) * 4;
+                    while(in(c, 4) && !(u32(c) & 1) && last < kMaxDynSymbols){ c += 4; ++last; }
+                    count = (uint64_t)last + 1;
+                }
+            }
         }
-        return out;
-    }else if(ei_class == 1){
-        uint32_t e_phoff = be ? r32be(buf.data()+0x1C) : r32le(buf.data()+0x1C);
-        uint16_t e_phentsize = be ? r16be(buf.data()+0x2A) : r16le(buf.data()+0x2A);
-        uint16_t e_phnum     = be ? r16be(buf.data()+0x2C) : r16le(buf.data()+0x2C);
-        uint32_t dyn_off = 0, dyn_sz = 0;
-        for(uint16_t i=0;i<e_phnum;i++){
-            size_t off = (size_t)e_phoff + (size_t)i * e_phentsize;
-            if(off + 32 > buf.size()) break;
-            uint32_t p_type  = be ? r32be(buf.data()+off+0) : r32le(buf.data()+off+0);
-            uint32_t p_offset= be ? r32be(buf.data()+off+4) : r32le(buf.data()+off+4);
-            uint32_t p_filesz= be ? r32be(buf.data()+off+16): r32le(buf.data()+off+16);
-            if(p_type==2){ dyn_off = p_offset; dyn_sz = p_filesz; }
+        if(strOff > symOff) count = std::max<uint64_t>(count, (strOff - symOff) / symEnt);
+    }
+    if(!count && strOff > symOff) count = (strOff - symOff) / symEnt;
+    count = std::min<uint64_t>(count, kMaxDynSymbols);
+    if(!in(symOff, count * symEnt)) count = (buf.size() - symOff) / symEnt;
+
+    // Version index -> (version, library) from the Verneed/Vernaux chains.
+    std::vector<std::pair<std::string, std::string>> versions;
+    const uint64_t vnOff = verneed ? toOff(verneed) : 0;
+    uint64_t vn = vnOff;
+    for(uint64_t n=0; vn && n<verneednum && n<4096 && in(vn, 16); ++n){
+        const uint16_t cnt = u16(vn+2);
+        const std::string file = cstrAt(buf, strOff + u32(vn+4), strEnd);
+        uint64_t aux = vn + u32(vn+8);
+        for(uint16_t k=0; k<cnt && in(aux, 16); ++k){
+            const uint16_t idx = u16(aux+6) & 0x7fff;
+            if(idx >= versions.size()) versions.resize((size_t)idx + 1);
+            versions[idx] = { cstrAt(buf, strOff + u32(aux+8), strEnd), file };
+            const uint32_t next = u32(aux+12);
+            if(!next) break;
+            aux += next;
         }
-        if(dyn_off==0 || dyn_sz==0) return out;
-        uint32_t strtab_va = 0; uint32_t strsz = 0;
-        std::vector<uint32_t> needed;
-        for(uint32_t i=0;i+8<=dyn_sz;i+=8){
-            size_t off = (size_t)dyn_off + (size_t)i;
-            if(off + 8 > buf.size()) break;
-            uint32_t d_tag = be ? r32be(buf.data()+off+0) : r32le(buf.data()+off+0);
-            uint32_t d_val = be ? r32be(buf.data()+off+4) : r32le(buf.data()+off+4);
-            if(d_tag==0) break;
-            if(d_tag==5) strtab_va = d_val;
-            else if(d_tag==10) strsz = d_val;
-            else if(d_tag==1) needed.push_back(d_val);
+        const uint32_t next = u32(vn+12);
+        if(!next) break;
+        vn += next;
+    }
+    const uint64_t vsOff = versym ? toOff(versym) : 0;
+
+    for(uint64_t i=1; i<count; ++i){
+        const uint64_t e = symOff + i * symEnt;
+        const uint32_t name = u32(e);
+        const unsigned char info = is64 ? buf[(size_t)e+4] : buf[(size_t)e+12];
+        const uint16_t shndx = is64 ? u16(e+6) : u16(e+14);
+        const unsigned bind = info >> 4;
+        if(shndx != 0 || !name || (bind != 1 && bind != 2)) continue;
+        ImportedSymbol sym;
+        sym.name = cstrAt(buf, strOff + name, strEnd);
+        if(sym.name.empty()) continue;
+        sym.offset = e;
+        if(vsOff && in(vsOff + i*2, 2)){
+            const uint16_t v = u16(vsOff + i*2) & 0x7fff;
+            if(v > 1 && v < versions.size()){
+                sym.version = versions[v].first;
+                sym.lib = versions[v].second;
+            }
         }
-        if(strtab_va==0) return out;
-        size_t strtab_off = vaddr_to_off_32(buf, be, strtab_va, e_phoff, e_phentsize, e_phnum);
-        if(strtab_off==0 || strtab_off >= buf.size()) return out;
-        for(uint32_t noff : needed){
-            size_t s = strtab_off + (size_t)noff;
-            if(s >= buf.size()) continue;
-            std::string name;
-            for(size_t j=s;j<buf.size();++j){ unsigned char c = buf[j]; if(c==0) break; name.push_back((char)c); if(name.size()>4096) break; }
-            if(!name.empty()) out.push_back({name, {}});
+        out.push_back(std::move(sym));
+    }
+    return out;
+}
+
+static const uint32_t kShtProgbits = 1;
+static const uint32_t kShtNobits = 8;
+static const uint64_t kShfAlloc = 0x2;
+static const uint64_t kShfExecinstr = 0x4;
+static const uint32_t kShtSymtab = 2;
+static const unsigned kSttFunc = 2;
+static const unsigned kSttGnuIfunc = 10;
+static const uint64_t kPfX = 0x1;
+static const uint64_t kScnCntCode = 0x20;
+static const uint64_t kScnMemExecute = 0x20000000;
+
+static inline bool startsWith(const std::string& s, const char* prefix){
+    return s.rfind(prefix, 0) == 0;
+}
+
+static std::vector<Section> elfSegments(const std::vector<unsigned char>& buf, bool is64, bool be){
+    std::vector<Section> out;
+    auto u16 = [&](size_t o){ return be ? r16be(buf.data()+o) : r16le(buf.data()+o); };
+    auto u32 = [&](size_t o){ return be ? r32be(buf.data()+o) : r32le(buf.data()+o); };
+    auto u64 = [&](size_t o){ return be ? r64be(buf.data()+o) : r64le(buf.data()+o); };
+    const uint64_t phoff = is64 ? u64(0x20) : u32(0x1C);
+    const uint16_t phentsize = is64 ? u16(0x36) : u16(0x2A);
+    const uint16_t phnum = is64 ? u16(0x38) : u16(0x2C);
+    if(phentsize < (is64 ? 56 : 32) || phoff > buf.size()) return out;
+    for(uint16_t i=0;i<phnum;i++){
+        const uint64_t off = phoff + (uint64_t)i * phentsize;
+        if(off + phentsize > buf.size()) break;
+        if(u32((size_t)off) != 1) continue;
+        Section s;
+        s.name = "LOAD" + std::to_string(out.size());
+        s.segment = true;
+        s.flags = is64 ? u32((size_t)off+4) : u32((size_t)off+24);
+        s.offset = is64 ? u64((size_t)off+8) : u32((size_t)off+4);
+        s.size = is64 ? u64((size_t)off+32) : u32((size_t)off+16);
+        s.addr = is64 ? u64((size_t)off+16) : u32((size_t)off+8);
+        if(s.offset >= buf.size()) continue;
+        if(s.size > buf.size() - s.offset) s.size = buf.size() - s.offset;
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+std::vector<Section> parseELFSections(const std::vector<unsigned char>& buf){
+    std::vector<Section> out;
+    if(!isELF(buf) || buf.size() < 0x40) return out;
+    const bool is64 = buf[4] == 2;
+    const bool be = buf[5] == 2;
+    auto u16 = [&](size_t o){ return be ? r16be(buf.data()+o) : r16le(buf.data()+o); };
+    auto u32 = [&](size_t o){ return be ? r32be(buf.data()+o) : r32le(buf.data()+o); };
+    auto u64 = [&](size_t o){ return be ? r64be(buf.data()+o) : r64le(buf.data()+o); };
+    const uint64_t shoff = is64 ? u64(0x28) : u32(0x20);
+    const uint16_t shentsize = is64 ? u16(0x3A) : u16(0x2E);
+    uint64_t shnum = is64 ? u16(0x3C) : u16(0x30);
+    uint32_t shstrndx = is64 ? u16(0x3E) : u16(0x32);
+    const size_t minEnt = is64 ? 64 : 40;
+    if(shoff == 0 || shentsize < minEnt || shoff > buf.size() || buf.size() - shoff < minEnt) return elfSegments(buf, is64, be);
+    // More than 0xff00 sections: the real count and string table index live in section 0.
+    if(shnum == 0) shnum = is64 ? u64((size_t)shoff+32) : u32((size_t)shoff+20);
+    if(shstrndx == 0xFFFF) shstrndx = is64 ? u32((size_t)shoff+40) : u32((size_t)shoff+24);
+    if(shnum == 0 || shnum > (buf.size() - shoff) / shentsize) return elfSegments(buf, is64, be);
+
+    struct Raw { uint32_t name; Section s; };
+    std::vector<Raw> raw;
+    raw.reserve((size_t)shnum);
+    for(uint64_t i=0;i<shnum;i++){
+        const size_t h = (size_t)(shoff + i * shentsize);
+        Raw r;
+        r.name = u32(h);
+        r.s.type = u32(h+4);
+        r.s.flags = is64 ? u64(h+8) : u32(h+8);
+        r.s.addr = is64 ? u64(h+16) : u32(h+12);
+        r.s.offset = is64 ? u64(h+24) : u32(h+16);
+        r.s.size = is64 ? u64(h+32) : u32(h+20);
+        r.s.link = is64 ? u32(h+40) : u32(h+24);
+        r.s.index = (uint32_t)i;
+        raw.push_back(r);
+    }
+    uint64_t strOff = 0, strSize = 0;
+    if(shstrndx < raw.size()){
+        strOff = raw[shstrndx].s.offset;
+        strSize = raw[shstrndx].s.size;
+        if(strOff >= buf.size()) strSize = 0;
+        else if(strSize > buf.size() - strOff) strSize = buf.size() - strOff;
+    }
+    for(size_t i=1;i<raw.size();i++){
+        Section s = raw[i].s;
+        if(raw[i].name < strSize){
+            for(uint64_t j = strOff + raw[i].name; j < strOff + strSize && buf[(size_t)j]; ++j){
+                s.name.push_back((char)buf[(size_t)j]);
+                if(s.name.size() > 256) break;
+            }
         }
-        return out;
+        if(s.type == kShtNobits || s.offset >= buf.size()) s.size = 0;
+        else if(s.size > buf.size() - s.offset) s.size = buf.size() - s.offset;
+        out.push_back(std::move(s));
     }
+    bool anyBytes = false;
+    for(const auto& s : out) if(s.size) { anyBytes = true; break; }
+    if(!anyBytes) return elfSegments(buf, is64, be);
     return out;
 }
 
-struct Sect {
-    uint32_t va;
-    uint32_t rawSize;
-    uint32_t rawPtr;
-};
-
-static size_t rva_to_off(const std::vector<unsigned char>& b, uint32_t rva, const std::vector<Sect>& secs){
-    for(const auto& s: secs){
-        uint32_t start = s.va;
-        uint32_t end = s.va + (s.rawSize ? s.rawSize : 1);
-        if(rva >= start && rva < end){
-            uint32_t delta = rva - start;
-            size_t off = (size_t)s.rawPtr + (size_t)delta;
-            if(off < b.size()) return off;
+bool isELFDebugSection(const Section& s){
+    return startsWith(s.name, ".debug") || startsWith(s.name, ".zdebug") || startsWith(s.name, ".gnu_debug")
+        || startsWith(s.name, ".stab") || s.name == ".line";
+}
+
+bool isELFStringSection(const Section& s){
+    if(s.segment) return true;
+    if(s.size == 0) return false;
+    if(s.name == ".dynstr" || s.name == ".comment") return true;
+    if(s.type != kShtProgbits || (s.flags & kShfExecinstr)) return false;
+    return startsWith(s.name, ".rodata") || startsWith(s.name, ".rdata") || startsWith(s.name, ".data")
+        || startsWith(s.name, ".tdata");
+}
+
+bool isELFDataSection(const Section& s){
+    if(s.segment) return true;
+    if(s.size == 0 || s.type != kShtProgbits) return false;
+    if(!(s.flags & kShfAlloc) || (s.flags & kShfExecinstr)) return false;
+    return !(startsWith(s.name, ".eh_frame") || startsWith(s.name, ".gcc_except_table") || startsWith(s.name, ".got")
+          || startsWith(s.name, ".plt") || startsWith(s.name, ".interp") || startsWith(s.name, ".note"));
+}
+
+bool isELFCodeSection(const Section& s){
+    if(s.segment) return s.size && (s.flags & kPfX);
+    if(s.size == 0 || s.type != kShtProgbits) return false;
+    return (s.flags & kShfAlloc) && (s.flags & kShfExecinstr);
+}
+
+uint16_t elfMachine(const std::vector<unsigned char>& buf){
+    if(!isELF(buf) || buf.size() < 0x14) return 0;
+    return buf[5] == 2 ? r16be(buf.data()+0x12) : r16le(buf.data()+0x12);
+}
+
+std::vector<FunctionSymbol> parseELFFunctions(const std::vector<unsigned char>& buf, const std::vector<Section>& sections){
+    std::vector<FunctionSymbol> out;
+    if(!isELF(buf) || buf.size() < 0x40) return out;
+    const bool is64 = buf[4] == 2;
+    const bool be = buf[5] == 2;
+    auto u16 = [&](uint64_t o){ return be ? r16be(buf.data()+o) : r16le(buf.data()+o); };
+    auto u32 = [&](uint64_t o){ return be ? r32be(buf.data()+o) : r32le(buf.data()+o); };
+    auto u64 = [&](uint64_t o){ return be ? r64be(buf.data()+o) : r64le(buf.data()+o); };
+    std::vector<const Section*> byIndex;
+    for(const auto& s : sections){
+        if(s.segment) continue;
+        if(s.index >= byIndex.size()) byIndex.resize((size_t)s.index + 1, nullptr);
+        byIndex[s.index] = &s;
+    }
+    const uint64_t symEnt = is64 ? 24 : 16;
+    for(const auto& tab : sections){
+        if(tab.segment || (tab.type != kShtSymtab && tab.type != kShtDynsym)) continue;
+        if(tab.link >= byIndex.size() || !byIndex[tab.link]) continue;
+        const Section& str = *byIndex[tab.link];
+        for(uint64_t e = tab.offset + symEnt; e + symEnt <= tab.offset + tab.size; e += symEnt){
+            const uint32_t name = u32(e);
+            const unsigned char info = is64 ? buf[(size_t)e+4] : buf[(size_t)e+12];
+            const uint16_t shndx = is64 ? u16(e+6) : u16(e+14);
+            const uint64_t value = is64 ? u64(e+8) : u32(e+4);
+            const uint64_t size = is64 ? u64(e+16) : u32(e+8);
+            const unsigned type = info & 0xF;
+            if((type != kSttFunc && type != kSttGnuIfunc) || size == 0 || shndx == 0 || shndx >= 0xff00) continue;
+            if(shndx >= byIndex.size() || !byIndex[shndx]) continue;
+            const Section& code = *byIndex[shndx];
+            // Relocatable objects give values relative to their section, everything else addresses.
+            const uint64_t rel = value >= code.addr ? value - code.addr : value;
+            if(rel >= code.size || name >= str.size) continue;
+            FunctionSymbol f;
+            f.name = cstrAt(buf, str.offset + name, str.offset + str.size);
+            f.addr = value;
+            f.size = std::min(size, code.size - rel);
+            f.offset = code.offset + rel;
+            if(!f.name.empty()) out.push_back(std::move(f));
         }
     }
-    return (size_t)0;
+    std::sort(out.begin(), out.end(), [](const FunctionSymbol& a, const FunctionSymbol& b){
+        return a.offset != b.offset ? a.offset < b.offset : a.name < b.name;
+    });
+    out.erase(std::unique(out.begin(), out.end(), [](const FunctionSymbol& a, const FunctionSymbol& b){
+        return a.offset == b.offset;
+    }), out.end());
+    return out;
 }
 
-std::vector<Import> parsePE(const std::vector<unsigned char>& buf){
-    std::vector<Import> out;
+uint16_t peMachine(const std::vector<unsigned char>& buf){
+    if(!isPE(buf)) return 0;
+    const size_t nt = (size_t)r32le(buf.data()+0x3C);
+    if(nt + 6 > buf.size()) return 0;
+    return r16le(buf.data()+nt+4);
+}
+
+std::vector<Section> parsePESections(const std::vector<unsigned char>& buf){
+    std::vector<Section> out;
     if(!isPE(buf)) return out;
-    uint32_t e_lfanew = r32le(buf.data()+0x3C);
-    size_t nt = (size_t)e_lfanew;
+    const size_t nt = (size_t)r32le(buf.data()+0x3C);
     if(nt + 24 > buf.size()) return out;
-    uint16_t numSecs = r16le(buf.data()+nt+6);
-    uint16_t optSize = r16le(buf.data()+nt+20);
-    size_t opt = nt + 24;
-    if(opt + optSize > buf.size()) return out;
-    uint16_t magic = r16le(buf.data()+opt+0);
-    bool pePlus = (magic == 0x20B);
-    size_t ddOff = pePlus ? 112 : 96;
-    if(ddOff + 8*2 > optSize) return out;
-    uint32_t impRVA = r32le(buf.data()+opt+ddOff+8);
-    uint32_t impSize= r32le(buf.data()+opt+ddOff+12);
-    size_t sectHdr = opt + optSize;
-    std::vector<Sect> secs; secs.reserve(numSecs);
+    const uint16_t numSecs = r16le(buf.data()+nt+6);
+    const uint16_t optSize = r16le(buf.data()+nt+20);
+    const size_t opt = nt + 24;
+    if(opt + optSize > buf.size() || optSize < 32) return out;
+    const bool pePlus = r16le(buf.data()+opt) == 0x20B;
+    const uint64_t imageBase = pePlus ? r64le(buf.data()+opt+24) : r32le(buf.data()+opt+28);
     for(uint16_t i=0;i<numSecs;i++){
-        size_t sh = sectHdr + (size_t)i * 40;
+        const size_t sh = opt + optSize + (size_t)i * 40;
         if(sh + 40 > buf.size()) break;
-        uint32_t va       = r32le(buf.data()+sh+12);
-        uint32_t rawSize  = r32le(buf.data()+sh+16);
-        uint32_t rawPtr   = r32le(buf.data()+sh+20);
-        secs.push_back({va, rawSize, rawPtr});
-    }
-    if(impRVA==0 || impSize==0) return out;
-    size_t impOff = rva_to_off(buf, impRVA, secs);
-    if(impOff==0 || impOff >= buf.size()) return out;
-    size_t cur = impOff;
-    for(;;){
-        if(cur + 20 > buf.size()) break;
-        uint32_t oft = r32le(buf.data()+cur+0);
-        uint32_t tds = r32le(buf.data()+cur+4);
-        uint32_t fwd = r32le(buf.data()+cur+8);
-        uint32_t nameRVA = r32le(buf.data()+cur+12);
-        uint32_t ft = r32le(buf.data()+cur+16);
-        if(oft==0 && nameRVA==0 && ft==0) break;
-        std::string dll;
-        if(nameRVA){
-            size_t nameOff = rva_to_off(buf, nameRVA, secs);
-            if(nameOff && nameOff < buf.size()){
-                for(size_t j=nameOff;j<buf.size();++j){ unsigned char c = buf[j]; if(c==0) break; dll.push_back((char)c); if(dll.size()>1024) break; }
-            }
-        }
-        std::vector<std::string> funcs;
-        uint32_t thunkRVA = oft ? oft : ft;
-        if(thunkRVA){
-            size_t thunkOff = rva_to_off(buf, thunkRVA, secs);
-            if(thunkOff){
-                for(;;){
-                    if(pePlus){
-                        if(thunkOff + 8 > buf.size()) break;
-                        uint64_t ent = r64le(buf.data()+thunkOff);
-                        if(ent==0) break;
-                        bool isOrd = (ent >> 63) != 0;
-                        if(!isOrd){
-                            uint32_t ibnRVA = (uint32_t)(ent & 0x7FFFFFFF);
-                            size_t ibnOff = rva_to_off(buf, ibnRVA, secs);
-                            if(ibnOff && ibnOff + 2 < buf.size()){
-                                size_t nm = ibnOff + 2;
-                                std::string fn;
-                                for(size_t k=nm;k<buf.size();++k){ unsigned char c = buf[k]; if(c==0) break; fn.push_back((char)c); if(fn.size()>2048) break; }
-                                if(!fn.empty()) funcs.push_back(fn);
-                            }
-                        }
-                        thunkOff += 8;
-                    }else{
-                        if(thunkOff + 4 > buf.size()) break;
-                        uint32_t ent = r32le(buf.data()+thunkOff);
-                        if(ent==0) break;
-                        bool isOrd = (ent >> 31) != 0;
-                        if(!isOrd){
-                            uint32_t ibnRVA = ent & 0x7FFFFFFF;
-                            size_t ibnOff = rva_to_off(buf, ibnRVA, secs);
-                            if(ibnOff && ibnOff + 2 < buf.size()){
-                                size_t nm = ibnOff + 2;
-                                std::string fn;
-                                for(size_t k=nm;k<buf.size();++k){ unsigned char c = buf[k]; if(c==0) break; fn.push_back((char)c); if(fn.size()>2048) break; }
-                                if(!fn.empty()) funcs.push_back(fn);
-                            }
-                        }
-                        thunkOff += 4;
-                    }
-                }
-            }
-        }
-        if(!dll.empty()) out.push_back({dll, funcs});
-        cur += 20;
+        Section s;
+        for(int k=0;k<8 && buf[sh+k];k++) s.name.push_back((char)buf[sh+k]);
+        const uint32_t vsize = r32le(buf.data()+sh+8);
+        s.addr = imageBase + r32le(buf.data()+sh+12);
+        s.size = r32le(buf.data()+sh+16);
+        s.offset = r32le(buf.data()+sh+20);
+        s.flags = r32le(buf.data()+sh+36);
+        if(vsize && vsize < s.size) s.size = vsize;
+        if(s.offset >= buf.size()) s.size = 0;
+        else if(s.size > buf.size() - s.offset) s.size = buf.size() - s.offset;
+        out.push_back(std::move(s));
     }
     return out;
 }
 
+bool isPECodeSection(const Section& s){
+    return s.size && (s.flags & (kScnCntCode | kScnMemExecute));
+}
+
 }
@@ -11,9 +11,79 @@ struct Import {
     std::vector<std::string> funcs;
 };
 
+// An undefined dynamic symbol with the version and library it was bound against through
+// DT_VERNEED; both are empty for unversioned references.
+struct ImportedSymbol {
+    std::string name;
+    std::string version;
+    std::string lib;
+    uint64_t offset = 0;    // file offset of the symbol's .dynsym entry
+};
+
+struct Section {
+    std::string name;
+    uint32_t type = 0;
+    uint64_t flags = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t addr = 0;      // virtual address (PE: image base + RVA)
+    uint32_t index = 0;     // section header index; 0 for segments and PE sections
+    uint32_t link = 0;
+    bool segment = false;   // synthesized from a PT_LOAD program header
+};
+
+// What the dynamic loader reads from PT_DYNAMIC to find an object's dependencies. rpath stays
+// empty when DT_RUNPATH is present, as ld.so ignores DT_RPATH then; both hold the entries of the
+// colon-separated lists with $ORIGIN and friends unexpanded.
+struct DynamicInfo {
+    unsigned char elfClass = 0;     // 1 = ELFCLASS32, 2 = ELFCLASS64
+    bool bigEndian = false;
+    uint16_t machine = 0;
+    std::string soname;
+    std::vector<std::string> needed;
+    std::vector<std::string> rpath;
+    std::vector<std::string> runpath;
+};
+
+// A defined function symbol from .symtab or .dynsym, with the file offset of its first byte.
+struct FunctionSymbol {
+    std::string name;
+    uint64_t addr = 0;
+    uint64_t size = 0;
+    uint64_t offset = 0;
+};
+
 bool isELF(const std::vector<unsigned char>& buf);
 bool isPE(const std::vector<unsigned char>& buf);
 std::vector<Import> parseELF(const std::vector<unsigned char>& buf);
+// False for anything that is not ELF; a static executable gives an empty DynamicInfo.
+bool parseELFDynamic(const std::vector<unsigned char>& buf, DynamicInfo& out);
+// Same, reading only the ELF header, program headers, dynamic segment and string table from disk.
+bool readELFDynamic(const std::string& path, DynamicInfo& out);
+// Regular import table only; PEImage also covers delay-load and bound imports and exports.
 std::vector<Import> parsePE(const std::vector<unsigned char>& buf);
+// Undefined global and weak symbols from DT_SYMTAB. The table size comes from DT_GNU_HASH or
+// DT_HASH, and versions come from DT_VERSYM and DT_VERNEED.
+std::vector<ImportedSymbol> parseELFImports(const std::vector<unsigned char>& buf);
+
+// File-backed ELF sections, clamped to the buffer. Files without a usable section header table
+// (stripped or truncated) get one "LOAD<n>" entry per PT_LOAD segment instead.
+std::vector<Section> parseELFSections(const std::vector<unsigned char>& buf);
+bool isELFDebugSection(const Section& s);
+// Sections where embedded strings are worth matching: read-only and initialized data, .dynstr, .comment.
+bool isELFStringSection(const Section& s);
+// Allocated, non-executable data where OIDs, curve parameters and similar constants live.
+bool isELFDataSection(const Section& s);
+// Allocated, executable code (.text, .init, ...) or an executable PT_LOAD segment.
+bool isELFCodeSection(const Section& s);
+// STT_FUNC/STT_GNU_IFUNC symbols with a size from the symbol tables among sections, sorted by
+// offset without duplicates.
+std::vector<FunctionSymbol> parseELFFunctions(const std::vector<unsigned char>& buf, const std::vector<Section>& sections);
+uint16_t elfMachine(const std::vector<unsigned char>& buf);
+
+// PE section table, clamped to the buffer; flags hold the section characteristics.
+std::vector<Section> parsePESections(const std::vector<unsigned char>& buf);
+bool isPECodeSection(const Section& s);
+uint16_t peMachine(const std::vector<unsigned char>& buf);
 
 }
@@ -0,0 +1,402 @@
+#include "GoBinaryScanner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace analyzers {
+
+namespace {
+
+const char kBuildInfoMagic[] = "\xff Go buildinf:";
+const size_t kBuildInfoMagicSize = sizeof(kBuildInfoMagic) - 1;
+const size_t kBuildInfoHeaderSize = 32;
+const uint8_t kBuildInfoBigEndian = 0x1;
+const uint8_t kBuildInfoInline = 0x2;     // Go 1.18+: strings follow the header
+const size_t kModInfoSentinel = 16;
+const size_t kMaxBuildString = 16u << 20;
+const uint64_t kMaxFunctions = 1u << 24;
+const size_t kMaxFuncName = 4096;
+const uint32_t kShtNobits = 8;
+
+enum PclnVersion { kGo12, kGo116, kGo118, kGo120 };
+
+struct PclnMagic {
+    uint32_t magic;
+    PclnVersion version;
+};
+
+const PclnMagic kPclnMagics[] = {
+    { 0xFFFFFFFB, kGo12 }, { 0xFFFFFFFA, kGo116 }, { 0xFFFFFFF0, kGo118 }, { 0xFFFFFFF1, kGo120 },
+};
+
+uint32_t rd32(const unsigned char* p, bool be){
+    return be ? ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]
+              : (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+uint64_t rdWord(const unsigned char* p, int ptrSize, bool be){
+    if(ptrSize == 4) return rd32(p, be);
+    return be ? ((uint64_t)rd32(p, true) << 32) | rd32(p + 4, true) : (uint64_t)rd32(p, false) | ((uint64_t)rd32(p + 4, false) << 32);
+}
+
+std::string_view cstrAt(const std::vector<unsigned char>& buf, size_t off, size_t limit){
+    if(off >= limit) return {};
+    const void* z = std::memchr(buf.data() + off, 0, std::min(limit - off, kMaxFuncName));
+    if(!z) return {};
+    return std::string_view((const char*)buf.data() + off, (size_t)((const unsigned char*)z - (buf.data() + off)));
+}
+
+const dyn::Section* named(const std::vector<dyn::Section>& sections, std::initializer_list<const char*> names){
+    for(const auto& s : sections){
+        if(!s.size || s.type == kShtNobits) continue;
+        for(const char* n : names) if(s.name == n) return &s;
+    }
+    return nullptr;
+}
+
+// Where a table without a section of its own may sit: a PE section, or any segment of an ELF
+// file whose section headers were stripped.
+std::vector<const dyn::Section*> searchable(const std::vector<dyn::Section>& sections, const char* peSection){
+    std::vector<const dyn::Section*> out;
+    for(const auto& s : sections){
+        if(s.size && (s.segment || s.name == peSection)) out.push_back(&s);
+    }
+    return out;
+}
+
+size_t addrToOffset(const std::vector<dyn::Section>& sections, uint64_t va, uint64_t len){
+    for(const auto& s : sections){
+        if(!s.size || s.type == kShtNobits || va < s.addr || va - s.addr > s.size || len > s.size - (va - s.addr)) continue;
+        return (size_t)(s.offset + (va - s.addr));
+    }
+    return (size_t)-1;
+}
+
+// Splits the modinfo text ("path\t...", "mod\t...", "dep\t...", "=>\t...", "build\t...") whose
+// first byte sits at file offset `base`.
+void parseModInfo(std::string_view mod, size_t base, GoBuildInfo& out){
+    GoModule* last = nullptr;
+    for(size_t pos = 0; pos < mod.size(); ){
+        size_t eol = mod.find('\n', pos);
+        if(eol == std::string_view::npos) eol = mod.size();
+        const std::string_view line = mod.substr(pos, eol - pos);
+        std::vector<std::string_view> f;
+        for(size_t s = 0; s <= line.size(); ){
+            size_t t = line.find('\t', s);
+            if(t == std::string_view::npos) t = line.size();
+            f.push_back(line.substr(s, t - s));
+            s = t + 1;
+        }
+        auto module = [&](GoModule& m){
+            m.path = std::string(f[1]);
+            if(f.size() > 2) m.version = std::string(f[2]);
+            if(f.size() > 3) m.sum = std::string(f[3]);
+            m.offset = base + pos;
+        };
+        if(f.size() >= 2){
+            if(f[0] == "path") out.path = std::string(f[1]);
+            else if(f[0] == "mod"){ module(out.main); last = &out.main; }
+            else if(f[0] == "dep"){ out.deps.emplace_back(); module(out.deps.back()); last = &out.deps.back(); }
+            else if(f[0] == "=>" && last) last->replacement = f.size() > 2 ? std::string(f[1]) + " " + std::string(f[2]) : std::string(f[1]);
+            else if(f[0] == "build") out.settings.push_back(std::string(f[1]));
+        }
+        pos = eol + 1;
+    }
+}
+
+bool parseBuildInfo(const std::vector<unsigned char>& buf, const std::vector<dyn::Section>& sections, size_t h, size_t limit, GoBuildInfo& out){
+    if(h + kBuildInfoHeaderSize > limit) return false;
+    const int ptrSize = buf[h + 14];
+    const uint8_t flags = buf[h + 15];
+    std::string_view version, mod;
+    size_t modOff = 0;
+    if(flags & kBuildInfoInline){
+        size_t pos = h + kBuildInfoHeaderSize;
+        auto next = [&](std::string_view& s, size_t& at){
+            uint64_t len = 0;
+            for(int shift = 0; ; shift += 7){
+                if(pos >= limit || shift > 63) return false;
+                const unsigned char b = buf[pos++];
+                len |= (uint64_t)(b & 0x7F) << shift;
+                if(!(b & 0x80)) break;
+            }
+            if(len > kMaxBuildString || len > limit - pos) return false;
+            at = pos;
+            s = std::string_view((const char*)buf.data() + pos, (size_t)len);
+            pos += (size_t)len;
+            return true;
+        };
+        size_t verOff = 0;
+        if(!next(version, verOff) || !next(mod, modOff)) return false;
+    }else{
+        // Before Go 1.18 the header points at two Go string headers (data pointer, length).
+        if(ptrSize != 4 && ptrSize != 8) return false;
+        const bool be = flags & kBuildInfoBigEndian;
+        auto goString = [&](uint64_t va, std::string_view& s, size_t& at){
+            const size_t hdr = addrToOffset(sections, va, 2 * (uint64_t)ptrSize);
+            if(hdr == (size_t)-1) return false;
+            const uint64_t data = rdWord(buf.data() + hdr, ptrSize, be), len = rdWord(buf.data() + hdr + ptrSize, ptrSize, be);
+            if(len > kMaxBuildString) return false;
+            at = len ? addrToOffset(sections, data, len) : 0;
+            if(at == (size_t)-1) return false;
+            s = std::string_view((const char*)buf.data() + at, (size_t)len);
+            return true;
+        };
+        size_t verOff = 0;
+        if(!goString(rdWord(buf.data() + h + 16, ptrSize, be), version, verOff)) return false;
+        if(!goString(rdWord(buf.data() + h + 16 + ptrSize, ptrSize, be), mod, modOff)) mod = {};
+    }
+    if(version.rfind("go", 0) != 0 && version.rfind("devel", 0) != 0) return false;
+    out.goVersion = std::string(version);
+    out.offset = h;
+    if(mod.size() >= 2 * kModInfoSentinel + 1 && mod[mod.size() - kModInfoSentinel - 1] == '\n'){
+        mod = mod.substr(kModInfoSentinel, mod.size() - 2 * kModInfoSentinel);
+        modOff += kModInfoSentinel;
+    }
+    parseModInfo(mod, modOff, out);
+    return true;
+}
+
+// Function names of the pclntab at file offset `base`; `limit` bounds every read. From Go 1.16
+// the names sit in a table of their own that also names every inlined call site, so a package
+// whose only use was inlined into the caller is still found; Go 1.2 tables are walked through
+// functab -> _func -> nameOff.
+bool parsePclntab(const std::vector<unsigned char>& buf, size_t base, size_t limit, std::vector<GoFunction>& out){
+    if(base + 16 > limit) return false;
+    const unsigned char* p = buf.data() + base;
+    const size_t n = limit - base;
+    const PclnMagic* magic = nullptr;
+    bool be = false;
+    for(const auto& m : kPclnMagics){
+        if(rd32(p, false) == m.magic){ magic = &m; break; }
+        if(rd32(p, true) == m.magic){ magic = &m; be = true; break; }
+    }
+    const int ptr = p[7];
+    if(!magic || p[4] || p[5] || !(p[6] == 1 || p[6] == 2 || p[6] == 4) || !(ptr == 4 || ptr == 8)) return false;
+    auto word = [&](int i) -> uint64_t {
+        const size_t o = 8 + (size_t)i * ptr;
+        return o + ptr <= n ? rdWord(p + o, ptr, be) : UINT64_MAX;
+    };
+    const uint64_t nfunc = word(0);
+    if(nfunc == 0 || nfunc > kMaxFunctions) return false;
+    const size_t first = out.size();
+    if(magic->version == kGo12){
+        const uint64_t functab = 8 + (uint64_t)ptr, entry = 2 * (uint64_t)ptr;
+        if(nfunc * entry > n - functab) return false;
+        for(uint64_t i = 0; i < nfunc; ++i){
+            const uint64_t funcOff = rdWord(p + functab + i * entry + ptr, ptr, be);
+            if(funcOff > n || funcOff + ptr + 4 > n) continue;
+            const uint64_t nameOff = rd32(p + funcOff + ptr, be);
+            const std::string_view name = nameOff < n ? cstrAt(buf, base + (size_t)nameOff, limit) : std::string_view();
+            if(!name.empty()) out.push_back({ name, base + (size_t)nameOff });
+        }
+    }else{
+        // funcnametab runs up to the compilation unit table that follows it.
+        const int names = magic->version == kGo116 ? 2 : 3;
+        const uint64_t from = word(names), to = word(names + 1);
+        if(from >= to || to > n) return false;
+        for(size_t o = (size_t)from; o < (size_t)to; ){
+            const std::string_view name = cstrAt(buf, base + o, base + (size_t)to);
+            if(!name.empty()) out.push_back({ name, base + o });
+            o += name.size() + 1;
+        }
+    }
+    // Every Go program links the runtime; a header that does not lead to it was a coincidence.
+    for(size_t i = first; i < out.size(); ++i){
+        if(out[i].name.rfind("runtime.", 0) == 0) return true;
+    }
+    out.resize(first);
+    return false;
+}
+
+bool findPclntab(const std::vector<unsigned char>& buf, const std::vector<dyn::Section>& sections, bool search,
+                 std::vector<GoFunction>& out, std::string& where){
+    if(const dyn::Section* s = named(sections, { ".gopclntab", ".data.rel.ro.gopclntab", "__gopclntab" })){
+        where = s->name;
+        return parsePclntab(buf, (size_t)s->offset, (size_t)(s->offset + s->size), out);
+    }
+    if(!search) return false;
+    for(const dyn::Section* s : searchable(sections, ".rdata")){
+        const size_t end = (size_t)(s->offset + s->size);
+        for(size_t o = (size_t)s->offset; o + 8 <= end; o += 4){
+            const unsigned char* q = buf.data() + o;
+            const bool le = q[1] == 0xFF && q[2] == 0xFF && q[3] == 0xFF, bigEnd = q[0] == 0xFF && q[1] == 0xFF && q[2] == 0xFF;
+            if((!le && !bigEnd) || q[4] || q[5]) continue;
+            if(parsePclntab(buf, o, end, out)){
+                where = s->name;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+struct PackageRule {
+    const char* algorithm;
+    const char* severity;
+};
+
+const char* const kMed = "med";
+const char* const kLow = "low";
+
+const std::unordered_map<std::string, PackageRule>& packageRules(){
+    static const std::unordered_map<std::string, PackageRule> rules = {
+        { "crypto/md5", { "MD5", kMed } },
+        { "crypto/sha1", { "SHA", kMed } },
+        { "crypto/des", { "3DES", kMed } },
+        { "crypto/rc4", { "RC4", kMed } },
+        { "crypto/dsa", { "DSA", kMed } },
+        { "crypto/rsa", { "RSA", kLow } },
+        { "crypto/ecdsa", { "ECC/ECDSA/ECDH", kLow } },
+        { "crypto/ecdh", { "ECC/ECDSA/ECDH", kLow } },
+        { "crypto/elliptic", { "ECC/ECDSA/ECDH", kLow } },
+        { "crypto/ed25519", { "X25519/Ed25519", kLow } },
+        { "crypto/aes", { "AES-128/modes", kLow } },
+        { "crypto/cipher", { "AES-128/modes", kLow } },
+        { "crypto/sha256", { "SHA", kLow } },
+        { "crypto/sha512", { "SHA", kLow } },
+        { "golang.org/x/crypto/md4", { "MD2/MD4", kMed } },
+        { "golang.org/x/crypto/ripemd160", { "RIPEMD-160", kMed } },
+        { "golang.org/x/crypto/cast5", { "CAST5", kMed } },
+        { "golang.org/x/crypto/tea", { "TEA/XTEA", kMed } },
+        { "golang.org/x/crypto/xtea", { "TEA/XTEA", kMed } },
+        { "golang.org/x/crypto/openpgp", { "OpenPGP (deprecated x/crypto)", kMed } },
+        { "golang.org/x/crypto/otr", { "OTR", kMed } },
+        { "golang.org/x/crypto/pkcs12", { "PKCS#12 (RC2/3DES)", kMed } },
+        { "golang.org/x/crypto/blowfish", { "Blowfish/bcrypt", kLow } },
+        { "golang.org/x/crypto/bcrypt", { "Blowfish/bcrypt", kLow } },
+        { "golang.org/x/crypto/twofish", { "Twofish", kLow } },
+        { "golang.org/x/crypto/salsa20", { "Salsa20", kLow } },
+        { "golang.org/x/crypto/chacha20", { "ChaCha20-Poly1305", kLow } },
+        { "golang.org/x/crypto/chacha20poly1305", { "ChaCha20-Poly1305", kLow } },
+        { "golang.org/x/crypto/curve25519", { "X25519/Ed25519", kLow } },
+        { "golang.org/x/crypto/ed25519", { "X25519/Ed25519", kLow } },
+        { "golang.org/x/crypto/sha3", { "SHA-3", kLow } },
+        { "golang.org/x/crypto/blake2b", { "BLAKE2", kLow } },
+        { "golang.org/x/crypto/blake2s", { "BLAKE2", kLow } },
+        { "golang.org/x/crypto/argon2", { "Argon2", kLow } },
+        { "golang.org/x/crypto/scrypt", { "scrypt", kLow } },
+        { "golang.org/x/crypto/pbkdf2", { "PBKDF2", kLow } },
+        { "golang.org/x/crypto/hkdf", { "HKDF", kLow } },
+        { "golang.org/x/crypto/nacl", { "NaCl box/secretbox", kLow } },
+        { "golang.org/x/crypto/ssh", { "SSH", kLow } },
+    };
+    return rules;
+}
+
+const std::unordered_map<std::string, PackageRule>& moduleRules(){
+    static const std::unordered_map<std::string, PackageRule> rules = {
+        { "golang.org/x/crypto", { "Go crypto module", kLow } },
+        { "github.com/ProtonMail/go-crypto", { "Go crypto module", kLow } },
+        { "github.com/cloudflare/circl", { "Go crypto module", kLow } },
+        { "filippo.io/edwards25519", { "Go crypto module", kLow } },
+        { "github.com/go-jose/go-jose", { "Go crypto module", kLow } },
+        { "gopkg.in/square/go-jose.v2", { "Go crypto module", kLow } },
+        { "github.com/golang-jwt/jwt", { "Go crypto module", kLow } },
+        { "github.com/lestrrat-go/jwx", { "Go crypto module", kLow } },
+        { "github.com/miekg/pkcs11", { "Go crypto module", kLow } },
+        { "software.sslmate.com/src/go-pkcs12", { "Go crypto module", kLow } },
+        { "github.com/dgrijalva/jwt-go", { "Go crypto module (unmaintained)", kMed } },
+    };
+    return rules;
+}
+
+std::string sectionAt(const std::vector<dyn::Section>& sections, size_t off){
+    for(const auto& s : sections){
+        if(off >= s.offset && off - s.offset < s.size) return s.name;
+    }
+    return {};
+}
+
+// Rule of `path` or of its nearest enclosing package or module ("golang.org/x/crypto/ssh/agent",
+// "github.com/golang-jwt/jwt/v5").
+const PackageRule* lookup(const std::unordered_map<std::string, PackageRule>& rules, std::string_view path){
+    while(!path.empty()){
+        auto it = rules.find(std::string(path));
+        if(it != rules.end()) return &it->second;
+        const size_t slash = path.rfind('/');
+        if(slash == std::string_view::npos) break;
+        path = path.substr(0, slash);
+    }
+    return nullptr;
+}
+
+// "crypto/md5" for "crypto/md5.(*digest).Write"; the standard library's vendored copy of
+// x/crypto counts as x/crypto.
+std::string_view packageOf(std::string_view fn){
+    if(fn.rfind("vendor/", 0) == 0) fn.remove_prefix(7);
+    fn = fn.substr(0, fn.find('['));
+    const size_t slash = fn.rfind('/');
+    const size_t dot = fn.find('.', slash == std::string_view::npos ? 0 : slash + 1);
+    return dot == std::string_view::npos ? std::string_view() : fn.substr(0, dot);
+}
+
+}
+
+bool GoBinaryScanner::readBuildInfo(const std::vector<unsigned char>& buf, const std::vector<dyn::Section>& sections, GoBuildInfo& out){
+    std::vector<const dyn::Section*> where;
+    if(const dyn::Section* s = named(sections, { ".go.buildinfo", "__go_buildinfo" })) where.push_back(s);
+    else where = searchable(sections, ".data");
+    for(const dyn::Section* s : where){
+        const size_t end = (size_t)(s->offset + s->size);
+        // The header is 16-byte aligned in its section.
+        for(size_t o = (size_t)s->offset; o + kBuildInfoHeaderSize <= end; o += 16){
+            if(buf[o] != 0xFF || std::memcmp(buf.data() + o, kBuildInfoMagic, kBuildInfoMagicSize) != 0) continue;
+            if(parseBuildInfo(buf, sections, o, end, out)) return true;
+        }
+    }
+    return false;
+}
+
+bool GoBinaryScanner::readFunctions(const std::vector<unsigned char>& buf, const std::vector<dyn::Section>& sections, std::vector<GoFunction>& out){
+    std::string where;
+    return findPclntab(buf, sections, true, out, where);
+}
+
+std::vector<Detection> GoBinaryScanner::scan(const std::string& displayName,
+                                             const std::vector<unsigned char>& buf,
+                                             const std::vector<dyn::Section>& sections,
+                                             bool& isGo)
+{
+    std::vector<Detection> out;
+    isGo = false;
+    GoBuildInfo info;
+    const bool haveInfo = readBuildInfo(buf, sections, info);
+    std::vector<GoFunction> funcs;
+    std::string where;
+    // Searching PE sections or bare segments for a pclntab is only worth it in a Go binary.
+    isGo = findPclntab(buf, sections, haveInfo, funcs, where);
+
+    struct Package {
+        const PackageRule* rule;
+        size_t functions;
+        size_t offset;
+    };
+    std::map<std::string_view, Package> linked;
+    for(const auto& f : funcs){
+        const std::string_view pkg = packageOf(f.name);
+        if(pkg.empty()) continue;
+        auto it = linked.find(pkg);
+        if(it != linked.end()){ it->second.functions++; continue; }
+        if(const PackageRule* r = lookup(packageRules(), pkg)) linked.emplace(pkg, Package{ r, 1, f.offset });
+    }
+    for(const auto& kv : linked){
+        const Package& p = kv.second;
+        out.push_back({ displayName, p.offset, p.rule->algorithm, std::string(kv.first) + " (" + std::to_string(p.functions) + (p.functions == 1 ? " function)" : " functions)"),
+                        "pclntab", p.rule->severity, where });
+    }
+    const std::string infoSection = haveInfo ? sectionAt(sections, info.offset) : std::string();
+    for(const auto& m : info.deps){
+        const PackageRule* r = lookup(moduleRules(), m.path);
+        if(!r) continue;
+        std::string shown = m.path + " " + m.version;
+        if(!m.replacement.empty()) shown += " => " + m.replacement;
+        out.push_back({ displayName, m.offset, r->algorithm, shown, "buildinfo", r->severity, infoSection });
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CryptoScanner.h"
+#include "DynLinkParser.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace analyzers {
+
+struct GoModule {
+    std::string path;
+    std::string version;
+    std::string sum;
+    std::string replacement;    // "path version" of a "=>" line, empty when not replaced
+    size_t offset = 0;          // file offset of the module's line
+};
+
+// What `go version -m` prints: the toolchain, the main module, its dependencies and the build
+// settings, decoded from the blob behind the "\xff Go buildinf:" header.
+struct GoBuildInfo {
+    std::string goVersion;
+    std::string path;                   // main package
+    GoModule main;
+    std::vector<GoModule> deps;
+    std::vector<std::string> settings;  // "key=value"
+    size_t offset = 0;                  // file offset of the header
+};
+
+struct GoFunction {
+    std::string_view name;      // into the buffer
+    size_t offset = 0;          // file offset of the name
+};
+
+// Go binaries are statically linked, so nothing crypto-related shows up in their imports, and
+// their rodata is too large and too full of identifiers for the text patterns to be useful.
+// Instead the linker's own tables are read: the build info lists module dependencies, and the
+// pclntab (runtime function table, layouts of Go 1.2, 1.16, 1.18 and 1.20) names every function
+// that survived dead-code elimination, hence every package that is actually linked in. Sections
+// are looked up by name in ELF (.go.buildinfo, .gopclntab) and searched for the headers in PE
+// (.data, .rdata) and in section-less ELF (PT_LOAD segments).
+class GoBinaryScanner {
+public:
+    // `sections` are the ELF sections (or segments) or the PE sections of `buf`.
+    static bool readBuildInfo(const std::vector<unsigned char>& buf, const std::vector<dyn::Section>& sections, GoBuildInfo& out);
+    static bool readFunctions(const std::vector<unsigned char>& buf, const std::vector<dyn::Section>& sections, std::vector<GoFunction>& out);
+
+    // Findings for crypto packages linked into the binary and crypto modules it depends on.
+    // `isGo` is set when a pclntab was found, in which case the result is complete without the
+    // text pattern pass.
+    static std::vector<Detection> scan(const std::string& displayName,
+                                       const std::vector<unsigned char>& buf,
+                                       const std::vector<dyn::Section>& sections,
+                                       bool& isGo);
+};
+
+}
@@ -0,0 +1,494 @@
+#include "InsnScanner.h"
+
+#include "DynLinkParser.h"
+
+#include <algorithm>
+#include <map>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define INSN_SCANNER_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define INSN_SCANNER_NEON 1
+#endif
+
+namespace analyzers {
+
+namespace {
+
+enum class Isa { None, X86, X64, A64 };
+
+enum Family { kAes, kSha1, kSha256, kSha512, kClmul, kFamilies };
+
+const char* familyName(Isa isa, int f){
+    static const char* const kX86[kFamilies] = { "AES-NI", "SHA-NI (SHA-1)", "SHA-NI (SHA-256)", "", "PCLMULQDQ" };
+    static const char* const kA64[kFamilies] = { "ARMv8 AES", "ARMv8 SHA-1", "ARMv8 SHA-256", "ARMv8 SHA-512", "ARMv8 PMULL" };
+    return isa == Isa::A64 ? kA64[f] : kX86[f];
+}
+
+// Distance a linear sweep starts before a candidate that no function symbol covers; x86 code
+// resynchronizes within a few instructions.
+const std::size_t kSweepBack = 64;
+// Hits of one family closer than this are reported together when there are no symbols.
+const std::uint64_t kClusterGap = 4096;
+
+struct Hit {
+    std::size_t offset;
+    std::size_t len;
+    int family;
+    const char* mnemonic;
+};
+
+struct Region {
+    std::size_t from, to;
+    std::uint64_t addr;
+    const std::string* name;
+};
+
+// Calls f(pos) for every pos in [from, to) whose byte is one of set[0..3] (repeat a byte to
+// look for fewer).
+template <class F>
+void forEachByte(const unsigned char* p, std::size_t from, std::size_t to, const unsigned char (&set)[4], F&& f){
+    std::size_t pos = from;
+#if defined(INSN_SCANNER_SSE2)
+    const __m128i s0 = _mm_set1_epi8((char)set[0]), s1 = _mm_set1_epi8((char)set[1]);
+    const __m128i s2 = _mm_set1_epi8((char)set[2]), s3 = _mm_set1_epi8((char)set[3]);
+    for(; pos + 16 <= to; pos += 16){
+        const __m128i v = _mm_loadu_si128((const __m128i*)(p + pos));
+        const __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, s0), _mm_cmpeq_epi8(v, s1)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(v, s2), _mm_cmpeq_epi8(v, s3)));
+        unsigned bits = (unsigned)_mm_movemask_epi8(m);
+        while(bits){
+            f(pos + (std::size_t)__builtin_ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+#elif defined(INSN_SCANNER_NEON)
+    const uint8x16_t s0 = vdupq_n_u8(set[0]), s1 = vdupq_n_u8(set[1]), s2 = vdupq_n_u8(set[2]), s3 = vdupq_n_u8(set[3]);
+    for(; pos + 16 <= to; pos += 16){
+        const uint8x16_t v = vld1q_u8(p + pos);
+        const uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, s0), vceqq_u8(v, s1)), vorrq_u8(vceqq_u8(v, s2), vceqq_u8(v, s3)));
+        if(vmaxvq_u8(m) == 0) continue;
+        for(std::size_t i = 0; i < 16; ++i){
+            const unsigned char c = p[pos + i];
+            if(c == set[0] || c == set[1] || c == set[2] || c == set[3]) f(pos + i);
+        }
+    }
+#endif
+    for(; pos < to; ++pos){
+        const unsigned char c = p[pos];
+        if(c == set[0] || c == set[1] || c == set[2] || c == set[3]) f(pos);
+    }
+}
+
+// ---- x86 ----
+
+struct X86Insn {
+    std::size_t len = 0;
+    int map = 0;                // 0: one-byte, 1: 0F, 2: 0F 38, 3: 0F 3A, 5/6: EVEX maps
+    unsigned char op = 0;
+    unsigned char pfx = 0;      // mandatory prefix: 0, 0x66, 0xF3 or 0xF2
+    bool vex = false;           // VEX or EVEX encoded
+};
+
+bool isMap2Crypto(unsigned char op){ return (op >= 0xC8 && op <= 0xCD) || (op >= 0xDB && op <= 0xDF); }
+bool isMap3Crypto(unsigned char op){ return op == 0x44 || op == 0xCC || op == 0xDF; }
+
+// Length of the instruction at p (at most n bytes available). Returns false for encodings that
+// are invalid in the mode, truncated, or longer than 15 bytes.
+bool decodeX86(const unsigned char* p, std::size_t n, bool x64, X86Insn& ins){
+    std::size_t i = 0;
+    bool opsz = false, adsz = false, rexW = false;
+    unsigned char rep = 0;
+    for(;; ++i){
+        if(i >= n || i >= 15) return false;
+        const unsigned char b = p[i];
+        if(b == 0x66){ opsz = true; rexW = false; }
+        else if(b == 0x67){ adsz = true; rexW = false; }
+        else if(b == 0xF2 || b == 0xF3){ rep = b; rexW = false; }
+        else if(b == 0xF0 || b == 0x26 || b == 0x2E || b == 0x36 || b == 0x3E || b == 0x64 || b == 0x65) rexW = false;
+        else if(x64 && (b & 0xF0) == 0x40) rexW = (b & 0x08) != 0;
+        else break;
+    }
+    ins = X86Insn();
+    ins.pfx = rep ? rep : (opsz ? 0x66 : 0);
+    const std::size_t z = opsz ? 2 : 4;
+    bool modrm = false;
+    std::size_t imm = 0;
+    unsigned char b = p[i];
+
+    const bool vexLead = (b == 0xC4 || b == 0xC5 || b == 0x62) && i + 1 < n && (x64 || p[i + 1] >= 0xC0);
+    if(vexLead){
+        static const unsigned char kPp[4] = { 0, 0x66, 0xF3, 0xF2 };
+        std::size_t skip;
+        if(b == 0xC5){
+            ins.map = 1; ins.pfx = kPp[p[i + 1] & 3]; skip = 2;
+        }else if(b == 0xC4){
+            if(i + 2 >= n) return false;
+            ins.map = p[i + 1] & 0x1F; ins.pfx = kPp[p[i + 2] & 3]; skip = 3;
+            if(ins.map < 1 || ins.map > 3) return false;
+        }else{
+            if(i + 3 >= n) return false;
+            ins.map = p[i + 1] & 7; ins.pfx = kPp[p[i + 2] & 3]; skip = 4;
+            if(ins.map == 0 || ins.map == 4 || ins.map == 7 || !(p[i + 2] & 0x04)) return false;
+        }
+        i += skip;
+        if(i >= n) return false;
+        ins.vex = true;
+        ins.op = p[i++];
+        modrm = !(ins.map == 1 && ins.op == 0x77);
+        if(ins.map == 3) imm = 1;
+        else if(ins.map == 1 && ((ins.op >= 0x70 && ins.op <= 0x73) || ins.op == 0xC2 || (ins.op >= 0xC4 && ins.op <= 0xC6))) imm = 1;
+    }else if(b == 0x0F){
+        if(++i >= n) return false;
+        b = p[i++];
+        if(b == 0x38 || b == 0x3A){
+            if(i >= n) return false;
+            ins.map = b == 0x38 ? 2 : 3;
+            ins.op = p[i++];
+            modrm = true;
+            imm = ins.map == 3 ? 1 : 0;
+        }else{
+            ins.map = 1;
+            ins.op = b;
+            switch(b >> 4){
+            case 0x0:
+                if(b == 0x04 || b == 0x0A || b == 0x0C) return false;
+                modrm = b <= 0x03 || b == 0x0D || b == 0x0F;
+                if(b == 0x0F) imm = 1;      // 3DNow!: the opcode follows the operands
+                break;
+            case 0x2:
+                if(b >= 0x24 && b <= 0x27) return false;
+                modrm = true;
+                break;
+            case 0x3:
+                if(b == 0x36 || b >= 0x39) return false;
+                break;
+            case 0x7:
+                modrm = b != 0x77;
+                if(b <= 0x73) imm = 1;
+                break;
+            case 0x8:
+                imm = x64 ? 4 : z;
+                break;
+            case 0xA:
+                modrm = !(b <= 0xA2 || (b >= 0xA8 && b <= 0xAA));
+                if(b == 0xA4 || b == 0xAC) imm = 1;
+                break;
+            case 0xB:
+                modrm = true;
+                if(b == 0xBA) imm = 1;
+                break;
+            case 0xC:
+                modrm = b <= 0xC7;
+                if(b == 0xC2 || (b >= 0xC4 && b <= 0xC6)) imm = 1;
+                break;
+            default:
+                modrm = true;
+                break;
+            }
+        }
+    }else{
+        ins.op = b;
+        ++i;
+        const unsigned char o = b;
+        if(o < 0x40){
+            const unsigned lo = o & 7;
+            if(lo < 4) modrm = true;
+            else if(lo == 4) imm = 1;
+            else if(lo == 5) imm = z;
+            else if(x64) return false;      // push/pop segment, BCD adjust
+        }else if(o < 0x60){
+            // inc/dec (32-bit), push/pop
+        }else if(o < 0x70){
+            switch(o){
+            case 0x60: case 0x61: if(x64) return false; break;
+            case 0x62: if(x64) return false; modrm = true; break;
+            case 0x63: modrm = true; break;
+            case 0x68: imm = z; break;
+            case 0x69: modrm = true; imm = z; break;
+            case 0x6A: imm = 1; break;
+            case 0x6B: modrm = true; imm = 1; break;
+            default: break;
+            }
+        }else if(o < 0x80){
+            imm = 1;
+        }else if(o < 0x90){
+            modrm = true;
+            if(o == 0x80 || o == 0x83) imm = 1;
+            else if(o == 0x81) imm = z;
+            else if(o == 0x82){ if(x64) return false; imm = 1; }
+        }else if(o < 0xA0){
+            if(o == 0x9A){ if(x64) return false; imm = z + 2; }
+        }else if(o < 0xB0){
+            if(o <= 0xA3) imm = x64 ? (adsz ? 4 : 8) : (adsz ? 2 : 4);
+            else if(o == 0xA8) imm = 1;
+            else if(o == 0xA9) imm = z;
+        }else if(o < 0xC0){
+            imm = o < 0xB8 ? 1 : (rexW ? 8 : z);
+        }else if(o < 0xD0){
+            switch(o){
+            case 0xC0: case 0xC1: case 0xC6: modrm = true; imm = 1; break;
+            case 0xC2: case 0xCA: imm = 2; break;
+            case 0xC4: case 0xC5: if(x64) return false; modrm = true; break;
+            case 0xC7: modrm = true; imm = z; break;
+            case 0xC8: imm = 3; break;
+            case 0xCD: imm = 1; break;
+            case 0xCE: if(x64) return false; break;
+            default: break;
+            }
+        }else if(o < 0xE0){
+            if(o <= 0xD3 || o >= 0xD8) modrm = true;
+            else if(o == 0xD4 || o == 0xD5){ if(x64) return false; imm = 1; }
+            else if(o == 0xD6 && x64) return false;
+        }else if(o < 0xF0){
+            if(o <= 0xE7 || o == 0xEB) imm = 1;
+            else if(o == 0xE8 || o == 0xE9) imm = x64 ? 4 : z;
+            else if(o == 0xEA){ if(x64) return false; imm = z + 2; }
+        }else{
+            modrm = o == 0xF6 || o == 0xF7 || o == 0xFE || o == 0xFF;
+        }
+    }
+
+    if(modrm){
+        if(i >= n) return false;
+        const unsigned char m = p[i++];
+        const unsigned mod = m >> 6, rm = m & 7, reg = (m >> 3) & 7;
+        if(!ins.vex && ins.map == 0){
+            if(reg < 2 && ins.op == 0xF6) imm = 1;
+            else if(reg < 2 && ins.op == 0xF7) imm = z;
+            // Undefined group members; data embedded in code tends to run into them.
+            if((ins.op == 0xC6 || ins.op == 0xC7) && reg != 0 && m != 0xF8) return false;
+            if((ins.op == 0x8F && reg != 0) || (ins.op == 0x8D && mod == 3)) return false;
+            if((ins.op == 0xFE && reg > 1) || (ins.op == 0xFF && reg == 7)) return false;
+        }
+        if(mod != 3){
+            if(!x64 && adsz){
+                if(mod == 0 && rm == 6) i += 2;
+                else if(mod == 1) i += 1;
+                else if(mod == 2) i += 2;
+            }else{
+                if(rm == 4){
+                    if(i >= n) return false;
+                    if((p[i++] & 7) == 5 && mod == 0) i += 4;
+                }else if(mod == 0 && rm == 5){
+                    i += 4;
+                }
+                if(mod == 1) i += 1;
+                else if(mod == 2) i += 4;
+            }
+        }
+    }
+    i += imm;
+    if(i > n || i > 15) return false;
+    ins.len = i;
+    return true;
+}
+
+const char* x86Crypto(const X86Insn& ins, int& family){
+    if(ins.map == 2 && ins.pfx == 0x66){
+        family = kAes;
+        switch(ins.op){
+        case 0xDB: return ins.vex ? "vaesimc" : "aesimc";
+        case 0xDC: return ins.vex ? "vaesenc" : "aesenc";
+        case 0xDD: return ins.vex ? "vaesenclast" : "aesenclast";
+        case 0xDE: return ins.vex ? "vaesdec" : "aesdec";
+        case 0xDF: return ins.vex ? "vaesdeclast" : "aesdeclast";
+        default: break;
+        }
+    }else if(ins.map == 2 && ins.pfx == 0 && !ins.vex){
+        family = ins.op <= 0xCA ? kSha1 : kSha256;
+        switch(ins.op){
+        case 0xC8: return "sha1nexte";
+        case 0xC9: return "sha1msg1";
+        case 0xCA: return "sha1msg2";
+        case 0xCB: return "sha256rnds2";
+        case 0xCC: return "sha256msg1";
+        case 0xCD: return "sha256msg2";
+        default: break;
+        }
+    }else if(ins.map == 3 && ins.pfx == 0x66){
+        if(ins.op == 0xDF){ family = kAes; return ins.vex ? "vaeskeygenassist" : "aeskeygenassist"; }
+        if(ins.op == 0x44){ family = kClmul; return ins.vex ? "vpclmulqdq" : "pclmulqdq"; }
+    }else if(ins.map == 3 && ins.pfx == 0 && !ins.vex && ins.op == 0xCC){
+        family = kSha1;
+        return "sha1rnds4";
+    }
+    return nullptr;
+}
+
+bool x86Candidate(const unsigned char* p, std::size_t q, std::size_t to){
+    const unsigned char b = p[q];
+    if(b == 0x0F){
+        if(q + 2 >= to) return false;
+        return (p[q + 1] == 0x38 && isMap2Crypto(p[q + 2])) || (p[q + 1] == 0x3A && isMap3Crypto(p[q + 2]));
+    }
+    const std::size_t opAt = b == 0x62 ? 4 : 3;
+    if(q + opAt >= to) return false;
+    const unsigned map = b == 0x62 ? (p[q + 1] & 7) : (p[q + 1] & 0x1F);
+    return (map == 2 && isMap2Crypto(p[q + opAt])) || (map == 3 && isMap3Crypto(p[q + opAt]));
+}
+
+// Decodes [from, to) and records crypto instructions; with `cover` set, only the one spanning it.
+// Returns where decoding stopped, an instruction boundary the next sweep can resume from.
+std::size_t sweepX86(const unsigned char* p, std::size_t from, std::size_t to, bool x64, std::size_t cover, std::vector<Hit>& out){
+    std::size_t pos = from;
+    while(pos < to){
+        X86Insn ins;
+        if(!decodeX86(p + pos, to - pos, x64, ins)){ ++pos; continue; }
+        int family = 0;
+        const char* name = x86Crypto(ins, family);
+        if(name && (cover == SIZE_MAX || (pos <= cover && cover < pos + ins.len))){
+            if(out.empty() || out.back().offset < pos) out.push_back({ pos, ins.len, family, name });
+        }
+        if(cover != SIZE_MAX && pos > cover) break;
+        pos += ins.len;
+    }
+    return pos;
+}
+
+// ---- AArch64 ----
+
+struct A64Op {
+    std::uint32_t mask, value;
+    const char* name;
+    int family;
+};
+
+const A64Op kA64Ops[] = {
+    { 0xFFFFFC00, 0x4E284800, "aese", kAes },
+    { 0xFFFFFC00, 0x4E285800, "aesd", kAes },
+    { 0xFFFFFC00, 0x4E286800, "aesmc", kAes },
+    { 0xFFFFFC00, 0x4E287800, "aesimc", kAes },
+    { 0xFFE0FC00, 0x5E000000, "sha1c", kSha1 },
+    { 0xFFE0FC00, 0x5E001000, "sha1p", kSha1 },
+    { 0xFFE0FC00, 0x5E002000, "sha1m", kSha1 },
+    { 0xFFE0FC00, 0x5E003000, "sha1su0", kSha1 },
+    { 0xFFFFFC00, 0x5E280800, "sha1h", kSha1 },
+    { 0xFFFFFC00, 0x5E281800, "sha1su1", kSha1 },
+    { 0xFFE0FC00, 0x5E004000, "sha256h", kSha256 },
+    { 0xFFE0FC00, 0x5E005000, "sha256h2", kSha256 },
+    { 0xFFE0FC00, 0x5E006000, "sha256su1", kSha256 },
+    { 0xFFFFFC00, 0x5E282800, "sha256su0", kSha256 },
+    { 0xFFE0FC00, 0xCE608000, "sha512h", kSha512 },
+    { 0xFFE0FC00, 0xCE608400, "sha512h2", kSha512 },
+    { 0xFFE0FC00, 0xCE608800, "sha512su1", kSha512 },
+    { 0xFFFFFC00, 0xCEC08000, "sha512su0", kSha512 },
+    { 0xFFE0FC00, 0x0EE0E000, "pmull", kClmul },
+    { 0xFFE0FC00, 0x4EE0E000, "pmull2", kClmul },
+};
+
+void scanA64(const unsigned char* p, const Region& r, std::vector<Hit>& out){
+    static const unsigned char kTop[4] = { 0x0E, 0x4E, 0x5E, 0xCE };
+    // Instructions are always little-endian, so the opcode's top byte is the fourth one.
+    forEachByte(p, r.from + 3, r.to, kTop, [&](std::size_t q){
+        const std::size_t at = q - 3;
+        if((r.addr + (at - r.from)) & 3) return;
+        const std::uint32_t w = (std::uint32_t)p[at] | ((std::uint32_t)p[at + 1] << 8) | ((std::uint32_t)p[at + 2] << 16) | ((std::uint32_t)p[at + 3] << 24);
+        for(const auto& op : kA64Ops){
+            if((w & op.mask) == op.value){ out.push_back({ at, 4, op.family, op.name }); break; }
+        }
+    });
+}
+
+Isa isaOf(const std::vector<unsigned char>& buf){
+    std::uint16_t m = dyn::elfMachine(buf);
+    if(m == 3) return Isa::X86;
+    if(m == 62) return Isa::X64;
+    if(m == 183) return Isa::A64;
+    m = dyn::peMachine(buf);
+    if(m == 0x14C) return Isa::X86;
+    if(m == 0x8664) return Isa::X64;
+    if(m == 0xAA64) return Isa::A64;
+    return Isa::None;
+}
+
+}
+
+std::vector<InsnFinding> InsnScanner::scan(const std::vector<unsigned char>& buf){
+    std::vector<InsnFinding> out;
+    const Isa isa = isaOf(buf);
+    if(isa == Isa::None) return out;
+    const bool elf = dyn::isELF(buf);
+    const std::vector<dyn::Section> sections = elf ? dyn::parseELFSections(buf) : dyn::parsePESections(buf);
+    const std::vector<dyn::FunctionSymbol> funcs = elf ? dyn::parseELFFunctions(buf, sections) : std::vector<dyn::FunctionSymbol>();
+    const unsigned char* p = buf.data();
+    std::vector<std::map<std::string, std::size_t>> counts;
+    std::vector<std::uint64_t> lastAddr;
+
+    for(const auto& sec : sections){
+        if(!(elf ? dyn::isELFCodeSection(sec) : dyn::isPECodeSection(sec))) continue;
+        const Region r{ (std::size_t)sec.offset, (std::size_t)(sec.offset + sec.size), sec.addr, &sec.name };
+        std::vector<Hit> hits;
+        if(isa == Isa::A64){
+            scanA64(p, r, hits);
+        }else{
+            static const unsigned char kLead[4] = { 0x0F, 0xC4, 0x62, 0x0F };
+            std::vector<std::size_t> cands;
+            forEachByte(p, r.from, r.to, kLead, [&](std::size_t q){ if(x86Candidate(p, q, r.to)) cands.push_back(q); });
+            // Decoding restarted a little before a candidate can fall out of step on dense code, so a
+            // window sweep picks up where the previous one stopped whenever that is close enough.
+            std::size_t sweptTo = 0, synced = r.from;
+            for(std::size_t c : cands){
+                if(c < sweptTo) continue;
+                auto f = std::upper_bound(funcs.begin(), funcs.end(), (std::uint64_t)c,
+                                          [](std::uint64_t off, const dyn::FunctionSymbol& s){ return off < s.offset; });
+                if(f != funcs.begin() && c < (--f)->offset + f->size && f->offset >= r.from){
+                    const std::size_t end = (std::size_t)std::min<std::uint64_t>(f->offset + f->size, r.to);
+                    synced = sweepX86(p, (std::size_t)f->offset, end, isa == Isa::X64, SIZE_MAX, hits);
+                    sweptTo = end;
+                }else{
+                    std::size_t from = c - r.from > kSweepBack ? c - kSweepBack : r.from;
+                    if(synced >= from && synced <= c) from = synced;
+                    synced = sweepX86(p, from, std::min(r.to, c + 16), isa == Isa::X64, c, hits);
+                }
+            }
+        }
+        if(hits.empty()) continue;
+
+        // Group by function and family, or by family and proximity without symbols.
+        auto funcOf = [&](std::size_t off) -> const dyn::FunctionSymbol* {
+            auto f = std::upper_bound(funcs.begin(), funcs.end(), (std::uint64_t)off,
+                                      [](std::uint64_t o, const dyn::FunctionSymbol& s){ return o < s.offset; });
+            if(f == funcs.begin()) return nullptr;
+            --f;
+            return off < f->offset + f->size ? &*f : nullptr;
+        };
+        std::map<std::pair<const dyn::FunctionSymbol*, int>, std::size_t> open;
+        for(const auto& h : hits){
+            const dyn::FunctionSymbol* fn = funcOf(h.offset);
+            const std::uint64_t addr = r.addr + (h.offset - r.from);
+            auto key = std::make_pair(fn, h.family);
+            auto it = open.find(key);
+            if(it != open.end() && !fn && addr - lastAddr[it->second] > kClusterGap){
+                open.erase(it);
+                it = open.end();
+            }
+            if(it == open.end()){
+                InsnFinding f;
+                f.family = familyName(isa, h.family);
+                f.section = sec.name;
+                f.offset = h.offset;
+                if(fn){
+                    f.function = fn->name;
+                    f.startAddr = fn->addr;
+                    f.endAddr = fn->addr + fn->size;
+                }else{
+                    f.startAddr = addr;
+                }
+                it = open.emplace(key, out.size()).first;
+                out.push_back(std::move(f));
+                counts.resize(out.size());
+                lastAddr.resize(out.size());
+            }
+            ++counts[it->second][h.mnemonic];
+            lastAddr[it->second] = addr;
+            if(!fn) out[it->second].endAddr = addr + h.len;
+        }
+    }
+    for(std::size_t i = 0; i < out.size(); ++i) out[i].mnemonics.assign(counts[i].begin(), counts[i].end());
+    return out;
+}
+
+}
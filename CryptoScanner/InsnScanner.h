@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace analyzers {
+
+// Hardware crypto instructions of one family found in one function (or, without symbols, in one
+// cluster of nearby hits).
+struct InsnFinding {
+    std::string family;
+    std::string function;       // empty when no symbol covers the hits
+    std::string section;
+    std::uint64_t startAddr = 0;
+    std::uint64_t endAddr = 0;  // function range, or the span of the hits
+    std::size_t offset = 0;     // file offset of the first hit
+    std::vector<std::pair<std::string, std::size_t>> mnemonics;
+};
+
+// In-process scan of the executable sections of ELF and PE files for AES-NI, SHA-NI and
+// PCLMULQDQ (x86, legacy and VEX/EVEX forms) and for the ARMv8 AES, SHA-1, SHA-256, SHA-512 and
+// PMULL instructions. Escape and VEX/EVEX lead bytes (x86) or crypto opcode top bytes (AArch64)
+// are located 16 bytes at a time; an x86 candidate only counts if a length decoder, run from
+// the start of the enclosing function or from a little before the candidate, lands on it as an
+// instruction boundary. AArch64 candidates must be 4-byte aligned.
+class InsnScanner {
+public:
+    static std::vector<InsnFinding> scan(const std::vector<unsigned char>& buf);
+};
+
+}
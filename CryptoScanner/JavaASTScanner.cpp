@@ -3,103 +3,109 @@
 #include <string>
 #include <vector>
 #include <cctype>
-#include <cstring>
-#include <tree_sitter/api.h>
-
-extern "C" const TSLanguage *tree_sitter_java();
+#include "ParserPool.h"
 
 namespace {
 
-std::string trim(const std::string& s){
+const char* const kCallQuery = "(method_invocation arguments: (argument_list) @args) @call";
+
+std::string_view trim(std::string_view s){
     size_t i=0,j=s.size();
     while(i<j && std::isspace((unsigned char)s[i]))++i;
     while(j>i && std::isspace((unsigned char)s[j-1]))--j;
     return s.substr(i,j-i);
 }
 
-std::string node_text(TSNode n, const std::string& src){
-    uint32_t a=ts_node_start_byte(n), b=ts_node_end_byte(n);
-    if(b>src.size()) b=(uint32_t)src.size();
-    if(a>b) a=b;
-    return std::string(src.data()+a, src.data()+b);
-}
-
-std::string callee_from_segment(const std::string& seg){
-    auto p = seg.find('(');
-    if(p==std::string::npos) return trim(seg);
-    return trim(seg.substr(0,p));
-}
-
-std::pair<bool,std::string> first_arg_literal_from_segment(const std::string& seg){
-    auto p = seg.find('(');
-    if(p==std::string::npos) return {false,{}};
-    size_t i=p+1;
-    while(i<seg.size() && std::isspace((unsigned char)seg[i])) ++i;
-    if(i>=seg.size()) return {false,{}};
-    if(seg[i]=='"' || seg[i]=='\''){
-        char q=seg[i++];
+std::string first_arg_value(std::string_view a){
+    if(a.empty()) return {};
+    size_t i=0;
+    if(a[i]=='"' || a[i]=='\''){
+        char q=a[i++];
         std::string v;
-        while(i<seg.size()){
-            char c=seg[i++];
-            if(c=='\\' && i<seg.size()){ v.push_back(seg[i++]); continue; }
-            if(c==q) return {true,v};
+        while(i<a.size()){
+            char c=a[i++];
+            if(c=='\\' && i<a.size()){ v.push_back(a[i++]); continue; }
+            if(c==q) return v;
             v.push_back(c);
         }
-        return {false,{}};
+        return {};
     }
     size_t j=i;
-    while(j<seg.size() && (std::isalnum((unsigned char)seg[j]) || seg[j]=='_')) ++j;
-    if(j>i) return {true, seg.substr(i, j-i)};
-    return {false,{}};
+    while(j<a.size() && (std::isalnum((unsigned char)a[j]) || a[j]=='_')) ++j;
+    return std::string(a.substr(i, j-i));
+}
+
+std::string arg_value(std::string_view a){
+    if(!a.empty() && a.front()=='"') return first_arg_value(a);
+    return std::string(a);
 }
 
 }
 
 namespace analyzers {
 
-std::vector<AstSymbol> JavaASTScanner::collectSymbols(const std::string& displayPath, const std::string& code){
+std::vector<AstSymbol> JavaASTScanner::collectSymbols(const std::string& path, const CallSiteFilter& keep){
+    MappedFile src;
+    if(!src.open(path)) return {};
+    return collectSymbols(path, src.view(), keep);
+}
+
+std::vector<AstSymbol> JavaASTScanner::collectSymbols(const std::string& displayPath, std::string_view code, const CallSiteFilter& keep){
+    if(code.empty()) return {};
+    TSTree* tree = ParserPool::parse(SourceLang::Java, code);
+    if(!tree) return {};
+    std::vector<AstSymbol> out = collectFromTree(displayPath, code, tree, 0, UINT32_MAX, keep);
+    ts_tree_delete(tree);
+    return out;
+}
+
+std::vector<AstSymbol> JavaASTScanner::collectFromTree(const std::string& displayPath, std::string_view code, const TSTree* tree,
+                                                       uint32_t fromByte, uint32_t toByte, const CallSiteFilter& keep){
     std::vector<AstSymbol> out;
-    if(code.empty()) return out;
-
-    TSParser* parser = ts_parser_new();
-    ts_parser_set_language(parser, tree_sitter_java());
-    TSTree* tree = ts_parser_parse_string(parser, nullptr, code.c_str(), (uint32_t)code.size());
-    if(!tree){ ts_parser_delete(parser); return out; }
-
-    TSNode root = ts_tree_root_node(tree);
-    std::vector<TSNode> stack; stack.push_back(root);
-
-    while(!stack.empty()){
-        TSNode n = stack.back(); stack.pop_back();
-        const char* t = ts_node_type(n);
-
-        if(std::strcmp(t,"method_invocation")==0){
-            std::string seg = node_text(n, code);
-            std::string callee = callee_from_segment(seg);
-            auto ar = first_arg_literal_from_segment(seg);
-            TSPoint p = ts_node_start_point(n);
-            size_t line = (size_t)p.row + 1;
-            AstSymbol s;
-            s.filePath = displayPath;
-            s.line = line;
-            s.lang = "java";
-            s.callee_full = callee;
-            s.callee_base = callee;
-            s.first_arg = ar.first ? ar.second : std::string();
-            out.push_back(std::move(s));
+    if(!tree) return out;
+
+    static const TSQuery* query = ParserPool::compileQuery(SourceLang::Java, kCallQuery);
+    if(!query) return out;
+    static const uint32_t capCall = ParserPool::captureIndex(query, "call");
+    static const uint32_t capArgs = ParserPool::captureIndex(query, "args");
+
+    TSQueryCursor* cur = ParserPool::cursor();
+    ts_query_cursor_set_byte_range(cur, fromByte, toByte);
+    ts_query_cursor_exec(cur, query, ts_tree_root_node(tree));
+    TSQueryMatch m;
+    while(ts_query_cursor_next_match(cur, &m)){
+        TSNode call{}, args{};
+        for(uint16_t i=0;i<m.capture_count;++i){
+            if(m.captures[i].index==capCall) call = m.captures[i].node;
+            else if(m.captures[i].index==capArgs) args = m.captures[i].node;
         }
-
-        uint32_t c = ts_node_child_count(n);
-        for(uint32_t i=0;i<c;++i){
-            TSNode ch = ts_node_child(n,i);
-            if(ts_node_is_null(ch)) continue;
-            if(!ts_node_is_named(ch)) continue;
-            stack.push_back(ch);
+        if(ts_node_is_null(call) || ts_node_is_null(args)) continue;
+
+        uint32_t a=ts_node_start_byte(call), b=ts_node_start_byte(args);
+        if(b<a || b>code.size()) continue;
+        std::string_view callee = trim(code.substr(a, b-a));
+        std::string_view arg0;
+        if(ts_node_named_child_count(args)>0) arg0 = trim(nodeView(ts_node_named_child(args, 0), code));
+        if(keep && !keep(callee, arg0)) continue;
+
+        AstSymbol s;
+        s.filePath = displayPath;
+        s.line = (size_t)ts_node_start_point(call).row + 1;
+        s.lang = "java";
+        s.callee_full = std::string(callee);
+        s.callee_base = s.callee_full;
+        s.first_arg = first_arg_value(arg0);
+        uint32_t na = ts_node_named_child_count(args);
+        for(uint32_t i=0;i<na;++i){
+            TSNode a = ts_node_named_child(args, i);
+            if(ts_node_is_extra(a)) continue;
+            s.args.push_back(arg_value(trim(nodeView(a, code))));
         }
+        s.startByte = ts_node_start_byte(call);
+        s.endByte = ts_node_end_byte(call);
+        out.push_back(std::move(s));
     }
 
-    ts_tree_delete(tree);
-    ts_parser_delete(parser);
     return out;
 }
 
@@ -2,14 +2,22 @@
 
 #include "ASTSymbol.h"
 
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+
+struct TSTree;
 
 namespace analyzers {
 
 class JavaASTScanner {
 public:
-    static std::vector<AstSymbol> collectSymbols(const std::string& displayPath, const std::string& code);
+    static std::vector<AstSymbol> collectSymbols(const std::string& path, const CallSiteFilter& keep = {});
+    static std::vector<AstSymbol> collectSymbols(const std::string& displayPath, std::string_view code, const CallSiteFilter& keep = {});
+    // Call sites of an already parsed `code` whose call expression intersects [fromByte, toByte).
+    static std::vector<AstSymbol> collectFromTree(const std::string& displayPath, std::string_view code, const TSTree* tree,
+                                                  std::uint32_t fromByte, std::uint32_t toByte, const CallSiteFilter& keep = {});
 };
 
 }
@@ -1,125 +1,437 @@
 #include "JavaBytecodeScanner.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdint>
-#include <unordered_set>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace analyzers {
 
-static uint16_t rd16(const unsigned char* p){ return (uint16_t)((p[0]<<8)|p[1]); }
-static uint32_t rd32(const unsigned char* p){ return (uint32_t)((p[0]<<24)|(p[1]<<16)|(p[2]<<8)|p[3]); }
+namespace {
 
-static void add(std::vector<Detection>& out, const std::string& file, size_t line,
-                const std::string& alg, const std::string& ev, const std::string& sev){
-    out.push_back({ file, line, alg, ev, "bytecode", sev });
-}
+uint16_t rd16(const unsigned char* p){ return (uint16_t)((p[0]<<8)|p[1]); }
+uint32_t rd32(const unsigned char* p){ return (uint32_t)((p[0]<<24)|(p[1]<<16)|(p[2]<<8)|p[3]); }
 
-std::vector<Detection> JavaBytecodeScanner::scanClassBytes(const std::string& displayName,
-                                                           const std::vector<unsigned char>& buf)
-{
-    std::vector<Detection> out;
-    if(buf.size() < 16) return out;
-    if(rd32(&buf[0]) != 0xCAFEBABE) return out;
-
-    size_t off = 8;
-    if(off+2 > buf.size()) return out;
-    uint16_t cp_count = rd16(&buf[off]); off += 2;
-
-    std::unordered_set<std::string> cp_utf8;
-    std::unordered_set<int32_t> cp_ints;
-
-    for(uint16_t i=1; i<cp_count; ++i){
-        if(off >= buf.size()) break;
-        uint8_t tag = buf[off++];
-
-        switch(tag){
-        case 1: {
-            if(off+2 > buf.size()) return out;
-            uint16_t len = rd16(&buf[off]); off+=2;
-            if(off+len > buf.size()) return out;
-            std::string s((const char*)&buf[off], (size_t)len);
+struct CpEntry {
+    uint8_t tag = 0;
+    uint32_t off = 0;
+    uint16_t a = 0;
+    uint16_t b = 0;
+};
+
+// Constant pool view over the class buffer; Utf8 entries are (offset, length) into it.
+class ClassPool {
+public:
+    bool parse(const unsigned char* p, size_t n){
+        data = p; size = n;
+        if(n < 10 || rd32(p) != 0xCAFEBABE) return false;
+        const uint16_t count = rd16(p + 8);
+        entries.assign(count, CpEntry{});
+        size_t off = 10;
+        for(uint16_t i = 1; i < count; ++i){
+            if(off >= n) return false;
+            CpEntry& e = entries[i];
+            e.tag = p[off++];
+            e.off = (uint32_t)off;
+            size_t len = 0;
+            switch(e.tag){
+                case 1:
+                    if(off + 2 > n) return false;
+                    e.a = rd16(p + off);
+                    len = 2 + (size_t)e.a;
+                    break;
+                case 3: case 4: len = 4; break;
+                case 5: case 6: len = 8; break;
+                case 7: case 8: case 16: case 19: case 20:
+                    if(off + 2 > n) return false;
+                    e.a = rd16(p + off);
+                    len = 2;
+                    break;
+                case 9: case 10: case 11: case 12: case 17: case 18:
+                    if(off + 4 > n) return false;
+                    e.a = rd16(p + off); e.b = rd16(p + off + 2);
+                    len = 4;
+                    break;
+                case 15: len = 3; break;
+                default: return false;
+            }
+            if(off + len > n) return false;
             off += len;
-            cp_utf8.insert(s);
-            break;
+            if(e.tag == 5 || e.tag == 6) ++i;
         }
-        case 3: {
-            if(off+4 > buf.size()) return out;
-            int32_t v = (int32_t)rd32(&buf[off]); off+=4;
-            cp_ints.insert(v);
-            break;
-        }
-        case 5:
-        case 6:
-        {
-            if(off+8 > buf.size()) return out;
-            off+=8;
-            i++;
-            break;
-        }
-        case 7:
-        case 8:
-        case 16:
-        {
-            if(off+2 > buf.size()) return out;
-            off+=2;
-            break;
+        end = off;
+        return true;
+    }
+
+    uint16_t count() const { return (uint16_t)entries.size(); }
+    const CpEntry& at(uint16_t i) const { static const CpEntry none; return i < entries.size() ? entries[i] : none; }
+
+    std::string_view utf8(uint16_t i) const {
+        const CpEntry& e = at(i);
+        if(e.tag != 1) return {};
+        return std::string_view((const char*)data + e.off + 2, e.a);
+    }
+
+    std::string_view className(uint16_t i) const {
+        const CpEntry& e = at(i);
+        return e.tag == 7 ? utf8(e.a) : std::string_view();
+    }
+
+    int32_t integer(uint16_t i) const { return (int32_t)rd32(data + at(i).off); }
+
+    size_t poolEnd() const { return end; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    size_t end = 0;
+    std::vector<CpEntry> entries;
+};
+
+bool isAscii(std::string_view s){
+    for(unsigned char c : s) if(c == 0 || c >= 0x80) return false;
+    return true;
+}
+
+void upperInto(std::string_view s, std::string& out){
+    out.assign(s.data(), s.size());
+    for(auto& c : out) c = (char)std::toupper((unsigned char)c);
+}
+
+std::string oidFromDer(const std::vector<uint8_t>& der){
+    if(der.size() < 3 || der[0] != 0x06 || der[1] + 2u != der.size()) return {};
+    std::string out;
+    uint64_t v = 0;
+    bool first = true;
+    for(size_t i = 2; i < der.size(); ++i){
+        v = (v << 7) | (der[i] & 0x7F);
+        if(der[i] & 0x80) continue;
+        if(first){
+            uint64_t a = v < 40 ? 0 : v < 80 ? 1 : 2;
+            out = std::to_string(a) + "." + std::to_string(v - a * 40);
+            first = false;
+        }else{
+            out += "." + std::to_string(v);
         }
-        case 9:
-        case 10:
-        case 11:
-        case 12:
-        case 18:
-        {
-            if(off+4 > buf.size()) return out;
-            off+=4;
-            break;
+        v = 0;
+    }
+    return out;
+}
+
+const char* const kMed = "med";
+const char* const kLow = "low";
+const char* const kHigh = "high";
+
+// Algorithm literals that make a getInstance call weak, by the call they matter to. A literal
+// counts when it equals the key or starts with the key and a '/' ("DES/ECB/PKCS5Padding").
+enum : unsigned { kWeakDigest = 1, kWeakCipher = 2, kWeakSignature = 4 };
+
+unsigned weakLiteralKind(std::string_view upper){
+    static const std::unordered_map<std::string_view, unsigned> kWeak = {
+        { "MD5", kWeakDigest }, { "SHA1", kWeakDigest }, { "SHA-1", kWeakDigest },
+        { "DES", kWeakCipher }, { "RC4", kWeakCipher },
+        { "MD5WITHRSA", kWeakSignature }, { "SHA1WITHRSA", kWeakSignature }, { "SHA-1WITHRSA", kWeakSignature },
+    };
+    unsigned kind = 0;
+    auto it = kWeak.find(upper.substr(0, upper.find('/')));
+    if(it != kWeak.end()) kind = it->second;
+    if(upper.rfind("AES/ECB", 0) == 0) kind |= kWeakCipher;
+    return kind;
+}
+
+}
+
+std::shared_ptr<const ClassRuleTable> ClassRuleTable::build(const std::vector<BytePattern>& oidBytePatterns){
+    auto t = std::make_shared<ClassRuleTable>();
+    auto tok = [&](std::initializer_list<const char*> keys, const char* alg, const char* sev){
+        for(auto k : keys) t->tokens[k] = ClassRule{ alg, sev, "bytecode" };
+    };
+    tok({"RSA", "RSA-1024", "RSA-2048", "RSA-3072", "RSA-4096", "PKCS1", "RSAES-OAEP", "RSASSA-PSS"}, "RSA", kLow);
+    tok({"EC", "ECC", "ECDSA", "ECDH", "ECIES", "SECP192R1", "SECP224R1", "SECP224K1", "SECP256R1", "SECP256K1", "SECP384R1", "SECP521R1",
+         "P-256", "P-384", "P-521", "PRIME256V1", "BRAINPOOLP256R1", "BRAINPOOLP384R1", "BRAINPOOLP512R1"}, "ECC/ECDSA/ECDH", kLow);
+    tok({"SECT163K1", "SECT163R2", "SECT233K1", "SECT233R1", "SECT283K1", "SECT283R1", "SECT409K1", "SECT409R1", "SECT571K1", "SECT571R1"}, "ECC binary curves sect*", kLow);
+    tok({"DSA", "DSS", "NONEWITHDSA"}, "DSA", kLow);
+    tok({"DH", "DIFFIEHELLMAN", "DIFFIE-HELLMAN"}, "Diffie-Hellman", kLow);
+    tok({"ELGAMAL"}, "ElGamal", kLow);
+    tok({"AES", "AES-128", "AES_128", "AES128", "AESWRAP", "RIJNDAEL", "CBC", "GCM", "CFB", "OFB", "CTR"}, "AES-128/modes", kLow);
+    tok({"ECB"}, "AES-128/modes", kMed);
+    tok({"DES", "DESEDE", "TRIPLEDES", "3DES", "DESEDEWRAP"}, "3DES", kMed);
+    tok({"BLOWFISH"}, "Blowfish/bcrypt", kLow);
+    tok({"RC4", "ARC4", "ARCFOUR"}, "RC4", kMed);
+    tok({"RC2"}, "RC2", kMed);
+    tok({"MD5", "HMACMD5"}, "MD5", kMed);
+    tok({"MD2", "MD4"}, "MD2/MD4", kMed);
+    tok({"SHA-1", "SHA1", "SHA", "HMACSHA1"}, "SHA", kMed);
+    tok({"SHA-224", "SHA224", "SHA-256", "SHA256", "SHA-384", "SHA384", "SHA-512", "SHA512", "HMACSHA256", "HMACSHA384", "HMACSHA512"}, "SHA", kLow);
+    tok({"SEED"}, "SEED", kLow);
+    tok({"ARIA"}, "ARIA", kLow);
+    tok({"HAS160", "HAS-160"}, "HAS-160", kMed);
+    tok({"GOST", "GOST3410", "GOST3411", "GOSTR3410", "GOSTR3411", "ECGOST3410", "STREEBOG"}, "GOST keywords", kLow);
+    tok({"X25519", "ED25519"}, "X25519/Ed25519", kLow);
+    tok({"X448", "ED448"}, "X448/Ed448", kLow);
+
+    auto cls = [&](std::initializer_list<const char*> keys, const char* alg){
+        for(auto k : keys) t->classes[k] = ClassRule{ alg, kLow, "bytecode" };
+    };
+    cls({"org/bouncycastle/jce/provider/BouncyCastleProvider", "org/bouncycastle/jcajce/provider/BouncyCastleFipsProvider"}, "BouncyCastle Provider");
+    cls({"org/bouncycastle/crypto/engines/RSAEngine", "org/bouncycastle/crypto/signers/RSADigestSigner",
+         "org/bouncycastle/crypto/params/RSAKeyParameters", "org/bouncycastle/crypto/params/RSAPrivateCrtKeyParameters"}, "BouncyCastle RSA");
+    cls({"org/bouncycastle/crypto/signers/ECDSASigner", "org/bouncycastle/crypto/params/ECPrivateKeyParameters",
+         "org/bouncycastle/crypto/params/ECPublicKeyParameters", "org/bouncycastle/crypto/params/ECDomainParameters"}, "BouncyCastle EC/ECDSA");
+    cls({"org/bouncycastle/asn1/x9/ECNamedCurveTable", "org/bouncycastle/asn1/x9/X9ECParameters", "org/bouncycastle/asn1/nist/NISTNamedCurves"}, "BouncyCastle Curves");
+    cls({"org/bouncycastle/crypto/engines/AESEngine", "org/bouncycastle/crypto/modes/GCMBlockCipher", "org/bouncycastle/crypto/modes/SICBlockCipher"}, "BouncyCastle AES/GCM");
+    cls({"org/bouncycastle/tls/TlsClient", "org/bouncycastle/tls/TlsServer", "org/bouncycastle/tls/DefaultTlsClient", "org/bouncycastle/tls/DefaultTlsServer"}, "BouncyCastle TLS");
+    cls({"org/bouncycastle/crypto/engines/DESEngine", "org/bouncycastle/crypto/engines/DESedeEngine"}, "3DES");
+    cls({"org/bouncycastle/crypto/engines/RC4Engine"}, "RC4");
+    cls({"org/bouncycastle/crypto/digests/MD5Digest"}, "MD5");
+    cls({"org/bouncycastle/crypto/digests/SHA1Digest"}, "SHA");
+
+    t->ints[65537] = ClassRule{ "RSA exponent 65537", kLow, "bytecode" };
+    t->ints[486662] = ClassRule{ "X25519 A decimal", kLow, "bytecode" };
+    t->ints[156326] = ClassRule{ "X448 A decimal", kLow, "bytecode" };
+
+    for(const auto& bp : oidBytePatterns){
+        if(!(bp.type == "oid" || bp.type == "asn1-oid" || bp.type == "asn1_oid")) continue;
+        std::string dotted = oidFromDer(bp.bytes);
+        if(dotted.empty()) continue;
+        std::string name = bp.name;
+        if(name.rfind("OID DER", 0) == 0) name = "OID dotted" + name.substr(7);
+        t->oids.emplace(dotted, ClassRule{ name, kHigh, "oid" });
+    }
+    return t;
+}
+
+const ClassRule* ClassRuleTable::token(std::string_view upper) const {
+    auto it = tokens.find(upper);
+    return it == tokens.end() ? nullptr : &it->second;
+}
+
+const ClassRule* ClassRuleTable::className(std::string_view internalName) const {
+    auto it = classes.find(std::string(internalName));
+    return it == classes.end() ? nullptr : &it->second;
+}
+
+const ClassRule* ClassRuleTable::oid(std::string_view dotted) const {
+    auto it = oids.find(std::string(dotted));
+    return it == oids.end() ? nullptr : &it->second;
+}
+
+const ClassRule* ClassRuleTable::integer(std::int32_t v) const {
+    auto it = ints.find(v);
+    return it == ints.end() ? nullptr : &it->second;
+}
+
+void ClassRuleTable::literalTokens(std::string_view up, std::vector<std::string_view>& out){
+    out.clear();
+    size_t i = 0;
+    while(i < up.size()){
+        while(i < up.size() && !(std::isalnum((unsigned char)up[i]) || up[i] == '-' || up[i] == '_')) ++i;
+        size_t j = i;
+        while(j < up.size() && (std::isalnum((unsigned char)up[j]) || up[j] == '-' || up[j] == '_')) ++j;
+        if(j > i){
+            const std::string_view w = up.substr(i, j - i);
+            out.push_back(w);
+            size_t s = 0;
+            for(size_t k = 1; k + 3 < w.size(); ++k){
+                size_t jl = w.compare(k, 4, "WITH") == 0 ? 4 : w.compare(k, 3, "AND") == 0 ? 3 : 0;
+                if(!jl || k + jl >= w.size()) continue;
+                out.push_back(w.substr(s, k - s));
+                s = k + jl;
+                k = s;
+            }
+            if(s > 0) out.push_back(w.substr(s));
         }
-        case 15:
-        {
-            if(off+3 > buf.size()) return out;
-            off+=3;
-            break;
+        i = j;
+    }
+}
+
+bool ClassRuleTable::looksLikeDottedOid(std::string_view s){
+    if(s.size() < 5 || !std::isdigit((unsigned char)s[0])) return false;
+    int dots = 0;
+    for(char c : s){
+        if(c == '.') ++dots;
+        else if(!std::isdigit((unsigned char)c)) return false;
+    }
+    return dots >= 2;
+}
+
+std::string JavaBytecodeScanner::decodeModifiedUtf8(std::string_view raw){
+    std::string out;
+    out.reserve(raw.size());
+    auto put = [&](uint32_t cp){
+        if(cp < 0x80) out.push_back((char)cp);
+        else if(cp < 0x800){ out.push_back((char)(0xC0 | (cp >> 6))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+        else if(cp < 0x10000){ out.push_back((char)(0xE0 | (cp >> 12))); out.push_back((char)(0x80 | ((cp >> 6) & 0x3F))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+        else { out.push_back((char)(0xF0 | (cp >> 18))); out.push_back((char)(0x80 | ((cp >> 12) & 0x3F))); out.push_back((char)(0x80 | ((cp >> 6) & 0x3F))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+    };
+    const unsigned char* p = (const unsigned char*)raw.data();
+    const size_t n = raw.size();
+    auto unit3 = [&](size_t i, uint32_t& u){
+        if(i + 2 >= n || (p[i] & 0xF0) != 0xE0 || (p[i+1] & 0xC0) != 0x80 || (p[i+2] & 0xC0) != 0x80) return false;
+        u = ((uint32_t)(p[i] & 0x0F) << 12) | ((uint32_t)(p[i+1] & 0x3F) << 6) | (uint32_t)(p[i+2] & 0x3F);
+        return true;
+    };
+    size_t i = 0;
+    while(i < n){
+        unsigned char c = p[i];
+        if(c < 0x80 && c != 0){ out.push_back((char)c); ++i; continue; }
+        if((c & 0xE0) == 0xC0 && i + 1 < n && (p[i+1] & 0xC0) == 0x80){
+            put(((uint32_t)(c & 0x1F) << 6) | (uint32_t)(p[i+1] & 0x3F));
+            i += 2;
+            continue;
         }
-        default:
-            return out;
+        uint32_t hi = 0, lo = 0;
+        if(unit3(i, hi)){
+            if(hi >= 0xD800 && hi <= 0xDBFF && unit3(i + 3, lo) && lo >= 0xDC00 && lo <= 0xDFFF){
+                put(0x10000 + ((hi - 0xD800) << 10) + (lo - 0xDC00));
+                i += 6;
+            }else{
+                put((hi >= 0xD800 && hi <= 0xDFFF) ? 0xFFFD : hi);
+                i += 3;
+            }
+            continue;
         }
+        put(0xFFFD);
+        ++i;
     }
+    return out;
+}
+
+bool JavaBytecodeScanner::isClassFile(const std::vector<unsigned char>& buf){
+    return buf.size() >= 10 && rd32(buf.data()) == 0xCAFEBABE;
+}
 
-    auto has = [&](const char* s){ return cp_utf8.find(s)!=cp_utf8.end(); };
-    auto hasAlg = [&](std::initializer_list<const char*> alist){
-        for(auto s: alist) if(has(s)) return true;
-        return false;
+std::vector<Detection> JavaBytecodeScanner::scanClassBytes(const std::string& displayName,
+                                                           const std::vector<unsigned char>& buf,
+                                                           const ClassRuleTable& rules)
+{
+    std::vector<Detection> out;
+    ClassPool pool;
+    if(!pool.parse(buf.data(), buf.size())) return out;
+
+    std::set<std::pair<std::string, std::string>> seen;
+    auto emit = [&](size_t off, const ClassRule& r, std::string_view match){
+        if(!seen.insert({ r.algorithm, std::string(match) }).second) return;
+        out.push_back({ displayName, off, r.algorithm, std::string(match), r.evidence, r.severity, "" });
     };
 
-    if( (has("java/security/MessageDigest") || has("java.security.MessageDigest")) &&
-        has("getInstance") &&
-        hasAlg({"MD5","SHA1","SHA-1"}) )
-    {
-        add(out, displayName, 0, "Java: MessageDigest.getInstance(MD5|SHA-1)", "MD5|SHA1", "med");
-    }
+    // Literal text of a Utf8 entry: a view into the class unless it needs Modified UTF-8 decoding.
+    std::string decoded, up;
+    auto literal = [&](uint16_t utf8) -> std::string_view {
+        std::string_view raw = pool.utf8(utf8);
+        if(isAscii(raw)) return raw;
+        decoded = decodeModifiedUtf8(raw);
+        return decoded;
+    };
+
+    std::vector<std::string_view> toks;
+    uint16_t kpgInit = 0;
+    // Methodref index -> the weak-literal kind its getInstance(String...) call is checked for.
+    std::vector<unsigned> getInstanceKind(pool.count(), 0);
 
-    if( (has("javax/crypto/Cipher") || has("javax.crypto.Cipher")) &&
-        has("getInstance") &&
-        hasAlg({"DES/ECB","RC4","AES/ECB"}) )
-    {
-        add(out, displayName, 0, "Java: Cipher.getInstance(DES/ECB|RC4|AES/ECB)", "modes", "high");
+    for(uint16_t i = 1; i < pool.count(); ++i){
+        const CpEntry& e = pool.at(i);
+        switch(e.tag){
+            case 8: {
+                if(pool.utf8(e.a).empty() || pool.utf8(e.a).size() > 512) break;
+                const std::string_view text = literal(e.a);
+                const size_t off = pool.at(e.a).off;
+                if(ClassRuleTable::looksLikeDottedOid(text)){
+                    if(const ClassRule* r = rules.oid(text)) emit(off, *r, text);
+                    break;
+                }
+                upperInto(text, up);
+                ClassRuleTable::literalTokens(up, toks);
+                for(const auto& t : toks){
+                    if(const ClassRule* r = rules.token(t)) emit(off, *r, t);
+                }
+                if(up.rfind("AES/", 0) == 0 && std::count(up.begin(), up.end(), '/') == 2){
+                    static const ClassRule transform{ "Java Cipher transforms (AES modes incl. GCM)", kLow, "bytecode" };
+                    emit(off, transform, text);
+                }
+                break;
+            }
+            case 7: {
+                std::string_view name = pool.utf8(e.a);
+                if(const ClassRule* r = rules.className(name)) emit(pool.at(e.a).off, *r, name);
+                break;
+            }
+            case 3: {
+                if(const ClassRule* r = rules.integer(pool.integer(i))) emit(e.off, *r, std::to_string(pool.integer(i)));
+                break;
+            }
+            case 10:
+            case 11: {
+                std::string_view owner = pool.className(e.a);
+                const CpEntry& nat = pool.at(e.b);
+                std::string_view name = nat.tag == 12 ? pool.utf8(nat.a) : std::string_view();
+                if(owner == "java/security/KeyPairGenerator" && name == "initialize") kpgInit = i;
+                if(name == "getInstance"){
+                    if(owner == "java/security/MessageDigest") getInstanceKind[i] = kWeakDigest;
+                    else if(owner == "javax/crypto/Cipher") getInstanceKind[i] = kWeakCipher;
+                    else if(owner == "java/security/Signature") getInstanceKind[i] = kWeakSignature;
+                }
+                break;
+            }
+            default:
+                break;
+        }
     }
 
-    if( (has("java/security/Signature") || has("java.security.Signature")) &&
-        has("getInstance") &&
-        hasAlg({"MD5withRSA","SHA1withRSA","SHA-1withRSA"}) )
-    {
-        add(out, displayName, 0, "Java: Signature.getInstance(MD5withRSA|SHA1withRSA)", "MD5|SHA1", "med");
+    // ldc/ldc_w <String>, an optional provider argument (another String, a local or a static
+    // field), then invokestatic of a getInstance above: the literal is the algorithm that call
+    // gets. The finding names that literal at its constant pool offset.
+    if(std::any_of(getInstanceKind.begin(), getInstanceKind.end(), [](unsigned k){ return k != 0; })){
+        static const ClassRule weakDigest{ "Java: MessageDigest.getInstance(MD5|SHA-1)", kMed, "bytecode" };
+        static const ClassRule weakCipher{ "Java: Cipher.getInstance(DES/ECB|RC4|AES/ECB)", kHigh, "bytecode" };
+        static const ClassRule weakSignature{ "Java: Signature.getInstance(MD5withRSA|SHA1withRSA)", kMed, "bytecode" };
+        auto operandBytes = [](unsigned char op) -> size_t {
+            switch(op){
+                case 0x12: case 0x19: return 1;    // ldc, aload
+                case 0x13: case 0xB2: return 2;    // ldc_w, getstatic
+                default: return op >= 0x2A && op <= 0x2D ? 0 : SIZE_MAX;   // aload_<n>
+            }
+        };
+        for(size_t k = pool.poolEnd(); k + 4 < buf.size(); ++k){
+            if(buf[k] != 0x12 && buf[k] != 0x13) continue;
+            const uint16_t str = buf[k] == 0x12 ? buf[k+1] : rd16(&buf[k+1]);
+            if(pool.at(str).tag != 8) continue;
+            size_t call = k + 1 + operandBytes(buf[k]);
+            if(buf[call] != 0xB8){
+                const size_t n = operandBytes(buf[call]);
+                if(n == SIZE_MAX) continue;
+                call += 1 + n;
+            }
+            if(call + 2 >= buf.size() || buf[call] != 0xB8) continue;
+            const uint16_t method = rd16(&buf[call+1]);
+            const unsigned kind = method < getInstanceKind.size() ? getInstanceKind[method] : 0;
+            if(!kind) continue;
+            const uint16_t utf8 = pool.at(str).a;
+            if(pool.utf8(utf8).empty() || pool.utf8(utf8).size() > 512) continue;
+            const std::string_view text = literal(utf8);
+            upperInto(text, up);
+            if(!(weakLiteralKind(up) & kind)) continue;
+            const ClassRule& r = kind == kWeakDigest ? weakDigest : kind == kWeakCipher ? weakCipher : weakSignature;
+            emit(pool.at(utf8).off, r, text);
+        }
     }
 
-    if( (has("java/security/KeyPairGenerator") || has("java.security.KeyPairGenerator")) &&
-        ( has("initialize") || has("java/security/KeyPairGenerator.initialize") ) )
-    {
-        if(cp_ints.count(512) || cp_ints.count(768) || cp_ints.count(1024)){
-            add(out, displayName, 0, "Java: KeyPairGenerator.initialize(weak key size)", "512|768|1024", "med");
+    // sipush/bipush <n> immediately followed by invokevirtual KeyPairGenerator.initialize.
+    if(kpgInit){
+        const unsigned char hi = (unsigned char)(kpgInit >> 8), lo = (unsigned char)(kpgInit & 0xFF);
+        for(size_t k = pool.poolEnd(); k + 5 < buf.size(); ++k){
+            if(buf[k] != 0x11 || buf[k+3] != 0xB6 || buf[k+4] != hi || buf[k+5] != lo) continue;
+            int v = (int16_t)rd16(&buf[k+1]);
+            if(v == 512 || v == 768 || v == 1024){
+                emit(k, ClassRule{ "Java: KeyPairGenerator.initialize(weak key size)", kMed, "bytecode" }, std::to_string(v));
+            }
         }
     }
 
+    std::stable_sort(out.begin(), out.end(), [](const Detection& a, const Detection& b){ return a.offset < b.offset; });
     return out;
 }
 
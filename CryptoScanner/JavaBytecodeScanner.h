@@ -2,16 +2,53 @@
 
 #include "CryptoScanner.h"
 
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <cstdint>
 
 namespace analyzers {
 
+struct ClassRule {
+    std::string algorithm;
+    std::string severity;
+    std::string evidence;
+};
+
+class ClassRuleTable {
+public:
+    // Built-in JCA/BouncyCastle tokens plus the dotted form of every DER OID byte pattern.
+    static std::shared_ptr<const ClassRuleTable> build(const std::vector<BytePattern>& oidBytePatterns);
+
+    const ClassRule* token(std::string_view upper) const;
+    const ClassRule* className(std::string_view internalName) const;
+    const ClassRule* oid(std::string_view dotted) const;
+    const ClassRule* integer(std::int32_t v) const;
+
+    // Splits an upper-cased literal into word tokens and then on camel-cased WITH/AND joins
+    // ("SHA256withRSA", "PBEWithMD5AndDES"). The tokens are views into upper.
+    static void literalTokens(std::string_view upper, std::vector<std::string_view>& out);
+    static bool looksLikeDottedOid(std::string_view s);
+
+private:
+    std::unordered_map<std::string_view, ClassRule> tokens;   // keys are the built-in literals
+    std::unordered_map<std::string, ClassRule> classes;
+    std::unordered_map<std::string, ClassRule> oids;
+    std::unordered_map<std::int32_t, ClassRule> ints;
+};
+
 class JavaBytecodeScanner {
 public:
+    static bool isClassFile(const std::vector<unsigned char>& buf);
+
     static std::vector<Detection> scanClassBytes(const std::string& displayName,
-                                                 const std::vector<unsigned char>& buf);
+                                                 const std::vector<unsigned char>& buf,
+                                                 const ClassRuleTable& rules);
+
+    // Decodes JVM Modified UTF-8 (0xC0 0x80 for NUL, surrogate pairs as two 3-byte units) into UTF-8.
+    static std::string decodeModifiedUtf8(std::string_view raw);
 };
 
 } // namespace analyzers
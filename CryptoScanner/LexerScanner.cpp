@@ -0,0 +1,430 @@
+#include "LexerScanner.h"
+
+#include <algorithm>
+#include <cstring>
+#include "ParserPool.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+using analyzers::SourceLang;
+
+enum : unsigned char { kOther, kSpace, kIdent, kDigit };
+
+struct ByteClasses {
+    unsigned char c[256];
+    ByteClasses(){
+        std::memset(c, kOther, sizeof(c));
+        for(int i='a';i<='z';++i) c[i]=kIdent;
+        for(int i='A';i<='Z';++i) c[i]=kIdent;
+        for(int i='0';i<='9';++i) c[i]=kDigit;
+        for(int i=0x80;i<0x100;++i) c[i]=kIdent;
+        c[(unsigned char)'_']=kIdent; c[(unsigned char)'$']=kIdent;
+        for(char s : std::string_view(" \t\r\n\f\v")) c[(unsigned char)s]=kSpace;
+    }
+};
+
+const ByteClasses kClasses;
+
+inline unsigned char cls(char ch){ return kClasses.c[(unsigned char)ch]; }
+inline bool identChar(char ch){ const unsigned char k=cls(ch); return k==kIdent || k==kDigit; }
+inline bool isSpace(char ch){ return cls(ch)==kSpace; }
+
+// Bytes the lexer has to look at: quotes, brackets, commas and the comment introducer ('/' for
+// Java and C/C++, '#' for Python). Everything between them is skipped in bulk.
+struct StructuralTable {
+    bool hit[2][256] = {};
+    StructuralTable(){
+        for(int py=0;py<2;++py){
+            for(char c : std::string_view("\"'()[]{},")) hit[py][(unsigned char)c]=true;
+            hit[py][(unsigned char)(py ? '#' : '/')]=true;
+        }
+    }
+};
+
+const StructuralTable kStructural;
+
+size_t nextStructural(std::string_view code, size_t i, bool python){
+    const size_t n=code.size();
+    const char* p=code.data();
+    const char comment = python ? '#' : '/';
+#if defined(__SSE2__)
+    const __m128i q2=_mm_set1_epi8('"'), q1=_mm_set1_epi8('\''), lp=_mm_set1_epi8('('), rp=_mm_set1_epi8(')');
+    const __m128i lb=_mm_set1_epi8('['), rb=_mm_set1_epi8(']'), lc=_mm_set1_epi8('{'), rc=_mm_set1_epi8('}');
+    const __m128i cm=_mm_set1_epi8(','), co=_mm_set1_epi8(comment);
+    while(i+16<=n){
+        const __m128i v=_mm_loadu_si128((const __m128i*)(p+i));
+        __m128i m=_mm_or_si128(_mm_cmpeq_epi8(v, q2), _mm_cmpeq_epi8(v, q1));
+        m=_mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, lp), _mm_cmpeq_epi8(v, rp)));
+        m=_mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, lb), _mm_cmpeq_epi8(v, rb)));
+        m=_mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, lc), _mm_cmpeq_epi8(v, rc)));
+        m=_mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, cm), _mm_cmpeq_epi8(v, co)));
+        const unsigned bits=(unsigned)_mm_movemask_epi8(m);
+        if(bits) return i+(size_t)__builtin_ctz(bits);
+        i+=16;
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    const uint8x16_t q2=vdupq_n_u8('"'), q1=vdupq_n_u8('\''), lp=vdupq_n_u8('('), rp=vdupq_n_u8(')');
+    const uint8x16_t lb=vdupq_n_u8('['), rb=vdupq_n_u8(']'), lc=vdupq_n_u8('{'), rc=vdupq_n_u8('}');
+    const uint8x16_t cm=vdupq_n_u8(','), co=vdupq_n_u8((uint8_t)comment);
+    while(i+16<=n){
+        const uint8x16_t v=vld1q_u8((const uint8_t*)(p+i));
+        uint8x16_t m=vorrq_u8(vceqq_u8(v, q2), vceqq_u8(v, q1));
+        m=vorrq_u8(m, vorrq_u8(vceqq_u8(v, lp), vceqq_u8(v, rp)));
+        m=vorrq_u8(m, vorrq_u8(vceqq_u8(v, lb), vceqq_u8(v, rb)));
+        m=vorrq_u8(m, vorrq_u8(vceqq_u8(v, lc), vceqq_u8(v, rc)));
+        m=vorrq_u8(m, vorrq_u8(vceqq_u8(v, cm), vceqq_u8(v, co)));
+        const uint64_t bits=vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+        if(bits) return i+(size_t)(__builtin_ctzll(bits)>>2);
+        i+=16;
+    }
+#endif
+    const bool* hit=kStructural.hit[python ? 1 : 0];
+    while(i<n && !hit[(unsigned char)p[i]]) ++i;
+    return i;
+}
+
+template <size_t N>
+bool inList(std::string_view w, const std::string_view (&list)[N]){
+    for(const auto& x : list) if(w==x) return true;
+    return false;
+}
+
+// Words that take a parenthesised operand without being a call.
+const std::string_view kJavaNotCalls[] = { "if","while","for","switch","catch","synchronized","return","throw","assert","new","super","this","try" };
+const std::string_view kCppNotCalls[] = { "if","while","for","switch","catch","return","throw","sizeof","alignof","alignas","decltype","typeid",
+                                          "static_assert","noexcept","defined","operator","new","delete","co_return","co_await","co_yield",
+                                          "__attribute__","__declspec","__asm__","asm","requires" };
+const std::string_view kPythonNotCalls[] = { "if","elif","while","for","with","return","yield","not","and","or","in","is","assert","del",
+                                             "except","lambda","raise","await","import","from","as","else" };
+// Java/C++ words after which "name(" is still an expression rather than a declaration.
+const std::string_view kExprLeaders[] = { "return","else","case","throw","do","yield","assert","co_return","co_await","co_yield" };
+const std::string_view kCppRawPrefixes[] = { "R","LR","uR","UR","u8R" };
+
+std::string_view trim(std::string_view s){
+    size_t i=0,j=s.size();
+    while(i<j && isSpace(s[i])) ++i;
+    while(j>i && isSpace(s[j-1])) --j;
+    return s.substr(i,j-i);
+}
+
+class Lexer {
+public:
+    Lexer(const std::string& path, SourceLang lang, std::string_view code, const CallSiteFilter& keep, std::vector<AstSymbol>& out)
+        : path(path), lang(lang), code(code), keep(keep), out(out) {}
+
+    void run(){
+        const size_t n=code.size();
+        const bool python = lang==SourceLang::Python;
+        size_t i=0;
+        while((i=nextStructural(code, i, python))<n){
+            const char c=code[i];
+            if(c=='"' || c=='\''){
+                if(digitSeparator(i)){ ++i; continue; }
+                i = rawStringPrefix(i) ? skipRawString(i) : skipString(i);
+                skippedTo=i;
+            }else if(c=='#'){
+                i=skipLine(i);
+                skippedTo=i;
+            }else if(c=='/'){
+                if(i+1<n && (code[i+1]=='/' || code[i+1]=='*')){ i=skipComment(i); skippedTo=i; }
+                else ++i;
+            }else{
+                punct(i);
+                ++i;
+            }
+        }
+        while(!stack.empty()) pop(n);
+        std::stable_sort(found.begin(), found.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+        for(auto& f : found) out.push_back(std::move(f.second));
+    }
+
+private:
+    // One open bracket. Call frames remember the callee and collect their top-level argument spans.
+    struct Frame {
+        char closer;
+        bool call;
+        size_t start, end, lastStart, line;
+        size_t argFrom;
+        size_t spanBase;
+    };
+
+    size_t skipLine(size_t i) const {
+        const void* nl=std::memchr(code.data()+i, '\n', code.size()-i);
+        return nl ? (size_t)((const char*)nl-code.data()) : code.size();
+    }
+
+    size_t skipComment(size_t i) const {
+        if(code[i+1]=='/') return skipLine(i);
+        size_t e=code.find("*/", i+2);
+        return e==std::string_view::npos ? code.size() : e+2;
+    }
+
+    size_t skipRawString(size_t q) const {
+        size_t open=code.find('(', q+1);
+        if(open==std::string_view::npos || open-q-1>16) return q+1;
+        std::string close=")";
+        close.append(code.substr(q+1, open-q-1));
+        close.push_back('"');
+        size_t e=code.find(close, open+1);
+        return e==std::string_view::npos ? code.size() : e+close.size();
+    }
+
+    size_t skipString(size_t i) const {
+        const size_t n=code.size();
+        const char q=code[i];
+        const bool triple = (lang==SourceLang::Python || (lang==SourceLang::Java && q=='"'))
+                            && i+2<n && code[i+1]==q && code[i+2]==q;
+        if(triple){
+            for(size_t p=i+3;p+2<n;++p){
+                if(code[p]=='\\'){ ++p; continue; }
+                if(code[p]==q && code[p+1]==q && code[p+2]==q) return p+3;
+            }
+            return n;
+        }
+        for(size_t p=i+1;p<n;++p){
+            const char c=code[p];
+            if(c=='\\'){ ++p; continue; }
+            if(c==q) return p+1;
+            if(c=='\n') return p;
+        }
+        return n;
+    }
+
+    // Start of the identifier or number that ends right before `e`.
+    size_t wordStart(size_t e) const {
+        while(e>skippedTo && identChar(code[e-1])) --e;
+        return e;
+    }
+
+    // C++14 1'000'000: a quote inside a token that starts with a digit.
+    bool digitSeparator(size_t q) const {
+        if(lang!=SourceLang::Cpp || code[q]!='\'' || q+1>=code.size() || !identChar(code[q+1])) return false;
+        const size_t b=wordStart(q);
+        return b<q && cls(code[b])==kDigit;
+    }
+
+    bool rawStringPrefix(size_t q) const {
+        if(lang!=SourceLang::Cpp || code[q]!='"') return false;
+        const size_t b=wordStart(q);
+        return inList(code.substr(b, q-b), kCppRawPrefixes);
+    }
+
+    size_t skipSpacesBack(size_t e, bool newlines) const {
+        while(e>skippedTo && isSpace(code[e-1]) && (newlines || code[e-1]!='\n')) --e;
+        return e;
+    }
+
+    // Walks back from an opening parenthesis over "a.b::c->d" to find the callee, then looks at
+    // the token before it to tell calls from declarations and keywords.
+    bool callBefore(size_t paren, Frame& f) const {
+        // Python statements end at a newline unless a bracket is open.
+        const bool newlines = lang!=SourceLang::Python || !stack.empty();
+        const size_t end=skipSpacesBack(paren, newlines);
+        const size_t lastStart=wordStart(end);
+        if(lastStart==end || cls(code[lastStart])==kDigit) return false;
+        size_t s=lastStart;
+        bool qualified=false;
+        for(;;){
+            const size_t j=skipSpacesBack(s, newlines);
+            size_t k=j;
+            if(j>skippedTo && code[j-1]=='.') k=j-1;
+            else if(lang==SourceLang::Cpp && j>skippedTo+1 && ((code[j-2]==':' && code[j-1]==':') || (code[j-2]=='-' && code[j-1]=='>'))) k=j-2;
+            if(k==j) break;
+            k=skipSpacesBack(k, newlines);
+            const size_t b=wordStart(k);
+            if(b==k || cls(code[b])==kDigit) break;
+            s=b;
+            qualified=true;
+        }
+
+        if(!qualified){
+            const std::string_view first=code.substr(s, end-s);
+            if(lang==SourceLang::Java ? inList(first, kJavaNotCalls) : lang==SourceLang::Cpp ? inList(first, kCppNotCalls) : inList(first, kPythonNotCalls)) return false;
+        }
+        const size_t pe=skipSpacesBack(s, true);
+        const size_t ps=wordStart(pe);
+        if(ps<pe && cls(code[ps])!=kDigit){
+            const std::string_view prevWord=code.substr(ps, pe-ps);
+            if(lang==SourceLang::Python){
+                if(prevWord=="def" || prevWord=="class") return false;
+            }else if(!inList(prevWord, kExprLeaders)){
+                // "Type name(" declares rather than calls.
+                return false;
+            }
+        }else if(lang==SourceLang::Java && pe>skippedTo && code[pe-1]=='@'){
+            return false;
+        }
+        f.call=true;
+        f.start=s;
+        f.end=end;
+        f.lastStart=lastStart;
+        return true;
+    }
+
+    void punct(size_t i){
+        const char c=code[i];
+        switch(c){
+        case '(': case '[': case '{': {
+            Frame f{ c=='(' ? ')' : c=='[' ? ']' : '}', false, 0, 0, 0, 0, i+1, spans.size() };
+            if(c=='(' && callBefore(i, f)) f.line=lineAt(f.start);
+            stack.push_back(f);
+            break;
+        }
+        case ')': case ']': case '}':
+            // Unbalanced input (e.g. preprocessor branches) closes the nearest matching frame or nothing.
+            for(size_t d=stack.size(), seen=0; d>0 && seen<8; --d, ++seen){
+                if(stack[d-1].closer!=c) continue;
+                while(stack.size()>=d) pop(i);
+                break;
+            }
+            break;
+        case ',':
+            if(!stack.empty() && stack.back().call){
+                spans.emplace_back(stack.back().argFrom, i);
+                stack.back().argFrom=i+1;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void pop(size_t close){
+        Frame f=stack.back();
+        stack.pop_back();
+        if(f.call){
+            spans.emplace_back(f.argFrom, close);
+            emit(f, close);
+        }
+        spans.resize(f.spanBase);
+    }
+
+    // String literal body with escapes resolved; `quoted` is false for anything else.
+    std::string literal(std::string_view a, bool& quoted) const {
+        quoted=false;
+        size_t i=0;
+        bool raw=false;
+        if(lang==SourceLang::Python){
+            while(i<a.size() && i<2 && std::strchr("rRbBuUfF", a[i])) ++i;
+        }else if(lang==SourceLang::Cpp){
+            while(i<a.size() && i<3 && identChar(a[i])) ++i;
+            const std::string_view prefix=a.substr(0, i);
+            raw=inList(prefix, kCppRawPrefixes);
+            if(!raw && prefix!="L" && prefix!="u" && prefix!="U" && prefix!="u8") i=0;
+        }
+        if(i>=a.size() || (a[i]!='"' && a[i]!='\'')) return {};
+        const char q=a[i];
+        if(raw){
+            size_t open=a.find('(', i), close=a.rfind(')');
+            if(open==std::string_view::npos || close==std::string_view::npos || close<open) return {};
+            quoted=true;
+            return std::string(a.substr(open+1, close-open-1));
+        }
+        size_t p=i+1, endQuote=1;
+        if(a.size()>=i+6 && a[i+1]==q && a[i+2]==q){ p=i+3; endQuote=3; }
+        std::string v;
+        while(p<a.size()){
+            const char c=a[p];
+            if(c=='\\' && p+1<a.size()){ v.push_back(a[p+1]); p+=2; continue; }
+            if(c==q && (endQuote==1 || a.compare(p, 3, std::string(3, q))==0)){ quoted=true; return v; }
+            v.push_back(c);
+            ++p;
+        }
+        return {};
+    }
+
+    std::string firstArgValue(std::string_view a) const {
+        bool quoted=false;
+        std::string v=literal(a, quoted);
+        if(quoted) return v;
+        if(lang==SourceLang::Cpp) return std::string(a);
+        size_t j=0;
+        while(j<a.size() && identChar(a[j]) && a[j]!='$') ++j;
+        return std::string(a.substr(0, j));
+    }
+
+    std::string argValue(std::string_view a) const {
+        bool quoted=false;
+        std::string v=literal(a, quoted);
+        return quoted ? v : std::string(a);
+    }
+
+    size_t lineAt(size_t pos){
+        if(pos>=linePos) lineNo+=(size_t)std::count(code.begin()+linePos, code.begin()+pos, '\n');
+        else lineNo-=(size_t)std::count(code.begin()+pos, code.begin()+linePos, '\n');
+        linePos=pos;
+        return lineNo;
+    }
+
+    std::string_view span(size_t k) const {
+        return trim(code.substr(spans[k].first, spans[k].second-spans[k].first));
+    }
+
+    void emit(const Frame& f, size_t close){
+        std::string_view callee=code.substr(f.start, f.end-f.start);
+        std::string_view arg0=span(f.spanBase);
+        if(keep && !keep(callee, arg0)) return;
+        std::vector<std::string_view> args;
+        for(size_t k=f.spanBase;k<spans.size();++k) args.push_back(span(k));
+        while(!args.empty() && args.back().empty()) args.pop_back();
+
+        AstSymbol s;
+        s.filePath=path;
+        s.line=f.line;
+        s.lang = lang==SourceLang::Java ? "java" : lang==SourceLang::Python ? "python" : "cpp";
+        s.callee_full=std::string(callee);
+        s.callee_base = lang==SourceLang::Cpp ? std::string(code.substr(f.lastStart, f.end-f.lastStart)) : s.callee_full;
+        s.first_arg=firstArgValue(arg0);
+        for(std::string_view a : args){
+            if(lang==SourceLang::Python){
+                size_t k=0;
+                while(k<a.size() && identChar(a[k])) ++k;
+                size_t eq=k;
+                while(eq<a.size() && isSpace(a[eq])) ++eq;
+                if(k>0 && cls(a[0])==kIdent && eq<a.size() && a[eq]=='=' && (eq+1>=a.size() || a[eq+1]!='=')){
+                    s.kwargs.emplace_back(std::string(a.substr(0, k)), argValue(trim(a.substr(eq+1))));
+                    continue;
+                }
+            }
+            s.args.push_back(argValue(a));
+        }
+        s.startByte=f.start;
+        s.endByte=std::min(close+1, code.size());
+        found.emplace_back(f.start, std::move(s));
+    }
+
+    const std::string& path;
+    const SourceLang lang;
+    const std::string_view code;
+    const CallSiteFilter& keep;
+    std::vector<AstSymbol>& out;
+
+    // Backward scans never cross into the last string or comment skipped.
+    size_t skippedTo=0;
+    size_t linePos=0;
+    size_t lineNo=1;
+    std::vector<Frame> stack;
+    std::vector<std::pair<size_t, size_t>> spans;
+    // Calls complete innermost first; they are put back in source order at the end.
+    std::vector<std::pair<size_t, AstSymbol>> found;
+};
+
+}
+
+namespace analyzers {
+
+std::vector<AstSymbol> LexerScanner::collectSymbols(const std::string& displayPath, SourceLang lang,
+                                                    std::string_view code, const CallSiteFilter& keep){
+    std::vector<AstSymbol> out;
+    if(code.empty()) return out;
+    Lexer(displayPath, lang, code, keep, out).run();
+    return out;
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ASTSymbol.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace analyzers {
+
+enum class SourceLang;
+
+// Tree-free call-site extraction for sources too large or too machine-generated to parse.
+// One forward pass skips comments and string literals, recognises qualified identifiers
+// followed by '(' and splits the top-level arguments, producing the same AstSymbol records
+// (line, callee, arguments, Python keyword arguments) as the tree-sitter scanners.
+class LexerScanner {
+public:
+    static std::vector<AstSymbol> collectSymbols(const std::string& displayPath, SourceLang lang,
+                                                 std::string_view code, const CallSiteFilter& keep = {});
+};
+
+}
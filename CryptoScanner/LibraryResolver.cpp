@@ -0,0 +1,211 @@
+#include "LibraryResolver.h"
+
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace dyn {
+
+static const char kCacheMagic[] = "glibc-ld.so.cache1.1";
+static const char kOldCacheMagic[] = "ld.so-1.7.0";
+static const size_t kCacheHeaderSize = 48;
+static const size_t kCacheEntrySize = 24;
+static const size_t kMaxCacheBytes = 64u << 20;
+static const size_t kMaxClosure = 4096;
+
+static inline uint32_t r32le(const unsigned char* p){ return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+struct Arch {
+    uint16_t machine;
+    const char* triplet;    // Debian multiarch directory name
+    const char* platform;   // AT_PLATFORM, what $PLATFORM expands to
+};
+
+static const Arch kArchs[] = {
+    { 62,  "x86_64-linux-gnu",    "x86_64" },
+    { 3,   "i386-linux-gnu",      "i686" },
+    { 183, "aarch64-linux-gnu",   "aarch64" },
+    { 40,  "arm-linux-gnueabihf", "v7l" },
+    { 243, "riscv64-linux-gnu",   "riscv64" },
+};
+
+static const Arch* archFor(uint16_t machine){
+    for(const auto& a : kArchs) if(a.machine == machine) return &a;
+    return nullptr;
+}
+
+// Replaces "$NAME" and "${NAME}" with each of `values`, one output string per value.
+static void substitute(std::vector<std::string>& items, const std::string& name, const std::vector<std::string>& values){
+    std::vector<std::string> out;
+    for(const auto& s : items){
+        if(s.find("$" + name) == std::string::npos && s.find("${" + name + "}") == std::string::npos){
+            out.push_back(s);
+            continue;
+        }
+        for(const auto& v : values){
+            std::string r;
+            for(size_t i = 0; i < s.size(); ){
+                if(s.compare(i, name.size() + 3, "${" + name + "}") == 0){ r += v; i += name.size() + 3; }
+                else if(s.compare(i, name.size() + 1, "$" + name) == 0){ r += v; i += name.size() + 1; }
+                else r.push_back(s[i++]);
+            }
+            out.push_back(std::move(r));
+        }
+    }
+    items.swap(out);
+}
+
+LibraryResolver::LibraryResolver(const std::string& rootDir) : root(rootDir) {
+    while(!root.empty() && root.back() == '/') root.pop_back();
+    loadCache();
+}
+
+void LibraryResolver::loadCache(){
+    std::ifstream in(root + "/etc/ld.so.cache", std::ios::binary);
+    if(!in) return;
+    std::vector<unsigned char> b((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if(b.size() > kMaxCacheBytes) return;
+    size_t base = 0;
+    // Caches written by old ldconfig versions put the new table after the libc5-era one.
+    if(b.size() >= 16 && std::memcmp(b.data(), kOldCacheMagic, sizeof(kOldCacheMagic) - 1) == 0){
+        base = ((16 + (size_t)r32le(b.data() + 12) * 12) + 7) & ~(size_t)7;
+    }
+    if(base + kCacheHeaderSize > b.size() || std::memcmp(b.data() + base, kCacheMagic, sizeof(kCacheMagic) - 1) != 0) return;
+    const size_t n = r32le(b.data() + base + 20);
+    // Key and value are offsets from the start of the new-format header.
+    auto str = [&](uint32_t off) -> std::string {
+        if(base + off >= b.size()) return {};
+        const void* z = std::memchr(b.data() + base + off, 0, b.size() - base - off);
+        return z ? std::string((const char*)b.data() + base + off, (const char*)z) : std::string();
+    };
+    for(size_t i = 0; i < n; i++){
+        const size_t e = base + kCacheHeaderSize + i * kCacheEntrySize;
+        if(e + kCacheEntrySize > b.size()) break;
+        std::string key = str(r32le(b.data() + e + 4)), value = str(r32le(b.data() + e + 8));
+        if(!key.empty() && !value.empty()) cache[key].push_back(std::move(value));
+    }
+}
+
+std::vector<std::string> LibraryResolver::expand(const std::vector<std::string>& entries, const std::string& objectPath, const DynamicInfo& object) const {
+    const Arch* arch = archFor(object.machine);
+    std::vector<std::string> lib{ object.elfClass == 2 ? "lib64" : "lib" };
+    if(arch) lib.push_back(std::string("lib/") + arch->triplet);
+    const std::string origin = fs::path(objectPath).parent_path().string();
+    std::vector<std::string> out;
+    for(const auto& e : entries){
+        const bool fromOrigin = e.rfind("$ORIGIN", 0) == 0 || e.rfind("${ORIGIN}", 0) == 0;
+        std::vector<std::string> items{ e };
+        substitute(items, "ORIGIN", { origin });
+        substitute(items, "LIB", lib);
+        if(arch) substitute(items, "PLATFORM", { arch->platform });
+        for(auto& s : items){
+            // Relative entries are relative to the process's working directory, which a scan
+            // does not have.
+            if(s.empty() || s[0] != '/' || s.find('$') != std::string::npos) continue;
+            out.push_back(fromOrigin ? s : root + s);
+        }
+    }
+    return out;
+}
+
+std::vector<std::string> LibraryResolver::defaultDirs(const DynamicInfo& requester) const {
+    std::vector<std::string> out;
+    if(const Arch* arch = archFor(requester.machine)){
+        out.push_back(root + "/lib/" + arch->triplet);
+        out.push_back(root + "/usr/lib/" + arch->triplet);
+    }
+    if(requester.elfClass == 2){
+        out.push_back(root + "/lib64");
+        out.push_back(root + "/usr/lib64");
+    }
+    out.push_back(root + "/lib");
+    out.push_back(root + "/usr/lib");
+    return out;
+}
+
+std::string LibraryResolver::tryCandidate(const std::string& path, const DynamicInfo& requester) const {
+    unsigned char eh[20];
+    std::ifstream in(path, std::ios::binary);
+    if(!in || !in.read((char*)eh, sizeof(eh))) return {};
+    if(eh[0] != 0x7F || eh[1] != 'E' || eh[2] != 'L' || eh[3] != 'F') return {};
+    const bool be = eh[5] == 2;
+    const uint16_t machine = be ? (uint16_t)((eh[18] << 8) | eh[19]) : (uint16_t)(eh[18] | (eh[19] << 8));
+    if(eh[4] != requester.elfClass || be != requester.bigEndian || machine != requester.machine) return {};
+    std::error_code ec;
+    const fs::path canon = fs::canonical(path, ec);
+    // An absolute symlink inside a mounted root points into this system, not the root.
+    if(ec || (!root.empty() && canon.string().rfind(root + "/", 0) != 0)) return fs::path(path).lexically_normal().string();
+    return canon.string();
+}
+
+std::string LibraryResolver::resolve(const std::string& name, const std::string& requesterPath, const DynamicInfo& requester,
+                                     const std::vector<std::string>& loaderRpath) const {
+    if(name.find('/') != std::string::npos){
+        return name[0] == '/' ? tryCandidate(root + name, requester) : std::string();
+    }
+    auto search = [&](const std::vector<std::string>& dirs) -> std::string {
+        for(const auto& d : dirs){
+            std::string r = tryCandidate(d + "/" + name, requester);
+            if(!r.empty()) return r;
+        }
+        return {};
+    };
+    std::string r;
+    if(requester.runpath.empty()){
+        r = search(expand(requester.rpath, requesterPath, requester));
+        if(r.empty()) r = search(loaderRpath);
+        if(!r.empty()) return r;
+    }else{
+        r = search(expand(requester.runpath, requesterPath, requester));
+        if(!r.empty()) return r;
+    }
+    auto it = cache.find(name);
+    if(it != cache.end()){
+        for(const auto& p : it->second){
+            r = tryCandidate(root + p, requester);
+            if(!r.empty()) return r;
+        }
+    }
+    return search(defaultDirs(requester));
+}
+
+std::vector<ResolvedLibrary> LibraryResolver::closure(const std::string& path, const DynamicInfo& info, const InfoFn& infoFor) const {
+    struct Pending {
+        std::string path;
+        const DynamicInfo* info;
+        std::vector<std::string> loaderRpath;
+        std::vector<std::string> via;
+    };
+    std::vector<ResolvedLibrary> out;
+    std::unordered_set<std::string> names, paths{ path };
+    if(!info.soname.empty()) names.insert(info.soname);
+    std::deque<Pending> queue;
+    queue.push_back({ path, &info, {}, {} });
+    while(!queue.empty() && out.size() < kMaxClosure){
+        const Pending cur = std::move(queue.front());
+        queue.pop_front();
+        // What this object's own dependencies inherit: its DT_RPATH ahead of its loaders'.
+        std::vector<std::string> rpath = expand(cur.info->rpath, cur.path, *cur.info);
+        rpath.insert(rpath.end(), cur.loaderRpath.begin(), cur.loaderRpath.end());
+        for(const auto& name : cur.info->needed){
+            if(!names.insert(name).second) continue;
+            const std::string lib = resolve(name, cur.path, *cur.info, cur.loaderRpath);
+            if(lib.empty() || !paths.insert(lib).second) continue;
+            std::vector<std::string> via = cur.via;
+            via.push_back(name);
+            out.push_back({ lib, via });
+            const DynamicInfo* li = infoFor(lib);
+            if(!li) continue;
+            if(!li->soname.empty()) names.insert(li->soname);
+            queue.push_back({ lib, li, rpath, std::move(via) });
+        }
+    }
+    return out;
+}
+
+}
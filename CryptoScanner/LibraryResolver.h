@@ -0,0 +1,54 @@
+#pragma once
+
+#include "DynLinkParser.h"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dyn {
+
+// A library an object pulls in, with the DT_NEEDED names leading from the object to it.
+struct ResolvedLibrary {
+    std::string path;               // canonical path
+    std::vector<std::string> via;   // direct dependencies have one entry
+};
+
+// Finds shared libraries the way glibc's ld.so does, against the filesystem mounted at `root`
+// ("" for this system): DT_RPATH of the requesting object and then of each object that loaded
+// it (none of them having DT_RUNPATH), DT_RUNPATH, /etc/ld.so.cache, then the default
+// directories. A candidate only counts if it is an ELF file of the requester's class, byte order
+// and machine, so a 32-bit library never satisfies a 64-bit binary. LD_LIBRARY_PATH and
+// LD_PRELOAD belong to a process environment and are not considered.
+class LibraryResolver {
+public:
+    // Dynamic section of a resolved library, or nullptr when it cannot be read.
+    using InfoFn = std::function<const DynamicInfo*(const std::string& path)>;
+
+    explicit LibraryResolver(const std::string& root = std::string());
+
+    // Canonical path of the library `name` needed by the object at `requesterPath`; empty when
+    // not found. `loaderRpath` are the expanded DT_RPATH directories of the objects that loaded
+    // the requester, nearest first.
+    std::string resolve(const std::string& name, const std::string& requesterPath, const DynamicInfo& requester,
+                        const std::vector<std::string>& loaderRpath) const;
+
+    // Every library `path` loads, breadth-first in ld.so's mapping order. A name that an
+    // earlier object already satisfied (by DT_NEEDED name or DT_SONAME) is not searched again,
+    // and infoFor is asked once per library for the dependencies of that library.
+    std::vector<ResolvedLibrary> closure(const std::string& path, const DynamicInfo& info, const InfoFn& infoFor) const;
+
+private:
+    void loadCache();
+    // RPATH/RUNPATH entries with $ORIGIN, $LIB and $PLATFORM substituted; absolute entries are
+    // placed under root, $ORIGIN ones are already there.
+    std::vector<std::string> expand(const std::vector<std::string>& entries, const std::string& objectPath, const DynamicInfo& object) const;
+    std::vector<std::string> defaultDirs(const DynamicInfo& requester) const;
+    std::string tryCandidate(const std::string& path, const DynamicInfo& requester) const;
+
+    std::string root;
+    std::unordered_map<std::string, std::vector<std::string>> cache;    // name -> paths in cache order
+};
+
+}
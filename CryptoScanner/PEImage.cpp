@@ -0,0 +1,239 @@
+#include "PEImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dyn {
+
+static inline uint16_t r16le(const unsigned char* p){ return (uint16_t)p[0] | ((uint16_t)p[1] << 8); }
+static inline uint32_t r32le(const unsigned char* p){ return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+static inline uint64_t r64le(const unsigned char* p){ return (uint64_t)r32le(p) | ((uint64_t)r32le(p+4) << 32); }
+
+static const size_t kMaxDescriptors = 4096;
+static const size_t kMaxThunks = 1u << 16;
+static const uint32_t kMaxExports = 1u << 20;
+static const uint32_t kDelayRvaBased = 0x1;
+static const size_t kMaxCertificates = 64;
+
+static std::string_view cstrAt(const unsigned char* p, size_t n, size_t off, size_t max){
+    if(off >= n) return {};
+    const size_t lim = std::min(n - off, max);
+    const void* z = std::memchr(p + off, 0, lim);
+    if(!z) return {};
+    return std::string_view((const char*)p + off, (size_t)((const unsigned char*)z - (p + off)));
+}
+
+PEImage::PEImage(const std::vector<unsigned char>& buf) : p(buf.data()), n(buf.size()) {
+    if(n < 0x40 || p[0] != 'M' || p[1] != 'Z') return;
+    const size_t nt = r32le(p + 0x3C);
+    if(nt + 24 > n || std::memcmp(p + nt, "PE\0\0", 4) != 0) return;
+    mach = r16le(p + nt + 4);
+    const uint16_t numSecs = r16le(p + nt + 6);
+    const uint16_t optSize = r16le(p + nt + 20);
+    const size_t opt = nt + 24;
+    if(optSize < 64 || opt + optSize > n) return;
+    plus = r16le(p + opt) == 0x20B;
+    base = plus ? r64le(p + opt + 24) : r32le(p + opt + 28);
+    headerSize = (uint32_t)std::min<size_t>(r32le(p + opt + 60), n);
+    const size_t ddOff = plus ? 112 : 96;
+    if(optSize >= ddOff){
+        dataDirs = opt + ddOff;
+        numDirs = std::min<uint32_t>(r32le(p + opt + ddOff - 4), (uint32_t)((optSize - ddOff) / 8));
+        numDirs = std::min<uint32_t>(numDirs, 16);
+    }
+    dataEnd = headerSize;
+    index.reserve(numSecs);
+    for(uint16_t i=0;i<numSecs;i++){
+        const size_t sh = opt + optSize + (size_t)i * 40;
+        if(sh + 40 > n) break;
+        const uint32_t vsize = r32le(p + sh + 8);
+        Range r{ r32le(p + sh + 12), r32le(p + sh + 16), r32le(p + sh + 20) };
+        if(vsize && vsize < r.size) r.size = vsize;
+        if(r.rawPtr >= n) continue;
+        dataEnd = std::max(dataEnd, (size_t)r.rawPtr + std::min<size_t>(r32le(p + sh + 16), n - r.rawPtr));
+        r.size = (uint32_t)std::min<size_t>(r.size, n - r.rawPtr);
+        if(r.size) index.push_back(r);
+    }
+    std::sort(index.begin(), index.end(), [](const Range& a, const Range& b){ return a.rva < b.rva; });
+    ok = true;
+}
+
+size_t PEImage::rvaToOffset(uint32_t rva, uint32_t len) const {
+    if(!ok) return npos;
+    if((uint64_t)rva + len <= headerSize) return rva;
+    auto it = std::upper_bound(index.begin(), index.end(), rva, [](uint32_t v, const Range& r){ return v < r.rva; });
+    if(it == index.begin()) return npos;
+    --it;
+    const uint32_t delta = rva - it->rva;
+    if(delta >= it->size || len > it->size - delta) return npos;
+    return (size_t)it->rawPtr + delta;
+}
+
+std::string_view PEImage::stringAt(uint32_t rva, size_t max) const {
+    const size_t off = rvaToOffset(rva);
+    return off == npos ? std::string_view() : cstrAt(p, n, off, max);
+}
+
+bool PEImage::directory(int i, uint32_t& rva, uint32_t& size) const {
+    if(!ok || i < 0 || (uint32_t)i >= numDirs) return false;
+    rva = r32le(p + dataDirs + (size_t)i * 8);
+    size = r32le(p + dataDirs + (size_t)i * 8 + 4);
+    return rva && size;
+}
+
+void PEImage::readThunks(uint32_t rva, std::vector<PEImportedFunction>& out) const {
+    const uint32_t width = plus ? 8 : 4;
+    for(size_t i=0;i<kMaxThunks;i++){
+        const size_t off = rvaToOffset(rva + (uint32_t)(i * width), width);
+        if(off == npos) break;
+        const uint64_t ent = plus ? r64le(p + off) : r32le(p + off);
+        if(ent == 0) break;
+        PEImportedFunction f;
+        if(ent >> (width * 8 - 1)){
+            f.byOrdinal = true;
+            f.ordinal = (uint16_t)ent;
+            f.offset = off;
+        }else{
+            const uint32_t hintRva = (uint32_t)(ent & 0x7FFFFFFF);
+            const size_t h = rvaToOffset(hintRva, 2);
+            if(h == npos) continue;
+            f.ordinal = r16le(p + h);
+            f.name = cstrAt(p, n, h + 2, 2048);
+            f.offset = h;
+            if(f.name.empty()) continue;
+        }
+        out.push_back(f);
+    }
+}
+
+std::vector<PEImportModule> PEImage::imports() const {
+    std::vector<PEImportModule> out;
+    uint32_t rva, size;
+    if(directory(kImport, rva, size)){
+        for(size_t i=0;i<kMaxDescriptors;i++){
+            const size_t d = rvaToOffset(rva + (uint32_t)(i * 20), 20);
+            if(d == npos) break;
+            const uint32_t oft = r32le(p + d), nameRva = r32le(p + d + 12), ft = r32le(p + d + 16);
+            if(oft == 0 && nameRva == 0 && ft == 0) break;
+            PEImportModule m;
+            m.lib = stringAt(nameRva, 1024);
+            m.offset = d;
+            if(m.lib.empty()) continue;
+            if(oft || ft) readThunks(oft ? oft : ft, m.funcs);
+            out.push_back(std::move(m));
+        }
+    }
+    if(directory(kDelayImport, rva, size)){
+        for(size_t i=0;i<kMaxDescriptors;i++){
+            const size_t d = rvaToOffset(rva + (uint32_t)(i * 32), 32);
+            if(d == npos) break;
+            const uint32_t attrs = r32le(p + d), nameField = r32le(p + d + 4), intField = r32le(p + d + 16);
+            if(nameField == 0 && r32le(p + d + 12) == 0) break;
+            // Descriptors from old linkers hold virtual addresses instead of RVAs.
+            const uint32_t bias = (attrs & kDelayRvaBased) ? 0 : (uint32_t)base;
+            PEImportModule m;
+            m.kind = PEImportKind::Delay;
+            m.lib = stringAt(nameField - bias, 1024);
+            m.offset = d;
+            if(m.lib.empty()) continue;
+            // The delay-load IAT points at loader stubs until first use; only the name table has names.
+            if(intField) readThunks(intField - bias, m.funcs);
+            out.push_back(std::move(m));
+        }
+    }
+    if(directory(kBoundImport, rva, size)){
+        // The bound import directory sits in the headers, and module names are offsets from its start.
+        const size_t d = rvaToOffset(rva, size);
+        for(size_t pos = 0; d != npos && pos + 8 <= size; ){
+            const uint16_t nameOff = r16le(p + d + pos + 4);
+            const uint16_t refs = r16le(p + d + pos + 6);
+            if(r32le(p + d + pos) == 0 && nameOff == 0) break;
+            for(uint32_t k = 0; k <= refs && pos + 8 <= size; k++, pos += 8){
+                PEImportModule m;
+                m.kind = PEImportKind::Bound;
+                m.lib = cstrAt(p, n, d + r16le(p + d + pos + 4), 1024);
+                m.offset = d + pos;
+                if(!m.lib.empty()) out.push_back(std::move(m));
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<PEExport> PEImage::exports(std::string_view* dllName) const {
+    std::vector<PEExport> out;
+    uint32_t rva, size;
+    if(!directory(kExport, rva, size)) return out;
+    const size_t d = rvaToOffset(rva, 40);
+    if(d == npos) return out;
+    if(dllName) *dllName = stringAt(r32le(p + d + 12), 1024);
+    const uint32_t ordBase = r32le(p + d + 16);
+    const uint32_t nf = std::min(r32le(p + d + 20), kMaxExports);
+    const uint32_t nn = std::min(r32le(p + d + 24), kMaxExports);
+    const size_t funcs = nf ? rvaToOffset(r32le(p + d + 28), nf * 4) : npos;
+    if(funcs == npos) return out;
+    const size_t names = nn ? rvaToOffset(r32le(p + d + 32), nn * 4) : npos;
+    const size_t ords = nn ? rvaToOffset(r32le(p + d + 36), nn * 2) : npos;
+
+    auto make = [&](uint32_t i){
+        PEExport e;
+        e.ordinal = ordBase + i;
+        e.rva = r32le(p + funcs + (size_t)i * 4);
+        e.offset = funcs + (size_t)i * 4;
+        if(e.rva >= rva && e.rva - rva < size) e.forwarder = stringAt(e.rva, 1024);
+        return e;
+    };
+    std::vector<bool> named(nf, false);
+    if(names != npos && ords != npos){
+        for(uint32_t j=0;j<nn;j++){
+            const uint16_t i = r16le(p + ords + (size_t)j * 2);
+            if(i >= nf) continue;
+            const uint32_t nameRva = r32le(p + names + (size_t)j * 4);
+            const size_t no = rvaToOffset(nameRva);
+            PEExport e = make(i);
+            e.name = no == npos ? std::string_view() : cstrAt(p, n, no, 4096);
+            if(e.name.empty() || e.rva == 0) continue;
+            e.offset = no;
+            named[i] = true;
+            out.push_back(e);
+        }
+    }
+    for(uint32_t i=0;i<nf;i++){
+        if(named[i]) continue;
+        PEExport e = make(i);
+        if(e.rva) out.push_back(e);
+    }
+    return out;
+}
+
+bool PEImage::clrHeader(PEClrHeader& out) const {
+    uint32_t rva, size;
+    if(!directory(kClr, rva, size)) return false;
+    const size_t d = rvaToOffset(rva, 72);
+    if(d == npos || r32le(p + d) < 72) return false;
+    out.majorRuntime = r16le(p + d + 4);
+    out.minorRuntime = r16le(p + d + 6);
+    out.metadataRva = r32le(p + d + 8);
+    out.metadataSize = r32le(p + d + 12);
+    out.flags = r32le(p + d + 16);
+    out.entryPointToken = r32le(p + d + 20);
+    out.strongNameRva = r32le(p + d + 32);
+    out.strongNameSize = r32le(p + d + 36);
+    out.metadataOffset = out.metadataSize ? rvaToOffset(out.metadataRva, out.metadataSize) : npos;
+    return true;
+}
+
+std::vector<PECertificate> PEImage::certificates() const {
+    std::vector<PECertificate> out;
+    uint32_t off, size;
+    if(!directory(kSecurity, off, size) || off >= n || size > n - off) return out;
+    for(size_t pos = 0; pos + 8 <= size && out.size() < kMaxCertificates; ){
+        const uint32_t len = r32le(p + off + pos);
+        if(len < 8 || len > size - pos) break;
+        out.push_back({ r16le(p + off + pos + 4), r16le(p + off + pos + 6), off + pos + 8, (size_t)len - 8 });
+        pos += ((size_t)len + 7) & ~(size_t)7;
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace dyn {
+
+enum class PEImportKind { Regular, Delay, Bound };
+
+struct PEImportedFunction {
+    std::string_view name;  // empty when imported by ordinal
+    uint16_t ordinal = 0;   // ordinal, or the hint for imports by name
+    bool byOrdinal = false;
+    size_t offset = 0;      // file offset of the hint/name entry, or of the thunk for ordinals
+};
+
+// One DLL from the import, delay-load import or bound import directory. Bound entries only name
+// the module (and the modules it forwards to); their functions are in the regular imports.
+struct PEImportModule {
+    std::string_view lib;
+    PEImportKind kind = PEImportKind::Regular;
+    size_t offset = 0;      // file offset of the descriptor
+    std::vector<PEImportedFunction> funcs;
+};
+
+struct PEExport {
+    std::string_view name;       // empty for exports by ordinal only
+    std::string_view forwarder;  // "DLL.Function" when the export is forwarded
+    uint32_t ordinal = 0;
+    uint32_t rva = 0;
+    size_t offset = 0;           // file offset of the name, or of the address table entry
+};
+
+struct PEClrHeader {
+    uint16_t majorRuntime = 0;
+    uint16_t minorRuntime = 0;
+    uint32_t flags = 0;                 // COMIMAGE_FLAGS_*
+    uint32_t entryPointToken = 0;
+    uint32_t metadataRva = 0;
+    uint32_t metadataSize = 0;
+    size_t metadataOffset = 0;          // file offset of the metadata root, or PEImage::npos
+    uint32_t strongNameRva = 0;
+    uint32_t strongNameSize = 0;
+};
+
+// One WIN_CERTIFICATE entry of the security directory.
+struct PECertificate {
+    uint16_t revision = 0;
+    uint16_t type = 0;      // 2 = PKCS#7 SignedData (Authenticode)
+    size_t offset = 0;      // file offset of bCertificate
+    size_t size = 0;
+};
+
+// Read-only view of a PE image held in memory. The section table is indexed once, sorted by RVA,
+// so RVA translation is a binary search; names are string_views into the buffer, which must
+// outlive the image and everything returned from it.
+class PEImage {
+public:
+    static constexpr size_t npos = (size_t)-1;
+
+    enum Directory { kExport = 0, kImport = 1, kSecurity = 4, kBoundImport = 11, kDelayImport = 13, kClr = 14 };
+
+    explicit PEImage(const std::vector<unsigned char>& buf);
+
+    bool valid() const { return ok; }
+    bool pePlus() const { return plus; }
+    uint16_t machine() const { return mach; }
+    uint64_t imageBase() const { return base; }
+
+    // File offset of `len` bytes at `rva`, or npos when they are not all backed by the file.
+    size_t rvaToOffset(uint32_t rva, uint32_t len = 1) const;
+    // NUL-terminated string at `rva`, at most `max` bytes; empty if unterminated or unmapped.
+    std::string_view stringAt(uint32_t rva, size_t max = 4096) const;
+    bool directory(int index, uint32_t& rva, uint32_t& size) const;
+
+    // Regular imports first, then delay-load, then bound, each in directory order.
+    std::vector<PEImportModule> imports() const;
+    std::vector<PEExport> exports(std::string_view* dllName = nullptr) const;
+    bool clrHeader(PEClrHeader& out) const;
+    // The security directory is addressed by file offset and is not mapped by any section.
+    std::vector<PECertificate> certificates() const;
+    // File offset just past the headers and the raw data of every section; bytes after it are
+    // overlay (certificates, appended payloads).
+    size_t imageDataEnd() const { return dataEnd; }
+
+private:
+    struct Range {
+        uint32_t rva;
+        uint32_t size;      // bytes backed by the file
+        uint32_t rawPtr;
+    };
+
+    void readThunks(uint32_t rva, std::vector<PEImportedFunction>& out) const;
+
+    const unsigned char* p = nullptr;
+    size_t n = 0;
+    bool ok = false;
+    bool plus = false;
+    uint16_t mach = 0;
+    uint64_t base = 0;
+    uint32_t headerSize = 0;
+    size_t dataEnd = 0;
+    size_t dataDirs = 0;
+    uint32_t numDirs = 0;
+    std::vector<Range> index;
+};
+
+}
@@ -0,0 +1,138 @@
+#include "ParserPool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+extern "C" const TSLanguage *tree_sitter_java();
+extern "C" const TSLanguage *tree_sitter_python();
+extern "C" const TSLanguage *tree_sitter_cpp();
+
+namespace analyzers {
+
+namespace {
+
+constexpr uint32_t kInputChunk = 64u << 10;
+
+const char* readView(void* payload, uint32_t byteIndex, TSPoint, uint32_t* bytesRead){
+    const std::string_view& src = *static_cast<const std::string_view*>(payload);
+    if(byteIndex >= src.size()){ *bytesRead = 0; return ""; }
+    size_t n = src.size() - byteIndex;
+    *bytesRead = (uint32_t)(n < kInputChunk ? n : kInputChunk);
+    return src.data() + byteIndex;
+}
+
+const TSLanguage* languageFor(SourceLang lang){
+    switch(lang){
+        case SourceLang::Java:   return tree_sitter_java();
+        case SourceLang::Python: return tree_sitter_python();
+        default:                 return tree_sitter_cpp();
+    }
+}
+
+struct ThreadParsers {
+    TSParser* slots[3] = { nullptr, nullptr, nullptr };
+    ~ThreadParsers(){
+        for(auto* p : slots) if(p) ts_parser_delete(p);
+    }
+    TSParser* get(SourceLang lang){
+        TSParser*& p = slots[(int)lang];
+        if(p) return p;
+        p = ts_parser_new();
+        if(!ts_parser_set_language(p, languageFor(lang))){ ts_parser_delete(p); p = nullptr; }
+        return p;
+    }
+};
+
+}
+
+MappedFile::~MappedFile(){ close(); }
+
+void MappedFile::close(){
+#if !defined(_WIN32)
+    if(mapped && data) ::munmap(const_cast<char*>(data), len);
+#endif
+    data = nullptr; len = 0; mapped = false;
+    fallback.clear();
+}
+
+bool MappedFile::open(const std::string& path){
+    close();
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd >= 0){
+        struct stat st{};
+        if(::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)){
+            if(st.st_size == 0){ ::close(fd); return true; }
+            void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p != MAP_FAILED){
+#if defined(POSIX_MADV_SEQUENTIAL)
+                ::posix_madvise(p, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+                ::close(fd);
+                data = static_cast<const char*>(p);
+                len = (size_t)st.st_size;
+                mapped = true;
+                return true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+    std::ifstream in(path, std::ios::binary);
+    if(!in) return false;
+    fallback.assign(std::istreambuf_iterator<char>(in), {});
+    data = fallback.data();
+    len = fallback.size();
+    return true;
+}
+
+TSTree* ParserPool::parse(SourceLang lang, std::string_view src, const TSTree* old){
+    if(src.empty() || src.size() > std::numeric_limits<uint32_t>::max()) return nullptr;
+    thread_local ThreadParsers parsers;
+    TSParser* parser = parsers.get(lang);
+    if(!parser) return nullptr;
+    TSInput input{};
+    input.payload = &src;
+    input.read = readView;
+    input.encoding = TSInputEncodingUTF8;
+    TSTree* tree = ts_parser_parse(parser, old, input);
+    ts_parser_reset(parser);
+    return tree;
+}
+
+const TSQuery* ParserPool::compileQuery(SourceLang lang, const char* source){
+    uint32_t errOff = 0;
+    TSQueryError err = TSQueryErrorNone;
+    return ts_query_new(languageFor(lang), source, (uint32_t)std::strlen(source), &errOff, &err);
+}
+
+std::uint32_t ParserPool::captureIndex(const TSQuery* query, const char* name){
+    const uint32_t n = ts_query_capture_count(query);
+    for(uint32_t i = 0; i < n; ++i){
+        uint32_t len = 0;
+        const char* c = ts_query_capture_name_for_id(query, i, &len);
+        if(std::string_view(c, len) == name) return i;
+    }
+    return UINT32_MAX;
+}
+
+TSQueryCursor* ParserPool::cursor(){
+    struct Holder {
+        TSQueryCursor* c = ts_query_cursor_new();
+        ~Holder(){ ts_query_cursor_delete(c); }
+    };
+    thread_local Holder h;
+    return h.c;
+}
+
+}
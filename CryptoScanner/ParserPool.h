@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tree_sitter/api.h>
+
+namespace analyzers {
+
+enum class SourceLang { Java, Python, Cpp };
+
+// Read-only view of a whole file: mmap on POSIX, a single read elsewhere.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    std::string_view view() const { return std::string_view(data, len); }
+
+private:
+    void close();
+
+    const char* data = nullptr;
+    std::size_t len = 0;
+    bool mapped = false;
+    std::string fallback;
+};
+
+// One parser per language per thread, created on first use and reset after every parse.
+// The source is fed through a TSInput, so callers never copy it into a std::string.
+class ParserPool {
+public:
+    // With `old` (already adjusted by ts_tree_edit) the parse reuses its unchanged subtrees.
+    static TSTree* parse(SourceLang lang, std::string_view src, const TSTree* old = nullptr);
+
+    // Meant to be held in a function-local static so each query is compiled once per process.
+    static const TSQuery* compileQuery(SourceLang lang, const char* source);
+    static std::uint32_t captureIndex(const TSQuery* query, const char* name);
+    // Thread-local cursor, reused across files.
+    static TSQueryCursor* cursor();
+};
+
+inline std::string_view nodeView(TSNode n, std::string_view src){
+    std::uint32_t a = ts_node_start_byte(n), b = ts_node_end_byte(n);
+    if(b > src.size()) b = (std::uint32_t)src.size();
+    if(a > b) a = b;
+    return src.substr(a, b - a);
+}
+
+}
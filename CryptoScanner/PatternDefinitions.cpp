@@ -43,7 +43,7 @@ std::vector<pattern_loader::AstRule> getDefaultASTRules() {
         AstRule r; r.id="java_cipher_getInstance_weak"; r.lang="java"; r.kind="call_fullname+arg"; r.callee="Cipher.getInstance"; r.arg_index=0; r.arg_regex="(?i)(AES/ECB|DES/ECB|DES$|DESede/ECB|RC4|ARCFOUR|ARC4)"; r.message="Weak/ECB cipher mode"; r.severity="high"; v.push_back(r);
     }
     {
-        AstRule r; r.id="java_kpg_rsa_1024"; r.lang="java"; r.kind="call_fullname+arg"; r.callee="KeyPairGenerator.initialize"; r.arg_index=0; r.arg_regex="\\b1024\\b"; r.message="RSA 1024-bit"; r.severity="med"; v.push_back(r);
+        AstRule r; r.id="java_kpg_rsa_1024"; r.lang="java"; r.kind="call+arg"; r.callees={"KeyPairGenerator.initialize","initialize"}; r.arg_index=0; r.arg_regex="^(512|768|1024)$"; r.message="RSA 1024-bit"; r.severity="med"; v.push_back(r);
     }
 
     {
@@ -58,6 +58,12 @@ std::vector<pattern_loader::AstRule> getDefaultASTRules() {
     {
         AstRule r; r.id="py_des_arc4"; r.lang="python"; r.kind="call"; r.callees={"DES.new","ARC4.new","Crypto.Cipher.DES.new","Cryptodome.Cipher.DES.new"}; r.message="DES/RC4 usage"; r.severity="high"; v.push_back(r);
     }
+    {
+        AstRule r; r.id="py_aes_ecb"; r.lang="python"; r.kind="call+arg"; r.callees={"AES.new"}; r.arg_index=1; r.arg_regex="MODE_ECB"; r.message="AES in ECB mode"; r.severity="high"; v.push_back(r);
+    }
+    {
+        AstRule r; r.id="py_rsa_small_key"; r.lang="python"; r.kind="call+kw"; r.callees={"rsa.generate_private_key"}; r.kw="key_size"; r.kw_value_regex="^(512|768|1024)$"; r.message="RSA key size below 2048"; r.severity="med"; v.push_back(r);
+    }
 
     return v;
 }
@@ -8,6 +8,8 @@
 struct AlgorithmPattern {
     std::string name;
     std::regex  pattern;
+    std::string source;     // ECMAScript text of the pattern; empty for other syntaxes
+    std::vector<std::string> samples;   // example matches, checked by the self-test
 };
 
 struct BytePattern {
@@ -16,6 +18,16 @@ struct BytePattern {
     std::string type;
 };
 
+// A lookup table compiled into crypto code (S-box, round constants, ...), given as a sequence
+// of 8-, 32- or 64-bit words; see analyzers::ConstantScanner.
+struct ConstantPattern {
+    std::string name;
+    unsigned wordBytes = 4;
+    std::vector<uint64_t> words;
+    double minMatch = 0.9;
+    std::string severity;
+};
+
 namespace pattern_loader { struct AstRule; }
 
 namespace crypto_patterns {
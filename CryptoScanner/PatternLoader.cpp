@@ -31,6 +31,16 @@ static bool getBool(const QJsonObject& o, const char* key, bool dflt=false){
     return it->toBool();
 }
 
+static std::string escapeRegexLiteral(const std::string& pat){
+    static const std::string metas = R"(\\.^$|()[]{}*+?!)";
+    std::string esc; esc.reserve(pat.size()*2);
+    for(char ch: pat){
+        if (metas.find(ch) != std::string::npos) esc.push_back('\\');
+        esc.push_back(ch);
+    }
+    return esc;
+}
+
 static std::optional<std::regex> compileRegexSafe(const std::string& pat,
                                                   bool icase,
                                                   bool literal,
@@ -42,16 +52,7 @@ static std::optional<std::regex> compileRegexSafe(const std::string& pat,
     if (syntax == "basic")    flags = std::regex_constants::basic;
     if (icase) flags = static_cast<std::regex_constants::syntax_option_type>(flags | std::regex_constants::icase);
 
-    std::string actual = pat;
-    if (literal) {
-        static const std::string metas = R"(\\.^$|()[]{}*+?!)";
-        std::string esc; esc.reserve(actual.size()*2);
-        for(char ch: actual){
-            if (metas.find(ch) != std::string::npos) esc.push_back('\\');
-            esc.push_back(ch);
-        }
-        actual.swap(esc);
-    }
+    std::string actual = literal ? escapeRegexLiteral(pat) : pat;
 
     try {
         return std::regex(actual, flags);
@@ -84,6 +85,27 @@ static std::vector<uint8_t> parseHexBytes(const std::string& s){
     return out;
 }
 
+static std::vector<uint64_t> parseHexWords(const std::string& s, bool& ok){
+    std::vector<uint64_t> out;
+    std::string tok;
+    ok = true;
+    auto flush = [&](){
+        if (tok.empty()) return;
+        if (tok.size() > 16) ok = false;
+        else out.push_back(std::stoull(tok, nullptr, 16));
+        tok.clear();
+    };
+    for(size_t i=0;i<s.size();++i){
+        const char c = s[i];
+        if (c=='0' && i+1<s.size() && (s[i+1]=='x' || s[i+1]=='X') && tok.empty()){ ++i; continue; }
+        if (std::isxdigit(static_cast<unsigned char>(c))) tok.push_back(c);
+        else if (c==' ' || c==',' || c=='\n' || c=='\t') flush();
+        else ok = false;
+    }
+    flush();
+    return out;
+}
+
 } // namespace
 
 namespace pattern_loader {
@@ -139,6 +161,12 @@ LoadResult loadFromJsonFile(const std::string& path){
                 AlgorithmPattern ap;
                 ap.name    = name;
                 ap.pattern = std::move(*rx);
+                if (syntax != "extended" && syntax != "basic") ap.source = literal ? escapeRegexLiteral(pat) : pat;
+                if (o.contains("samples") && o["samples"].isArray()){
+                    for(const auto& vv : o["samples"].toArray()){
+                        if(vv.isString()) ap.samples.push_back(qs(vv.toString()));
+                    }
+                }
                 R.regexPatterns.push_back(std::move(ap));
             }else{
                 warn << "[regex] skip '" << name << "': " << why << "\n";
@@ -168,6 +196,34 @@ LoadResult loadFromJsonFile(const std::string& path){
         }
     }
 
+    if (root.contains("constants") && root["constants"].isArray()){
+        for(const auto& v : root["constants"].toArray()){
+            if(!v.isObject()) continue;
+            const auto o = v.toObject();
+
+            ConstantPattern cp;
+            cp.name      = getString(o, "name", "");
+            cp.severity  = getString(o, "severity", "med");
+            const int bits = o.contains("word_bits") ? o["word_bits"].toInt(32) : 32;
+            cp.minMatch  = o.contains("min_match") ? o["min_match"].toDouble(0.9) : 0.9;
+            if(cp.name.empty()) continue;
+            if(bits != 8 && bits != 32 && bits != 64){
+                warn << "[constants] bad word_bits for '" << cp.name << "'\n";
+                continue;
+            }
+            cp.wordBytes = (unsigned)bits / 8;
+            bool ok = true;
+            cp.words = parseHexWords(getString(o, "words", ""), ok);
+            const uint64_t limit = bits == 64 ? ~0ull : ((1ull << bits) - 1);
+            for(uint64_t w : cp.words) if(w > limit) ok = false;
+            if(ok && cp.words.size() * cp.wordBytes >= 4 && cp.minMatch > 0 && cp.minMatch <= 1){
+                R.constantPatterns.push_back(std::move(cp));
+            }else{
+                warn << "[constants] skip '" << cp.name << "'\n";
+            }
+        }
+    }
+
     if (root.contains("ast_rules") && root["ast_rules"].isArray()){
         for(const auto& v : root["ast_rules"].toArray()){
             if(!v.isObject()) continue;
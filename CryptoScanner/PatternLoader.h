@@ -29,6 +29,7 @@ struct AstRule {
 struct LoadResult {
     std::vector<AlgorithmPattern> regexPatterns;
     std::vector<BytePattern>      bytePatterns;
+    std::vector<ConstantPattern>  constantPatterns;
     std::vector<AstRule>          astRules;
     std::string                   sourcePath;
     std::string                   error;
@@ -0,0 +1,350 @@
+#include "ScanGovernor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace governor {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const auto kPollSlice = std::chrono::milliseconds(50);
+
+thread_local PageCacheGuard* g_activeCacheGuard = nullptr;
+
+#if defined(__linux__)
+static bool residentPages(int fd, std::uint64_t size, std::vector<unsigned char>& vec){
+    if(fd < 0 || size == 0) return false;
+    void* p = mmap(nullptr, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED) return false;
+    long psz = sysconf(_SC_PAGESIZE);
+    vec.assign((size_t)((size + (std::uint64_t)psz - 1) / (std::uint64_t)psz), 0);
+    bool ok = mincore(p, (size_t)size, vec.data()) == 0;
+    munmap(p, (size_t)size);
+    return ok;
+}
+
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassShift = 13;
+constexpr int kIoprioClassIdle  = 3;
+
+static int ioprioGet(){
+#ifdef SYS_ioprio_get
+    return (int)syscall(SYS_ioprio_get, kIoprioWhoProcess, 0);
+#else
+    return -1;
+#endif
+}
+
+static bool ioprioSet(int v){
+#ifdef SYS_ioprio_set
+    return syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, v) == 0;
+#else
+    (void)v;
+    return false;
+#endif
+}
+#endif
+
+}
+
+void TokenBucket::setRate(std::uint64_t perSec){
+    std::lock_guard<std::mutex> lk(m);
+    if(ratePerSec == 0) last = Clock::now();
+    ratePerSec = perSec;
+    tokens = std::min(tokens, (double)perSec);
+}
+
+std::uint64_t TokenBucket::rate() const {
+    std::lock_guard<std::mutex> lk(m);
+    return ratePerSec;
+}
+
+bool TokenBucket::acquire(std::uint64_t n, const std::function<bool()>& abort){
+    auto refill = [this](){
+        auto now = Clock::now();
+        double dt = std::chrono::duration<double>(now - last).count();
+        last = now;
+        tokens = std::min((double)ratePerSec, tokens + dt * (double)ratePerSec);
+    };
+    {
+        std::lock_guard<std::mutex> lk(m);
+        if(ratePerSec == 0) return true;
+        refill();
+        tokens -= (double)n;
+        if(tokens >= 0.0) return true;
+    }
+    for(;;){
+        if(abort && abort()) return false;
+        std::this_thread::sleep_for(kPollSlice);
+        std::lock_guard<std::mutex> lk(m);
+        if(ratePerSec == 0) return true;
+        refill();
+        if(tokens >= 0.0) return true;
+    }
+}
+
+void IoThrottle::setBudget(std::uint64_t bytesPerSec, std::uint64_t filesPerSec){
+    bytes.setRate(bytesPerSec);
+    files.setRate(filesPerSec);
+}
+
+bool IoThrottle::beforeFile(std::uint64_t fileBytes, const std::function<bool()>& abort){
+    if(!files.acquire(1, abort)) return false;
+    return bytes.acquire(fileBytes, abort);
+}
+
+bool waitWhilePaused(const std::function<bool()>& isPaused, const std::function<bool()>& isCancelled){
+    while(isPaused && isPaused()){
+        if(isCancelled && isCancelled()) return false;
+        std::this_thread::sleep_for(kPollSlice * 2);
+    }
+    return !(isCancelled && isCancelled());
+}
+
+void MemoryBudget::setLimit(std::uint64_t bytes){
+    std::lock_guard<std::mutex> lk(m);
+    cap = bytes;
+    cv.notify_all();
+}
+
+std::uint64_t MemoryBudget::limit() const {
+    std::lock_guard<std::mutex> lk(m);
+    return cap;
+}
+
+std::uint64_t MemoryBudget::reserve(std::uint64_t n, const std::function<bool()>& abort, std::uint64_t heldAbove){
+    if(n == 0) return 0;
+    std::unique_lock<std::mutex> lk(m);
+    stalled += heldAbove;
+    if(heldAbove) cv.notify_all();
+    for(;;){
+        bool fits = cap == 0 || used + n <= cap || used == 0 || (heldAbove && used <= stalled);
+        if(fits) break;
+        if(abort && abort()){
+            stalled -= heldAbove;
+            return 0;
+        }
+        cv.wait_for(lk, kPollSlice);
+    }
+    stalled -= heldAbove;
+    used += n;
+    high = std::max(high, used);
+    return n;
+}
+
+void MemoryBudget::release(std::uint64_t n){
+    if(n == 0) return;
+    std::lock_guard<std::mutex> lk(m);
+    used = n > used ? 0 : used - n;
+    cv.notify_all();
+}
+
+std::uint64_t MemoryBudget::current() const {
+    std::lock_guard<std::mutex> lk(m);
+    return used;
+}
+
+std::uint64_t MemoryBudget::peak() const {
+    std::lock_guard<std::mutex> lk(m);
+    return high;
+}
+
+void MemoryBudget::resetPeak(){
+    std::lock_guard<std::mutex> lk(m);
+    high = used;
+}
+
+MemoryReservation::MemoryReservation(MemoryBudget* b, std::uint64_t n, const std::function<bool()>& abort,
+                                     const MemoryReservation* parent)
+    : budget(b), requested(n), above(parent ? parent->chainHeld() : 0) {
+    if(budget) held = budget->reserve(n, abort, above);
+}
+
+MemoryReservation::~MemoryReservation(){
+    release();
+}
+
+void MemoryReservation::release(){
+    if(budget) budget->release(held);
+    held = 0;
+}
+
+std::uint64_t defaultMemoryBudget(){
+    std::uint64_t phys = 0;
+#if defined(_WIN32)
+    MEMORYSTATUSEX ms{};
+    ms.dwLength = sizeof(ms);
+    if(GlobalMemoryStatusEx(&ms)) phys = (std::uint64_t)ms.ullTotalPhys;
+#elif defined(__APPLE__)
+    std::uint64_t mem = 0; size_t len = sizeof(mem);
+    if(sysctlbyname("hw.memsize", &mem, &len, nullptr, 0) == 0) phys = mem;
+#elif defined(__linux__)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long psz = sysconf(_SC_PAGESIZE);
+    if(pages > 0 && psz > 0) phys = (std::uint64_t)pages * (std::uint64_t)psz;
+#endif
+    if(phys == 0) return 1ull << 30;
+    return phys / 4;
+}
+
+PageCacheGuard::PageCacheGuard(const std::string& path, bool track, bool drop)
+    : filePath(path) {
+    prev = g_activeCacheGuard;
+    g_activeCacheGuard = this;
+    if(!track) return;
+#if defined(__linux__)
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return;
+    struct stat st{};
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){ ::close(fd); fd = -1; return; }
+    size = (std::uint64_t)st.st_size;
+    if(!residentPages(fd, size, before)){ ::close(fd); fd = -1; return; }
+    dropPages = drop;
+#else
+    (void)drop;
+#endif
+}
+
+PageCacheGuard::~PageCacheGuard(){
+    finish();
+    g_activeCacheGuard = prev;
+}
+
+PageCacheGuard* PageCacheGuard::current(){
+    return g_activeCacheGuard;
+}
+
+void PageCacheGuard::dropBehind(std::uint64_t off, std::uint64_t len){
+#if defined(__linux__)
+    if(fd < 0 || !dropPages || len == 0) return;
+    const std::uint64_t psz = (std::uint64_t)sysconf(_SC_PAGESIZE);
+    std::uint64_t first = off / psz;
+    std::uint64_t last = std::min<std::uint64_t>((off + len + psz - 1) / psz, before.size());
+    std::uint64_t runStart = first;
+    for(std::uint64_t pg = first; pg <= last; ++pg){
+        bool keep = pg == last || (before[(size_t)pg] & 1);
+        if(keep){
+            if(pg > runStart) posix_fadvise(fd, (off_t)(runStart * psz), (off_t)((pg - runStart) * psz), POSIX_FADV_DONTNEED);
+            runStart = pg + 1;
+        }
+    }
+#else
+    (void)off; (void)len;
+#endif
+}
+
+std::uint64_t PageCacheGuard::finish(){
+    if(finished) return residual;
+    finished = true;
+#if defined(__linux__)
+    if(fd < 0) return residual;
+    dropBehind(0, size);
+    std::vector<unsigned char> after;
+    if(residentPages(fd, size, after)){
+        const std::uint64_t psz = (std::uint64_t)sysconf(_SC_PAGESIZE);
+        std::uint64_t pages = 0;
+        for(size_t i = 0; i < after.size() && i < before.size(); ++i){
+            if((after[i] & 1) && !(before[i] & 1)) ++pages;
+        }
+        residual = std::min(pages * psz, size);
+    }
+    ::close(fd);
+    fd = -1;
+#endif
+    return residual;
+}
+
+bool readFileDropBehind(PageCacheGuard& guard, std::vector<unsigned char>& out){
+#if defined(__linux__)
+    int fd = ::open(guard.path().c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return false;
+    struct stat st{};
+    if(fstat(fd, &st) != 0){ ::close(fd); return false; }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    const std::uint64_t chunk = 1ull << 20;
+    out.clear();
+    out.resize((size_t)st.st_size);
+    std::uint64_t off = 0;
+    while(off < out.size()){
+        std::uint64_t want = std::min<std::uint64_t>(chunk, out.size() - off);
+        ssize_t r = ::pread(fd, out.data() + off, (size_t)want, (off_t)off);
+        if(r < 0 && errno == EINTR) continue;
+        if(r <= 0) break;
+        guard.dropBehind(off, (std::uint64_t)r);
+        off += (std::uint64_t)r;
+    }
+    out.resize((size_t)off);
+    ::close(fd);
+    return true;
+#else
+    (void)guard; (void)out;
+    return false;
+#endif
+}
+
+BackgroundPriorityScope::BackgroundPriorityScope(bool enable){
+    if(!enable) return;
+#if defined(_WIN32)
+    active = SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) != 0;
+#elif defined(__APPLE__)
+    savedIoPrio = getiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD);
+    active = setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, IOPOL_THROTTLE) == 0;
+#elif defined(__linux__)
+    // pid 0 is the calling thread for both calls on Linux.
+    savedPolicy = sched_getscheduler(0);
+    sched_param sp{};
+    if(savedPolicy >= 0 && sched_getparam(0, &sp) == 0){
+        savedPriority = sp.sched_priority;
+        sched_param idle{};
+        idle.sched_priority = 0;
+        schedChanged = sched_setscheduler(0, SCHED_IDLE, &idle) == 0;
+        if(!schedChanged) std::cerr << "[ScanGovernor] Warning: SCHED_IDLE not applied: " << std::strerror(errno) << "\n";
+    }
+    savedIoPrio = ioprioGet();
+    ioprioChanged = savedIoPrio >= 0 && ioprioSet(kIoprioClassIdle << kIoprioClassShift);
+    active = schedChanged || ioprioChanged;
+#endif
+}
+
+BackgroundPriorityScope::~BackgroundPriorityScope(){
+    if(!active) return;
+#if defined(_WIN32)
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+#elif defined(__APPLE__)
+    if(savedIoPrio >= 0) setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, savedIoPrio);
+#elif defined(__linux__)
+    if(schedChanged){
+        sched_param sp{};
+        sp.sched_priority = savedPriority;
+        // Leaving SCHED_IDLE needs RLIMIT_NICE headroom or CAP_SYS_NICE; without it the thread
+        // stays idle-class, which the pool threads can live with but the caller should know.
+        if(sched_setscheduler(0, savedPolicy, &sp) != 0)
+            std::cerr << "[ScanGovernor] Warning: scheduling policy not restored: " << std::strerror(errno) << "\n";
+    }
+    if(ioprioChanged && !ioprioSet(savedIoPrio))
+        std::cerr << "[ScanGovernor] Warning: I/O priority not restored: " << std::strerror(errno) << "\n";
+#endif
+}
+
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace governor {
+
+class TokenBucket {
+public:
+    void setRate(std::uint64_t perSec);
+    std::uint64_t rate() const;
+
+    // Takes n tokens, sleeping while the bucket is in debt. Returns false if abort() fired first.
+    bool acquire(std::uint64_t n, const std::function<bool()>& abort);
+
+private:
+    mutable std::mutex m;
+    std::uint64_t ratePerSec = 0;
+    double tokens = 0.0;
+    std::chrono::steady_clock::time_point last{};
+};
+
+class IoThrottle {
+public:
+    void setBudget(std::uint64_t bytesPerSec, std::uint64_t filesPerSec);
+    std::uint64_t bytesPerSec() const { return bytes.rate(); }
+    std::uint64_t filesPerSec() const { return files.rate(); }
+
+    bool beforeFile(std::uint64_t fileBytes, const std::function<bool()>& abort);
+
+private:
+    TokenBucket bytes;
+    TokenBucket files;
+};
+
+bool waitWhilePaused(const std::function<bool()>& isPaused, const std::function<bool()>& isCancelled);
+
+class MemoryBudget {
+public:
+    void setLimit(std::uint64_t bytes);
+    std::uint64_t limit() const;
+
+    // Blocks until n bytes fit. A request larger than the whole budget waits for an idle pool
+    // and then runs alone. heldAbove is what the caller already holds and keeps until this
+    // request is done (an enclosing archive's buffer); once every held byte belongs to such
+    // waiting callers nothing will be freed, so the request runs rather than deadlocking.
+    // Returns the number of bytes actually held (0 if abort() fired).
+    std::uint64_t reserve(std::uint64_t n, const std::function<bool()>& abort, std::uint64_t heldAbove = 0);
+    void release(std::uint64_t n);
+
+    std::uint64_t current() const;
+    std::uint64_t peak() const;
+    void resetPeak();
+
+private:
+    mutable std::mutex m;
+    std::condition_variable cv;
+    std::uint64_t cap = 0;
+    std::uint64_t used = 0;
+    std::uint64_t high = 0;
+    std::uint64_t stalled = 0;
+};
+
+class MemoryReservation {
+public:
+    // A reservation made while parent's bytes are still in use counts them as held above it.
+    MemoryReservation(MemoryBudget* budget, std::uint64_t n, const std::function<bool()>& abort,
+                      const MemoryReservation* parent = nullptr);
+    ~MemoryReservation();
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    bool ok() const { return !budget || requested == 0 || held > 0; }
+    // Bytes held by this reservation and the parents it was made under.
+    std::uint64_t chainHeld() const { return held + above; }
+    // Gives the bytes back early, once the buffer they cover is gone.
+    void release();
+
+private:
+    MemoryBudget* budget;
+    std::uint64_t requested;
+    std::uint64_t held = 0;
+    std::uint64_t above = 0;
+};
+
+std::uint64_t defaultMemoryBudget();
+
+constexpr std::uint64_t kCacheNeutralMinBytes = 1ull << 20;
+
+class PageCacheGuard {
+public:
+    PageCacheGuard(const std::string& path, bool track, bool drop);
+    ~PageCacheGuard();
+    PageCacheGuard(const PageCacheGuard&) = delete;
+    PageCacheGuard& operator=(const PageCacheGuard&) = delete;
+
+    // Evicts pages of [off, off+len) that were not cached before this guard was created.
+    void dropBehind(std::uint64_t off, std::uint64_t len);
+    // Drops what the scan pulled in and returns the bytes of the file it left in the page cache.
+    std::uint64_t finish();
+
+    const std::string& path() const { return filePath; }
+    static PageCacheGuard* current();
+
+private:
+    std::string filePath;
+    int fd = -1;
+    std::uint64_t size = 0;
+    bool dropPages = false;
+    bool finished = false;
+    std::uint64_t residual = 0;
+    std::vector<unsigned char> before;
+    PageCacheGuard* prev = nullptr;
+};
+
+bool readFileDropBehind(PageCacheGuard& guard, std::vector<unsigned char>& out);
+
+class BackgroundPriorityScope {
+public:
+    explicit BackgroundPriorityScope(bool enable);
+    ~BackgroundPriorityScope();
+    BackgroundPriorityScope(const BackgroundPriorityScope&) = delete;
+    BackgroundPriorityScope& operator=(const BackgroundPriorityScope&) = delete;
+
+private:
+    bool active = false;
+    bool schedChanged = false;
+    bool ioprioChanged = false;
+    int savedPolicy = 0;
+    int savedPriority = 0;
+    int savedIoPrio = -1;
+};
+
+}
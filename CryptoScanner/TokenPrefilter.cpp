@@ -0,0 +1,267 @@
+#include "TokenPrefilter.h"
+
+#include "ApiNameIndex.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define TOKEN_PREFILTER_SSSE3 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TOKEN_PREFILTER_NEON 1
+#endif
+
+namespace analyzers {
+
+namespace {
+
+using MaskTable = std::uint8_t[TokenPrefilter::kMaskSets][3][2][16];
+
+inline unsigned char fold(unsigned char c){
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c | 0x20) : c;
+}
+
+inline bool isAlpha(unsigned char c){
+    return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+inline bool isAlnum(unsigned char c){
+    return isAlpha(c) || (c >= '0' && c <= '9');
+}
+
+// Rough cost of a folded byte showing up in source text; the cheapest window is the most selective.
+int byteCost(unsigned char c){
+    static const char kByFrequency[] = "etaoinsrlcdhupmfgbywvkxqjz";
+    if(c >= 'a' && c <= 'z') return 36 - (int)(std::strchr(kByFrequency, c) - kByFrequency);
+    if(c == ' ' || c == '\t' || c == '\n') return 40;
+    if(c == '_' || c == '.' || c == '-' || c == '(') return 12;
+    if(c >= '0' && c <= '9') return 6;
+    return 3;
+}
+
+#if defined(TOKEN_PREFILTER_SSSE3)
+__attribute__((target("ssse3")))
+std::size_t scanSsse3(const unsigned char* p, std::size_t n, const MaskTable& masks,
+                      std::size_t& pos, std::uint8_t (*lanes)[16])
+{
+    const __m128i nib = _mm_set1_epi8(0x0F);
+    const __m128i aMinus = _mm_set1_epi8('A' - 1);
+    const __m128i zPlus = _mm_set1_epi8('Z' + 1);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    __m128i t[TokenPrefilter::kMaskSets][3][2];
+    for(int s = 0; s < TokenPrefilter::kMaskSets; ++s)
+        for(int k = 0; k < 3; ++k)
+            for(int h = 0; h < 2; ++h) t[s][k][h] = _mm_loadu_si128((const __m128i*)masks[s][k][h]);
+    while(pos + 18 <= n){
+        __m128i lo[3], hi[3];
+        for(int k = 0; k < 3; ++k){
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + pos + k));
+            __m128i up = _mm_and_si128(_mm_cmpgt_epi8(v, aMinus), _mm_cmplt_epi8(v, zPlus));
+            v = _mm_or_si128(v, _mm_and_si128(up, caseBit));
+            lo[k] = _mm_and_si128(v, nib);
+            hi[k] = _mm_and_si128(_mm_srli_epi16(v, 4), nib);
+        }
+        __m128i m[TokenPrefilter::kMaskSets];
+        __m128i any = _mm_setzero_si128();
+        for(int s = 0; s < TokenPrefilter::kMaskSets; ++s){
+            m[s] = _mm_and_si128(_mm_shuffle_epi8(t[s][0][0], lo[0]), _mm_shuffle_epi8(t[s][0][1], hi[0]));
+            for(int k = 1; k < 3; ++k){
+                m[s] = _mm_and_si128(m[s], _mm_and_si128(_mm_shuffle_epi8(t[s][k][0], lo[k]),
+                                                         _mm_shuffle_epi8(t[s][k][1], hi[k])));
+            }
+            any = _mm_or_si128(any, m[s]);
+        }
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF){
+            for(int s = 0; s < TokenPrefilter::kMaskSets; ++s) _mm_storeu_si128((__m128i*)lanes[s], m[s]);
+            return 16;
+        }
+        pos += 16;
+    }
+    return 0;
+}
+#endif
+
+#if defined(TOKEN_PREFILTER_NEON)
+std::size_t scanNeon(const unsigned char* p, std::size_t n, const MaskTable& masks,
+                     std::size_t& pos, std::uint8_t (*lanes)[16])
+{
+    const uint8x16_t nib = vdupq_n_u8(0x0F);
+    uint8x16_t t[TokenPrefilter::kMaskSets][3][2];
+    for(int s = 0; s < TokenPrefilter::kMaskSets; ++s)
+        for(int k = 0; k < 3; ++k)
+            for(int h = 0; h < 2; ++h) t[s][k][h] = vld1q_u8(masks[s][k][h]);
+    while(pos + 18 <= n){
+        uint8x16_t lo[3], hi[3];
+        for(int k = 0; k < 3; ++k){
+            uint8x16_t v = vld1q_u8(p + pos + k);
+            uint8x16_t up = vandq_u8(vcgeq_u8(v, vdupq_n_u8('A')), vcleq_u8(v, vdupq_n_u8('Z')));
+            v = vorrq_u8(v, vandq_u8(up, vdupq_n_u8(0x20)));
+            lo[k] = vandq_u8(v, nib);
+            hi[k] = vshrq_n_u8(v, 4);
+        }
+        uint8x16_t m[TokenPrefilter::kMaskSets];
+        uint8x16_t any = vdupq_n_u8(0);
+        for(int s = 0; s < TokenPrefilter::kMaskSets; ++s){
+            m[s] = vandq_u8(vqtbl1q_u8(t[s][0][0], lo[0]), vqtbl1q_u8(t[s][0][1], hi[0]));
+            for(int k = 1; k < 3; ++k){
+                m[s] = vandq_u8(m[s], vandq_u8(vqtbl1q_u8(t[s][k][0], lo[k]), vqtbl1q_u8(t[s][k][1], hi[k])));
+            }
+            any = vorrq_u8(any, m[s]);
+        }
+        if(vmaxvq_u8(any) != 0){
+            for(int s = 0; s < TokenPrefilter::kMaskSets; ++s) vst1q_u8(lanes[s], m[s]);
+            return 16;
+        }
+        pos += 16;
+    }
+    return 0;
+}
+#endif
+
+}
+
+const std::vector<std::string>& TokenPrefilter::builtinLiterals(){
+    static const std::vector<std::string> v = {
+        "hashlib", "Cipher", "MessageDigest", "KeyPairGenerator", "KeyGenerator", "SecretKeySpec", "Signature",
+        "Mac.getInstance", "javax.crypto", "java.security", "bouncycastle", "Crypto", "cryptography", "hazmat",
+        "EVP_", "HMAC", "RSA", "DSA", "ECDSA", "ECDH", "ECC", "EC_", "DH_", "Diffie", "ElGamal",
+        "MD2", "MD4", "MD5", "SHA", "AES", "DES", "3DES", "DESede", "TripleDES", "RC2", "RC4", "ARC4",
+        "ARCFOUR", "Blowfish", "Rijndael", "ECB", "CBC", "GCM", "CFB", "OFB",
+        "PKCS", "X509", "x25519", "ed25519", "x448", "ed448", "secp", "sect", "brainpool", "prime256v1",
+        "GOST", "Streebog", "gcry_", "mbedtls", "wolfSSL", "sodium", "pbkdf", "bcrypt", "scrypt",
+        "_mm_aes", "clmul", "ghash", "-----BEGIN", "65537", "0x10001", "486662", "156326",
+        "1.2.840.", "1.3.132.", "1.3.101.", "1.2.643.", "1.2.410.", "1.3.36."
+    };
+    return v;
+}
+
+std::vector<std::string> TokenPrefilter::patternLiterals(const std::vector<std::string>& sources,
+                                                         std::vector<std::size_t>* unguarded){
+    std::vector<std::string> out;
+    for(std::size_t i = 0; i < sources.size(); ++i){
+        std::vector<std::string> lits;
+        bool ok = !sources[i].empty() && ApiNameIndex::requiredLiterals(sources[i], lits);
+        for(const auto& l : lits) if(l.size() < 3) ok = false;
+        if(ok) out.insert(out.end(), lits.begin(), lits.end());
+        else if(unguarded) unguarded->push_back(i);
+    }
+    return out;
+}
+
+void TokenPrefilter::build(const std::vector<std::string>& literals){
+    lits.clear();
+    for(auto& b : bucketLits) b.clear();
+    std::memset(masks, 0, sizeof(masks));
+
+    std::vector<std::string> folded;
+    for(const auto& s : literals){
+        if(s.size() < 3) continue;
+        std::string f;
+        for(unsigned char c : s) f.push_back((char)fold(c));
+        folded.push_back(std::move(f));
+    }
+    std::sort(folded.begin(), folded.end());
+    folded.erase(std::unique(folded.begin(), folded.end()), folded.end());
+    if(folded.size() > 0xFFFF) folded.resize(0xFFFF);
+
+    for(const auto& f : folded){
+        Literal L;
+        L.folded = f;
+        L.wordLeft = f.size() <= 4 && isAlnum((unsigned char)f.front());
+        L.wordRight = f.size() <= 4 && isAlnum((unsigned char)f.back());
+        int best = 1 << 30;
+        for(std::size_t o = 0; o + 3 <= f.size() && o < 256; ++o){
+            const int c = byteCost((unsigned char)f[o]) + byteCost((unsigned char)f[o+1]) + byteCost((unsigned char)f[o+2]);
+            if(c < best){ best = c; L.window = (std::uint8_t)o; }
+        }
+        lits.push_back(std::move(L));
+    }
+
+    // Literals are bucketed in window order so each bucket's masks admit few byte combinations.
+    std::vector<std::uint16_t> order(lits.size());
+    for(std::size_t i = 0; i < order.size(); ++i) order[i] = (std::uint16_t)i;
+    std::sort(order.begin(), order.end(), [&](std::uint16_t a, std::uint16_t b){
+        return lits[a].folded.compare(lits[a].window, 3, lits[b].folded, lits[b].window, 3) < 0;
+    });
+    for(std::size_t rank = 0; rank < order.size(); ++rank){
+        const Literal& L = lits[order[rank]];
+        const std::size_t bucket = rank * kBuckets / order.size();
+        const int set = (int)(bucket / 8);
+        const std::uint8_t bit = (std::uint8_t)(1u << (bucket % 8));
+        bucketLits[bucket].push_back(order[rank]);
+        for(int k = 0; k < 3; ++k){
+            const unsigned char c = (unsigned char)L.folded[L.window + k];
+            masks[set][k][0][c & 15] |= bit;
+            masks[set][k][1][c >> 4] |= bit;
+        }
+    }
+}
+
+bool TokenPrefilter::verify(const unsigned char* p, std::size_t n, std::size_t pos, int set, std::uint8_t bits) const {
+    for(int b = 0; b < 8; ++b){
+        if(!(bits & (1u << b))) continue;
+        for(std::uint16_t li : bucketLits[set * 8 + b]){
+            const Literal& L = lits[li];
+            if(pos < L.window) continue;
+            const std::size_t start = pos - L.window;
+            const std::size_t len = L.folded.size();
+            if(start + len > n) continue;
+            std::size_t k = 0;
+            while(k < len && fold(p[start + k]) == (unsigned char)L.folded[k]) ++k;
+            if(k != len) continue;
+            if(L.wordLeft && start > 0 && isAlpha(p[start - 1])) continue;
+            if(L.wordRight && start + len < n && p[start + len] >= 'a' && p[start + len] <= 'z') continue;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TokenPrefilter::scanScalar(const unsigned char* p, std::size_t n, std::size_t from) const {
+    for(std::size_t i = from; i + 2 < n; ++i){
+        const unsigned char a = fold(p[i]), b = fold(p[i + 1]), c = fold(p[i + 2]);
+        for(int s = 0; s < kMaskSets; ++s){
+            const std::uint8_t m = (std::uint8_t)(masks[s][0][0][a & 15] & masks[s][0][1][a >> 4]
+                                                & masks[s][1][0][b & 15] & masks[s][1][1][b >> 4]
+                                                & masks[s][2][0][c & 15] & masks[s][2][1][c >> 4]);
+            if(m && verify(p, n, i, s, m)) return true;
+        }
+    }
+    return false;
+}
+
+bool TokenPrefilter::matches(std::string_view text) const {
+    if(lits.empty()) return true;
+    const unsigned char* p = (const unsigned char*)text.data();
+    const std::size_t n = text.size();
+    std::size_t pos = 0;
+#if defined(TOKEN_PREFILTER_SSSE3) || defined(TOKEN_PREFILTER_NEON)
+#if defined(TOKEN_PREFILTER_SSSE3)
+    static const bool simd = __builtin_cpu_supports("ssse3");
+#else
+    static const bool simd = true;
+#endif
+    if(simd){
+        alignas(16) std::uint8_t lanes[kMaskSets][16];
+        for(;;){
+#if defined(TOKEN_PREFILTER_SSSE3)
+            const std::size_t w = scanSsse3(p, n, masks, pos, lanes);
+#else
+            const std::size_t w = scanNeon(p, n, masks, pos, lanes);
+#endif
+            if(!w) break;
+            for(std::size_t l = 0; l < w; ++l){
+                for(int s = 0; s < kMaskSets; ++s){
+                    if(lanes[s][l] && verify(p, n, pos + l, s, lanes[s][l])) return true;
+                }
+            }
+            pos += w;
+        }
+    }
+#endif
+    return scanScalar(p, n, pos);
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace analyzers {
+
+// Case-insensitive multi-literal scan used to decide whether a source file is worth parsing.
+// Each literal contributes its least common three-byte window to per-bucket nibble masks; the
+// masks are probed 16 bytes at a time (SSSE3 or NEON, scalar otherwise) and candidates are
+// verified against the literals. Literals of four bytes or fewer must not sit inside a word:
+// when they begin with a letter or digit the byte before them must not be a letter, and when
+// they end with one the byte after must not be a lowercase letter ("dh_" admits "DH_check").
+class TokenPrefilter {
+public:
+    static constexpr int kMaskSets = 4;
+    static constexpr int kBuckets = kMaskSets * 8;
+
+    static const std::vector<std::string>& builtinLiterals();
+    // Literals required by the given regex sources (ApiNameIndex::requiredLiterals). Indices of
+    // sources with no literal of three bytes or more, which the prefilter cannot guard, are
+    // appended to `unguarded`.
+    static std::vector<std::string> patternLiterals(const std::vector<std::string>& sources,
+                                                    std::vector<std::size_t>* unguarded = nullptr);
+
+    void build(const std::vector<std::string>& literals);
+    bool empty() const { return lits.empty(); }
+    bool matches(std::string_view text) const;
+
+private:
+    struct Literal {
+        std::string folded;
+        std::uint8_t window = 0;
+        bool wordLeft = false;
+        bool wordRight = false;
+    };
+
+    bool verify(const unsigned char* p, std::size_t n, std::size_t pos, int set, std::uint8_t bits) const;
+    bool scanScalar(const unsigned char* p, std::size_t n, std::size_t from) const;
+
+    std::vector<Literal> lits;
+    std::vector<std::uint16_t> bucketLits[kBuckets];
+    // masks[set][window byte][0 = low nibble, 1 = high nibble][nibble value]
+    alignas(16) std::uint8_t masks[kMaskSets][3][2][16] = {};
+};
+
+}
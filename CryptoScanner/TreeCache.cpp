@@ -0,0 +1,288 @@
+#include "TreeCache.h"
+
+#include "ParserPool.h"
+#include "JavaASTScanner.h"
+#include "PythonASTScanner.h"
+#include "CppASTScanner.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace analyzers {
+
+namespace {
+
+// Rough heap cost of one syntax node; the tree-sitter API has no direct way to size a tree.
+const std::size_t kNodeBytes = 48;
+
+struct ByteRange {
+    std::size_t from, to;
+};
+
+std::uint64_t contentHash(std::string_view s){
+    std::uint64_t h = 1469598103934665603ull;
+    for(unsigned char c : s){ h ^= c; h *= 1099511628211ull; }
+    return h ^ s.size();
+}
+
+std::size_t countLines(std::string_view s){
+    return (std::size_t)std::count(s.begin(), s.end(), '\n');
+}
+
+TSPoint pointAt(std::string_view text, std::size_t off){
+    std::string_view head = text.substr(0, off);
+    const std::size_t nl = head.rfind('\n');
+    TSPoint p;
+    p.row = (uint32_t)countLines(head);
+    p.column = (uint32_t)(nl == std::string_view::npos ? off : off - nl - 1);
+    return p;
+}
+
+std::vector<AstSymbol> extract(SourceLang lang, const std::string& path, std::string_view code, const TSTree* tree,
+                               uint32_t from, uint32_t to, const CallSiteFilter& keep){
+    switch(lang){
+        case SourceLang::Java: return JavaASTScanner::collectFromTree(path, code, tree, from, to, keep);
+        case SourceLang::Python: return PythonASTScanner::collectFromTree(path, code, tree, from, to, keep);
+        case SourceLang::Cpp: return CppASTScanner::collectFromTree(path, code, tree, from, to, keep);
+    }
+    return {};
+}
+
+bool intersects(const AstSymbol& s, const std::vector<ByteRange>& ranges){
+    for(const auto& r : ranges){
+        if(s.startByte < r.to && r.from < s.endByte) return true;
+    }
+    return false;
+}
+
+std::size_t callBytes(const CachedCall& c){
+    std::size_t n = sizeof(CachedCall) + c.sym.callee_full.size() + c.sym.callee_base.size() + c.sym.first_arg.size();
+    for(const auto& a : c.sym.args) n += sizeof(a) + a.size();
+    for(const auto& kv : c.sym.kwargs) n += sizeof(kv) + kv.first.size() + kv.second.size();
+    for(const auto& f : c.findings) n += sizeof(f) + f.algorithm.size() + f.matchString.size();
+    return n;
+}
+
+}
+
+TreeCache& TreeCache::shared(){
+    static TreeCache cache;
+    return cache;
+}
+
+TreeCache::~TreeCache(){
+    clear();
+}
+
+void TreeCache::setBudget(std::size_t bytes){
+    std::lock_guard<std::mutex> lk(mu);
+    budget = bytes;
+    trimLocked();
+}
+
+TreeCache::Stats TreeCache::stats() const {
+    std::lock_guard<std::mutex> lk(mu);
+    return st;
+}
+
+void TreeCache::clear(){
+    std::lock_guard<std::mutex> lk(mu);
+    for(auto& e : lru) release(e);
+    lru.clear();
+    index.clear();
+    st.bytes = 0;
+}
+
+void TreeCache::release(Entry& e){
+    if(e.tree) ts_tree_delete(e.tree);
+    e.tree = nullptr;
+}
+
+bool TreeCache::checkout(const std::string& path, Entry& out){
+    std::lock_guard<std::mutex> lk(mu);
+    auto it = index.find(path);
+    if(it == index.end()) return false;
+    st.bytes -= it->second->bytes;
+    out = std::move(*it->second);
+    lru.erase(it->second);
+    index.erase(it);
+    return true;
+}
+
+void TreeCache::checkin(Entry&& e){
+    std::lock_guard<std::mutex> lk(mu);
+    auto it = index.find(e.path);
+    if(it != index.end()){
+        st.bytes -= it->second->bytes;
+        release(*it->second);
+        lru.erase(it->second);
+        index.erase(it);
+    }
+    st.bytes += e.bytes;
+    lru.push_front(std::move(e));
+    index[lru.front().path] = lru.begin();
+    trimLocked();
+}
+
+void TreeCache::trimLocked(){
+    while(!lru.empty() && st.bytes > budget){
+        Entry& victim = lru.back();
+        st.bytes -= victim.bytes;
+        release(victim);
+        index.erase(victim.path);
+        lru.pop_back();
+        ++st.evicted;
+    }
+}
+
+std::uint64_t TreeCache::fingerprint(std::string_view s, std::uint64_t seed){
+    return contentHash(s) ^ (seed * 1099511628211ull + 0x9e3779b97f4a7c15ull);
+}
+
+std::vector<CachedCall> TreeCache::scan(const std::string& path, SourceLang lang, std::string_view code, std::uint64_t rules,
+                                        const CallSiteFilter& keep, const CallEvaluator& evaluate){
+    if(code.empty() || code.size() >= std::numeric_limits<uint32_t>::max()) return {};
+    const std::uint64_t hash = contentHash(code);
+
+    Entry e;
+    bool cached = checkout(path, e);
+    // The call list depends on the filter and the findings on the rules, so neither the unchanged
+    // path nor the incremental one may reuse an entry built under another rule set.
+    if(cached && (e.lang != lang || e.rules != rules)){
+        release(e);
+        cached = false;
+    }
+    if(cached && e.hash == hash && e.text == code){
+        std::vector<CachedCall> out = e.calls;
+        {
+            std::lock_guard<std::mutex> lk(mu);
+            ++st.unchanged;
+            st.callsReused += out.size();
+        }
+        checkin(std::move(e));
+        return out;
+    }
+
+    std::vector<CachedCall> calls;
+    std::vector<AstSymbol> fresh;
+    TSTree* tree = nullptr;
+    bool incremental = false;
+    if(cached && e.tree){
+        const std::string_view old = e.text;
+        const std::size_t common = std::min(old.size(), code.size());
+        std::size_t pre = (std::size_t)(std::mismatch(old.begin(), old.begin() + common, code.begin()).first - old.begin());
+        std::size_t suf = 0;
+        while(suf < common - pre && old[old.size() - 1 - suf] == code[code.size() - 1 - suf]) ++suf;
+        const std::size_t oldEnd = old.size() - suf, newEnd = code.size() - suf;
+
+        TSInputEdit edit;
+        edit.start_byte = (uint32_t)pre;
+        edit.old_end_byte = (uint32_t)oldEnd;
+        edit.new_end_byte = (uint32_t)newEnd;
+        edit.start_point = pointAt(old, pre);
+        edit.old_end_point = pointAt(old, oldEnd);
+        edit.new_end_point = pointAt(code, newEnd);
+        ts_tree_edit(e.tree, &edit);
+        tree = ParserPool::parse(lang, code, e.tree);
+        if(tree){
+            incremental = true;
+            std::vector<ByteRange> dirty;
+            uint32_t n = 0;
+            TSRange* changed = ts_tree_get_changed_ranges(e.tree, tree, &n);
+            for(uint32_t i = 0; i < n; ++i) dirty.push_back({ changed[i].start_byte, changed[i].end_byte });
+            std::free(changed);
+            // Structure can stay the same while a token's text changes, so the edit itself is always dirty.
+            dirty.push_back({ pre, std::max(newEnd, pre + 1) });
+
+            const std::ptrdiff_t byteDelta = (std::ptrdiff_t)newEnd - (std::ptrdiff_t)oldEnd;
+            const std::ptrdiff_t lineDelta = (std::ptrdiff_t)countLines(code.substr(pre, newEnd - pre))
+                                           - (std::ptrdiff_t)countLines(old.substr(pre, oldEnd - pre));
+            const TSNode root = ts_tree_root_node(tree);
+            std::vector<ByteRange> spans;
+            for(auto& c : e.calls){
+                AstSymbol& s = c.sym;
+                if(s.endByte <= pre){
+                    // before the edit, unchanged
+                }else if(s.startByte >= oldEnd){
+                    s.startByte = (std::size_t)((std::ptrdiff_t)s.startByte + byteDelta);
+                    s.endByte = (std::size_t)((std::ptrdiff_t)s.endByte + byteDelta);
+                    s.line = (std::size_t)((std::ptrdiff_t)s.line + lineDelta);
+                }else{
+                    // The edit falls inside this call; whatever replaced it is looked for again.
+                    const std::size_t to = s.endByte >= oldEnd ? (std::size_t)((std::ptrdiff_t)s.endByte + byteDelta) : newEnd;
+                    dirty.push_back({ std::min(s.startByte, pre), std::max(to, pre + 1) });
+                    continue;
+                }
+                const TSNode n = ts_node_descendant_for_byte_range(root, (uint32_t)s.startByte, (uint32_t)s.endByte);
+                if(intersects(s, dirty) || ts_node_start_byte(n) != s.startByte || ts_node_end_byte(n) != s.endByte){
+                    dirty.push_back({ s.startByte, s.endByte });
+                    continue;
+                }
+                spans.push_back({ s.startByte, s.endByte });
+                calls.push_back(std::move(c));
+            }
+            std::sort(dirty.begin(), dirty.end(), [](const ByteRange& a, const ByteRange& b){ return a.from < b.from; });
+            std::vector<ByteRange> merged;
+            for(const auto& r : dirty){
+                if(!merged.empty() && r.from <= merged.back().to) merged.back().to = std::max(merged.back().to, r.to);
+                else merged.push_back(r);
+            }
+            std::sort(spans.begin(), spans.end(), [](const ByteRange& a, const ByteRange& b){
+                return a.from != b.from ? a.from < b.from : a.to < b.to;
+            });
+            for(const auto& r : merged){
+                for(auto& s : extract(lang, path, code, tree, (uint32_t)r.from, (uint32_t)std::min(r.to, code.size()), keep)){
+                    const ByteRange key{ s.startByte, s.endByte };
+                    const auto kept = std::lower_bound(spans.begin(), spans.end(), key, [](const ByteRange& a, const ByteRange& b){
+                        return a.from != b.from ? a.from < b.from : a.to < b.to;
+                    });
+                    if(kept != spans.end() && kept->from == key.from && kept->to == key.to) continue;
+                    // Ranges are queried separately, so a call spanning two of them comes back twice.
+                    bool dup = false;
+                    for(const auto& f : fresh){
+                        if(f.startByte == s.startByte && f.endByte == s.endByte){ dup = true; break; }
+                    }
+                    if(!dup) fresh.push_back(std::move(s));
+                }
+            }
+        }
+    }
+    release(e);
+    if(!tree){
+        calls.clear();
+        tree = ParserPool::parse(lang, code);
+        if(!tree) return {};
+        fresh = extract(lang, path, code, tree, 0, UINT32_MAX, keep);
+    }
+
+    for(auto& s : fresh){
+        CachedCall c;
+        c.findings = evaluate ? evaluate(s) : std::vector<AstFinding>();
+        c.sym = std::move(s);
+        calls.push_back(std::move(c));
+    }
+    std::stable_sort(calls.begin(), calls.end(), [](const CachedCall& a, const CachedCall& b){
+        return a.sym.startByte < b.sym.startByte;
+    });
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        if(incremental) ++st.incremental; else ++st.full;
+        st.callsEvaluated += fresh.size();
+        st.callsReused += calls.size() - fresh.size();
+    }
+
+    e.path = path;
+    e.lang = lang;
+    e.hash = hash;
+    e.rules = rules;
+    e.text.assign(code.data(), code.size());
+    e.tree = tree;
+    e.calls = calls;
+    e.bytes = sizeof(Entry) + path.size() + e.text.size() + (std::size_t)ts_node_descendant_count(ts_tree_root_node(tree)) * kNodeBytes;
+    for(const auto& c : e.calls) e.bytes += callBytes(c);
+    checkin(std::move(e));
+    return calls;
+}
+
+}
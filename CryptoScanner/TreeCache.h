@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ASTSymbol.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct TSTree;
+
+namespace analyzers {
+
+enum class SourceLang;
+
+struct CachedCall {
+    AstSymbol sym;
+    std::vector<AstFinding> findings;
+};
+
+using CallEvaluator = std::function<std::vector<AstFinding>(const AstSymbol&)>;
+
+// Syntax trees of recently scanned sources, keyed by path and content hash, in an LRU bounded by
+// an estimate of their memory use. Each entry also keeps the source text and the call sites found
+// in it together with their findings. A changed file is diffed against the cached text, the old
+// tree is edited with ts_tree_edit and reparsed incrementally, and only call sites intersecting the
+// edit or the ranges whose structure changed are extracted and evaluated again; the rest are
+// carried over with their lines shifted. Entries also record the rule set their findings came
+// from; a scan under different rules rebuilds the entry instead of returning stale findings.
+class TreeCache {
+public:
+    struct Stats {
+        std::uint64_t unchanged = 0;
+        std::uint64_t incremental = 0;
+        std::uint64_t full = 0;
+        std::uint64_t callsReused = 0;
+        std::uint64_t callsEvaluated = 0;
+        std::uint64_t evicted = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    // Process-wide instance, so the trees outlive a single CryptoScanner.
+    static TreeCache& shared();
+
+    TreeCache() = default;
+    ~TreeCache();
+    TreeCache(const TreeCache&) = delete;
+    TreeCache& operator=(const TreeCache&) = delete;
+
+    void setBudget(std::size_t bytes);
+    // `rules` identifies the rule set behind `keep` and `evaluate` (see fingerprint()).
+    std::vector<CachedCall> scan(const std::string& path, SourceLang lang, std::string_view code, std::uint64_t rules,
+                                 const CallSiteFilter& keep, const CallEvaluator& evaluate);
+    static std::uint64_t fingerprint(std::string_view s, std::uint64_t seed = 0);
+    Stats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::string path;
+        SourceLang lang;
+        std::uint64_t hash = 0;
+        std::uint64_t rules = 0;
+        std::string text;
+        TSTree* tree = nullptr;
+        std::vector<CachedCall> calls;
+        std::size_t bytes = 0;
+    };
+    using Lru = std::list<Entry>;
+
+    bool checkout(const std::string& path, Entry& out);
+    void checkin(Entry&& e);
+    void trimLocked();
+    static void release(Entry& e);
+
+    mutable std::mutex mu;
+    Lru lru;
+    std::unordered_map<std::string, Lru::iterator> index;
+    std::size_t budget = 64u << 20;
+    Stats st;
+};
+
+}
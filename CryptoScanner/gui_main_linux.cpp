@@ -39,14 +39,17 @@
 class ScanWorker : public QObject {
     Q_OBJECT
 public:
-    ScanWorker(const QString& root, bool recurse, bool deepJar)
-        : m_root(root), m_recurse(recurse), m_deepJar(deepJar) {}
+    ScanWorker(const QString& root, bool recurse, bool deepJar, bool lowImpact)
+        : m_root(root), m_recurse(recurse), m_deepJar(deepJar), m_lowImpact(lowImpact) {}
 public slots:
     void run(){
         CryptoScanner scanner;
         ScanOptions opt;
         opt.recurse = m_recurse;
         opt.deepJar = m_deepJar;
+        opt.lowImpact = m_lowImpact;
+        opt.cacheNeutral = m_lowImpact;
+        opt.astTreeCacheBytes = m_lowImpact ? 0 : (64ull << 20);
         auto onDetect = [&](const Detection& d){
             emit detected(QString::fromStdString(d.filePath),
                           (qulonglong)d.offset,
@@ -71,6 +74,7 @@ private:
     QString m_root;
     bool m_recurse;
     bool m_deepJar;
+    bool m_lowImpact;
     std::atomic<bool> m_cancel{false};
 };
 
@@ -123,8 +127,11 @@ public:
         checkRecurse->setChecked(true);
         checkDeepJar = new QCheckBox("JAR 내부까지");
         checkDeepJar->setChecked(true);
+        checkLowImpact = new QCheckBox("저부하 모드");
+        checkLowImpact->setChecked(false);
         optRow->addWidget(checkRecurse);
         optRow->addWidget(checkDeepJar);
+        optRow->addWidget(checkLowImpact);
         optRow->addStretch(1);
         layout->addLayout(optRow);
         table = new QTableWidget(0, 6);
@@ -185,7 +192,7 @@ private slots:
             workerThread=nullptr;
         }
         workerThread = new QThread(this);
-        worker = new ScanWorker(p, checkRecurse->isChecked(), checkDeepJar->isChecked());
+        worker = new ScanWorker(p, checkRecurse->isChecked(), checkDeepJar->isChecked(), checkLowImpact->isChecked());
         worker->moveToThread(workerThread);
         connect(workerThread, &QThread::started, worker, &ScanWorker::run);
         connect(worker, &ScanWorker::detected, this, &MainWindow::onDetected, Qt::QueuedConnection);
@@ -367,6 +374,7 @@ private:
     QLabel *status{};
     QCheckBox *checkRecurse{};
     QCheckBox *checkDeepJar{};
+    QCheckBox *checkLowImpact{};
     QPushButton *btnScan{};
     QPushButton *btnExportCsv{};
     QPushButton *btnCancel{};
@@ -159,6 +159,22 @@ $CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c JavaASTScanner.cpp -o J
 $CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c PythonASTScanner.cpp -o PythonASTScanner.o
 $CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c CppASTScanner.cpp -o CppASTScanner.o
 $CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c DynLinkParser.cpp -o DynLinkParser.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c ScanGovernor.cpp -o ScanGovernor.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c DeviceScheduler.cpp -o DeviceScheduler.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c ContainerReader.cpp -o ContainerReader.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c ParserPool.cpp -o ParserPool.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c AstRuleEngine.cpp -o AstRuleEngine.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c TokenPrefilter.cpp -o TokenPrefilter.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c LexerScanner.cpp -o LexerScanner.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c TreeCache.cpp -o TreeCache.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c ArtifactExporter.cpp -o ArtifactExporter.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c ConstantScanner.cpp -o ConstantScanner.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c InsnScanner.cpp -o InsnScanner.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c PEImage.cpp -o PEImage.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c ApiNameIndex.cpp -o ApiNameIndex.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c LibraryResolver.cpp -o LibraryResolver.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c DotNetMetadata.cpp -o DotNetMetadata.o
+$CXX_COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -c GoBinaryScanner.cpp -o GoBinaryScanner.o
 
 echo "Step 3: Linking..."
 # Select appropriate compiler and flags based on platform
@@ -181,7 +197,7 @@ echo "Using compiler: $COMPILER"
 # Link everything
 $COMPILER -std=c++17 -O2 -o CryptoScannerCLI \
     main_gui_cli.o CryptoScanner.o FileScanner.o PatternLoader.o PatternDefinitions.o \
-    JavaBytecodeScanner.o JavaASTScanner.o PythonASTScanner.o CppASTScanner.o DynLinkParser.o \
+    JavaBytecodeScanner.o JavaASTScanner.o PythonASTScanner.o CppASTScanner.o DynLinkParser.o ScanGovernor.o DeviceScheduler.o ContainerReader.o ParserPool.o AstRuleEngine.o TokenPrefilter.o LexerScanner.o TreeCache.o ArtifactExporter.o ConstantScanner.o InsnScanner.o PEImage.o ApiNameIndex.o LibraryResolver.o DotNetMetadata.o GoBinaryScanner.o \
     third_party/miniz/miniz.o third_party/miniz/miniz_zip.o third_party/miniz/miniz_tinfl.o third_party/miniz/miniz_tdef.o \
     third_party/tree-sitter/lib/src/lib.o \
     third_party/tree-sitter-cpp/src/parser.o third_party/tree-sitter-cpp/src/scanner.o \
@@ -190,4 +206,16 @@ $COMPILER -std=c++17 -O2 -o CryptoScannerCLI \
     $LIBS
 
 echo "Build completed successfully: CryptoScannerCLI"
-echo "Binary size: $(ls -lh CryptoScannerCLI | awk '{print $5}')"
\ No newline at end of file
+echo "Binary size: $(ls -lh CryptoScannerCLI | awk '{print $5}')"
+
+echo "Step 4: Building self-test..."
+$COMPILER -std=c++17 $COMMON_CFLAGS $ALL_INCLUDES -o CryptoScannerSelfTest tests/SelfTest.cpp \
+    CryptoScanner.o FileScanner.o PatternLoader.o PatternDefinitions.o \
+    JavaBytecodeScanner.o JavaASTScanner.o PythonASTScanner.o CppASTScanner.o DynLinkParser.o ScanGovernor.o DeviceScheduler.o ContainerReader.o ParserPool.o AstRuleEngine.o TokenPrefilter.o LexerScanner.o TreeCache.o ArtifactExporter.o ConstantScanner.o InsnScanner.o PEImage.o ApiNameIndex.o LibraryResolver.o DotNetMetadata.o GoBinaryScanner.o \
+    third_party/miniz/miniz.o third_party/miniz/miniz_zip.o third_party/miniz/miniz_tinfl.o third_party/miniz/miniz_tdef.o \
+    third_party/tree-sitter/lib/src/lib.o \
+    third_party/tree-sitter-cpp/src/parser.o third_party/tree-sitter-cpp/src/scanner.o \
+    third_party/tree-sitter-java/src/parser.o \
+    third_party/tree-sitter-python/src/parser.o third_party/tree-sitter-python/src/scanner.o \
+    $LIBS -lpthread
+echo "Run ./CryptoScannerSelfTest from this directory to check the build"
\ No newline at end of file
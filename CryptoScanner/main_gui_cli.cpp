@@ -1,5 +1,6 @@
 #include "CryptoScanner.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
 #include <iomanip>
@@ -9,12 +10,31 @@ namespace fs = std::filesystem;
 
 int main(int argc, char* argv[]) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <path>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <path> [--cache-neutral] [--lexer-only] [--export-artifacts[=DIR]]"
+                  << " [--low-impact] [--max-bytes-per-sec=N] [--max-files-per-sec=N] [--pause-file=PATH]"
+                  << " [--memory-budget-mb=N]" << std::endl;
         return 1;
     }
 
     std::string targetPath = argv[1];
     CryptoScanner scanner;
+    std::uint64_t maxBytesPerSec = 0, maxFilesPerSec = 0;
+    for (int i = 2; i < argc; ++i) {
+        if (std::string(argv[i]) == "--cache-neutral") scanner.setCacheNeutral(true);
+        if (std::string(argv[i]) == "--lexer-only") scanner.setLexerOnly(true);
+        if (std::string(argv[i]) == "--export-artifacts") scanner.setExportArtifacts(true);
+        if (std::string(argv[i]).rfind("--export-artifacts=", 0) == 0) scanner.setExportArtifacts(true, std::string(argv[i]).substr(19));
+        if (std::string(argv[i]) == "--low-impact") scanner.setLowImpact(true);
+        if (std::string(argv[i]).rfind("--max-bytes-per-sec=", 0) == 0) maxBytesPerSec = std::strtoull(argv[i] + 20, nullptr, 10);
+        if (std::string(argv[i]).rfind("--max-files-per-sec=", 0) == 0) maxFilesPerSec = std::strtoull(argv[i] + 20, nullptr, 10);
+        if (std::string(argv[i]).rfind("--pause-file=", 0) == 0) {
+            // The scan holds before its next file while this file exists.
+            const std::string pauseFile = std::string(argv[i]).substr(13);
+            scanner.setPauseCheck([pauseFile] { std::error_code ec; return fs::exists(pauseFile, ec); });
+        }
+        if (std::string(argv[i]).rfind("--memory-budget-mb=", 0) == 0) scanner.setMemoryBudget(std::strtoull(argv[i] + 19, nullptr, 10) << 20);
+    }
+    scanner.setThrottle(maxBytesPerSec, maxFilesPerSec);
 
     // Check if path exists
     if (!fs::exists(targetPath)) {
@@ -28,7 +48,7 @@ int main(int argc, char* argv[]) {
         if (fs::is_regular_file(targetPath)) {
             // File scan
             std::cout << "PROGRESS:FILE:" << targetPath << ":0:1" << std::endl;
-            results = scanner.scanFileDetailed(targetPath);
+            results = scanner.scanPathRecursive(targetPath);
             std::cout << "PROGRESS:FILE:" << targetPath << ":1:1" << std::endl;
         } else if (fs::is_directory(targetPath)) {
             // Directory scan with progress reporting
@@ -45,7 +65,7 @@ int main(int argc, char* argv[]) {
         }
 
         // Output results in CSV format
-        // Format: filePath,offset,algorithm,matchString,evidenceType,severity
+        // Format: filePath,offset,algorithm,matchString,evidenceType,severity,section
         for (const auto& detection : results) {
             std::cout << "DETECTION:"
                       << detection.filePath << ","
@@ -53,7 +73,8 @@ int main(int argc, char* argv[]) {
                       << detection.algorithm << ","
                       << detection.matchString << ","
                       << detection.evidenceType << ","
-                      << detection.severity << std::endl;
+                      << detection.severity << ","
+                      << detection.section << std::endl;
         }
 
 skip_detection_output:
@@ -80,6 +101,22 @@ skip_detection_output:
         }
         std::cout << "SUMMARY:FILES:" << uniqueFiles.size() << std::endl;
 
+        scanner.finishExport();
+        ScanStats stats = scanner.scanStats();
+        std::cout << "SUMMARY:MEMORY:budget:" << stats.memBudgetBytes << std::endl;
+        std::cout << "SUMMARY:MEMORY:current:" << stats.memReservedBytes << std::endl;
+        std::cout << "SUMMARY:MEMORY:peak:" << stats.memReservedPeak << std::endl;
+        std::cout << "SUMMARY:PAGECACHE:left:" << stats.pageCacheLeftBytes << std::endl;
+        std::cout << "SUMMARY:PAGECACHE:files:" << stats.pageCacheTrackedFiles << std::endl;
+        std::cout << "SUMMARY:AST:parsed:" << stats.astParses << std::endl;
+        std::cout << "SUMMARY:AST:skipped:" << stats.astParsesSkipped << std::endl;
+        std::cout << "SUMMARY:AST:lexed:" << stats.astLexed << std::endl;
+        std::cout << "SUMMARY:EXPORT:written:" << stats.artifactsExported << std::endl;
+        std::cout << "SUMMARY:EXPORT:deduped:" << stats.artifactsDeduped << std::endl;
+        std::cout << "SUMMARY:EXPORT:disassembled:" << stats.artifactsDisassembled << std::endl;
+        std::cout << "SUMMARY:LIBRARIES:analysed:" << stats.elfObjectsAnalysed << std::endl;
+        std::cout << "SUMMARY:LIBRARIES:reused:" << stats.libraryResultsReused << std::endl;
+
         return 0;
 
     } catch (const std::exception& e) {
@@ -0,0 +1,318 @@
+// Regression checks for the scanner core, built by mac_linux_amd_arm.sh as CryptoScannerSelfTest.
+// Run from the CryptoScanner directory so patterns.json is found; exits non-zero on failure.
+
+#include "CryptoScanner.h"
+#include "DynLinkParser.h"
+#include "JavaBytecodeScanner.h"
+#include "ParserPool.h"
+#include "PatternLoader.h"
+#include "TokenPrefilter.h"
+#include "TreeCache.h"
+#include "third_party/miniz/miniz.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); ++failures; } } while (0)
+
+static void putLE(std::vector<unsigned char>& out, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back((unsigned char)(v >> (8 * i)));
+}
+
+static void putBE(std::vector<unsigned char>& out, std::uint64_t v, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) out.push_back((unsigned char)(v >> (8 * i)));
+}
+
+// Stored (uncompressed) zip; the bundled miniz is built without its writer.
+static std::vector<unsigned char> storedZip(const std::vector<std::pair<std::string, std::vector<unsigned char>>>& entries) {
+    std::vector<unsigned char> out, central;
+    for (const auto& e : entries) {
+        const std::uint32_t crc = (std::uint32_t)mz_crc32(MZ_CRC32_INIT, e.second.data(), e.second.size());
+        const std::size_t local = out.size();
+        putLE(out, 0x04034b50, 4); putLE(out, 20, 2); putLE(out, 0, 2); putLE(out, 0, 2);
+        putLE(out, 0, 4); putLE(out, crc, 4); putLE(out, e.second.size(), 4); putLE(out, e.second.size(), 4);
+        putLE(out, e.first.size(), 2); putLE(out, 0, 2);
+        out.insert(out.end(), e.first.begin(), e.first.end());
+        out.insert(out.end(), e.second.begin(), e.second.end());
+        putLE(central, 0x02014b50, 4); putLE(central, 20, 2); putLE(central, 20, 2); putLE(central, 0, 2); putLE(central, 0, 2);
+        putLE(central, 0, 4); putLE(central, crc, 4); putLE(central, e.second.size(), 4); putLE(central, e.second.size(), 4);
+        putLE(central, e.first.size(), 2); putLE(central, 0, 2); putLE(central, 0, 2); putLE(central, 0, 2); putLE(central, 0, 2);
+        putLE(central, 0, 4); putLE(central, local, 4);
+        central.insert(central.end(), e.first.begin(), e.first.end());
+    }
+    const std::size_t cdOff = out.size();
+    out.insert(out.end(), central.begin(), central.end());
+    putLE(out, 0x06054b50, 4); putLE(out, 0, 2); putLE(out, 0, 2);
+    putLE(out, entries.size(), 2); putLE(out, entries.size(), 2);
+    putLE(out, central.size(), 4); putLE(out, cdOff, 4); putLE(out, 0, 2);
+    return out;
+}
+
+static fs::path scratchDir(const std::string& name) {
+    fs::path d = fs::temp_directory_path() / ("cryptoscanner_selftest_" + name);
+    std::error_code ec;
+    fs::remove_all(d, ec);
+    fs::create_directories(d, ec);
+    return d;
+}
+
+static void writeFile(const fs::path& p, const std::vector<unsigned char>& data) {
+    std::ofstream f(p, std::ios::binary);
+    f.write((const char*)data.data(), (std::streamsize)data.size());
+}
+
+// Runs a scan on its own thread so a scan that blocks fails the check instead of the whole run.
+static bool scanWithin(const fs::path& root, const ScanOptions& opt, std::vector<Detection>& out, int seconds) {
+    auto scanner = std::make_shared<CryptoScanner>();
+    auto found = std::make_shared<std::vector<Detection>>();
+    std::packaged_task<void()> task([scanner, found, root, opt]() {
+        scanner->scanPathLikeAntivirus(root.string(), opt, [&](const Detection& d) { found->push_back(d); },
+                                       [](const std::string&, std::uint64_t, std::uint64_t, std::uint64_t, std::uint64_t) {},
+                                       []() { return false; });
+    });
+    auto done = task.get_future();
+    std::thread(std::move(task)).detach();
+    if (done.wait_for(std::chrono::seconds(seconds)) != std::future_status::ready) return false;
+    out = *found;
+    return true;
+}
+
+// A nested jar whose size plus that of its own entry exceeds the memory budget used to wait
+// forever for the budget it was itself holding.
+static void testNestedArchiveUnderSmallBudget() {
+    std::string java = "import java.security.MessageDigest;\nclass A {\n    byte[] h(byte[] b) throws Exception {\n"
+                       "        return MessageDigest.getInstance(\"MD5\").digest(b);\n    }\n}\n";
+    java.append(600 * 1024, ' ');
+    const auto inner = storedZip({ { "A.java", std::vector<unsigned char>(java.begin(), java.end()) } });
+    const auto outer = storedZip({ { "lib/inner.jar", inner } });
+    const fs::path dir = scratchDir("nested");
+    writeFile(dir / "outer.jar", outer);
+
+    ScanOptions opt;
+    opt.memoryBudgetBytes = 1ull << 20;
+    opt.resolveLibraries = false;
+    std::vector<Detection> found;
+    const bool finished = scanWithin(dir, opt, found, 60);
+    CHECK(finished);
+    bool md5 = false;
+    for (const auto& d : found) {
+        if (d.filePath.find("inner.jar::A.java") != std::string::npos && d.algorithm.find("MD5") != std::string::npos) md5 = true;
+    }
+    CHECK(md5);
+}
+
+// An inner archive's buffer stays reserved while its entries are read: a child reservation
+// made under a parent that fills the budget must go through rather than wait on its own
+// parent, and both must be counted meanwhile.
+static void testNestedReservationKeepsParentCounted() {
+    governor::MemoryBudget budget;
+    budget.setLimit(1000);
+    governor::MemoryReservation outer(&budget, 900, nullptr);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    auto gaveUp = [deadline] { return std::chrono::steady_clock::now() > deadline; };
+    {
+        governor::MemoryReservation inner(&budget, 500, gaveUp, &outer);
+        CHECK(inner.ok());
+        CHECK(budget.current() == 1400);
+    }
+    CHECK(budget.current() == 900);
+}
+
+static void putAt(std::vector<unsigned char>& b, std::size_t off, std::uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) b[off + i] = (unsigned char)(v >> (8 * i));
+}
+
+// ELF64 little-endian header with one PT_LOAD and an empty section header table slot.
+static std::vector<unsigned char> minimalElf64() {
+    std::vector<unsigned char> b(4096, 0);
+    const unsigned char ident[] = { 0x7f, 'E', 'L', 'F', 2, 1, 1 };
+    std::copy(std::begin(ident), std::end(ident), b.begin());
+    putAt(b, 0x10, 3, 2);       // ET_DYN
+    putAt(b, 0x12, 62, 2);      // x86-64
+    putAt(b, 0x20, 64, 8);      // e_phoff
+    putAt(b, 0x28, 1024, 8);    // e_shoff
+    putAt(b, 0x34, 64, 2);      // e_ehsize
+    putAt(b, 0x36, 56, 2);      // e_phentsize
+    putAt(b, 0x38, 1, 2);       // e_phnum
+    putAt(b, 0x3A, 64, 2);      // e_shentsize
+    putAt(b, 0x3C, 1, 2);       // e_shnum
+    putAt(b, 64, 1, 4);         // PT_LOAD
+    putAt(b, 64 + 4, 5, 4);     // R+X
+    putAt(b, 64 + 32, b.size(), 8);
+    return b;
+}
+
+static void parseAllElf(const std::vector<unsigned char>& b) {
+    auto sections = dyn::parseELFSections(b);
+    dyn::parseELFImports(b);
+    dyn::parseELFFunctions(b, sections);
+    dyn::DynamicInfo info;
+    dyn::parseELFDynamic(b, info);
+}
+
+// Header offsets near 2^64 used to wrap the bounds checks and read far outside the buffer.
+static void testElfHeaderOffsetsFuzz() {
+    const std::vector<unsigned char> base = minimalElf64();
+    const std::uint64_t huge[] = { std::numeric_limits<std::uint64_t>::max(), std::numeric_limits<std::uint64_t>::max() - 31,
+                                   std::numeric_limits<std::uint64_t>::max() - 63, 1ull << 63, base.size() - 1, base.size() };
+    for (std::uint64_t v : huge) {
+        for (std::size_t field : { (std::size_t)0x20, (std::size_t)0x28 }) {
+            auto b = base;
+            putAt(b, field, v, 8);
+            parseAllElf(b);
+            putAt(b, 0x3C, 0, 2);   // e_shnum 0: the count is read from section 0
+            putAt(b, 0x38, 0xFFFF, 2);
+            parseAllElf(b);
+        }
+    }
+    std::mt19937_64 rng(0x5eed);
+    for (int round = 0; round < 5000; ++round) {
+        auto b = base;
+        const int edits = 1 + (int)(rng() % 4);
+        for (int e = 0; e < edits; ++e) {
+            const std::size_t at = 0x10 + rng() % (64 + 56 - 0x10);
+            if (rng() % 2) b[at] = (unsigned char)rng();
+            else putAt(b, at & ~(std::size_t)7, rng(), 8);
+        }
+        parseAllElf(b);
+    }
+    CHECK(!dyn::parseELFSections(base).empty());
+}
+
+// Every sample in patterns.json must match its regex and get past the source prefilter; only
+// patterns without a literal of three bytes or more may go unguarded.
+static void testPrefilterAdmitsPatternSamples() {
+    const auto LR = pattern_loader::loadFromJson();
+    CHECK(LR.error.empty());
+    std::vector<std::string> sources;
+    for (const auto& ap : LR.regexPatterns) sources.push_back(ap.source);
+    std::vector<std::size_t> unguarded;
+    std::vector<std::string> literals = analyzers::TokenPrefilter::builtinLiterals();
+    const auto derived = analyzers::TokenPrefilter::patternLiterals(sources, &unguarded);
+    literals.insert(literals.end(), derived.begin(), derived.end());
+    analyzers::TokenPrefilter prefilter;
+    prefilter.build(literals);
+
+    std::vector<std::string> unguardedNames;
+    for (std::size_t i : unguarded) unguardedNames.push_back(LR.regexPatterns[i].name);
+    CHECK((unguardedNames == std::vector<std::string>{ "X25519 basepoint u=9", "X448 basepoint u=5" }));
+    for (std::size_t i = 0; i < LR.regexPatterns.size(); ++i) {
+        const auto& ap = LR.regexPatterns[i];
+        CHECK(!ap.samples.empty());
+        const bool guarded = std::find(unguarded.begin(), unguarded.end(), i) == unguarded.end();
+        for (const auto& s : ap.samples) {
+            if (!std::regex_search(s, ap.pattern)) std::fprintf(stderr, "sample '%s' does not match '%s'\n", s.c_str(), ap.name.c_str());
+            CHECK(std::regex_search(s, ap.pattern));
+            const std::string line = "    x = " + s + ";\n";
+            if (guarded && !prefilter.matches(line)) std::fprintf(stderr, "prefilter rejects '%s' ('%s')\n", s.c_str(), ap.name.c_str());
+            CHECK(!guarded || prefilter.matches(line));
+        }
+    }
+    for (const char* call : { "DH_check(dh,&codes)", "DH_generate_parameters_ex(dh, 2048, 2, NULL)", "CertOpenStore(p, 0, 0, 0, s)",
+                              "curve25519_generate()", "\"dhparam\"", "md5sum" })
+        CHECK(prefilter.matches(std::string("    ") + call + ";\n"));
+    CHECK(!prefilter.matches("int main() { return printf(\"hello\"); }\n"));
+}
+
+// An unchanged source scanned under another rule set must be evaluated again, not served from
+// the findings cached under the old rules.
+static void testTreeCacheKeyedByRuleSet() {
+    analyzers::TreeCache cache;
+    const std::string code = "import hashlib\nh = hashlib.md5(b'x')\n";
+    auto keepAll = [](std::string_view, std::string_view) { return true; };
+    auto findingNamed = [](const char* name) {
+        return [name](const AstSymbol&) { return std::vector<AstFinding>{ { name, "md5", "ast", "med" } }; };
+    };
+    auto first = cache.scan("k.py", analyzers::SourceLang::Python, code, 1, keepAll, findingNamed("old rule"));
+    auto again = cache.scan("k.py", analyzers::SourceLang::Python, code, 1, keepAll, findingNamed("unused"));
+    auto changed = cache.scan("k.py", analyzers::SourceLang::Python, code, 2, keepAll, findingNamed("new rule"));
+    CHECK(!first.empty() && !first[0].findings.empty() && first[0].findings[0].algorithm == "old rule");
+    CHECK(!again.empty() && !again[0].findings.empty() && again[0].findings[0].algorithm == "old rule");
+    CHECK(!changed.empty() && !changed[0].findings.empty() && changed[0].findings[0].algorithm == "new rule");
+}
+
+// test_exe/weakcrypto_linux has a GNU hash table whose only bucket is empty, so the hash table
+// alone would put the symbol count at its symoffset; the imports must still be listed with and
+// without section headers to size .dynsym.
+static void testElfImportsWithEmptyGnuHash() {
+    std::ifstream in("test_exe/weakcrypto_linux", std::ios::binary);
+    std::vector<unsigned char> elf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    CHECK(dyn::isELF(elf));
+    auto stripped = elf;
+    if (stripped.size() > 0x40) putAt(stripped, 0x28, 0, 8);   // e_shoff 0
+    for (const auto* b : { &elf, &stripped }) {
+        const auto syms = dyn::parseELFImports(*b);
+        auto has = [&](const char* name, const char* version) {
+            return std::any_of(syms.begin(), syms.end(), [&](const dyn::ImportedSymbol& s) { return s.name == name && s.version == version; });
+        };
+        CHECK(has("MD5_Init", "OPENSSL_3.0.0"));
+        CHECK(has("DES_set_key", "OPENSSL_3.0.0"));
+        CHECK(has("abort", "GLIBC_2.17"));
+    }
+}
+
+// A class with MessageDigest.getInstance fed "MD5" by ldc, and "SHA1" loaded but only popped:
+// the weak-digest finding names the literal the call receives, at its constant pool entry.
+static void testGetInstanceLiteralTiedToCall() {
+    std::vector<unsigned char> c = { 0xCA, 0xFE, 0xBA, 0xBE, 0, 0, 0, 52, 0, 11 };
+    auto utf8 = [&](const std::string& s) { c.push_back(1); putBE(c, s.size(), 2); c.insert(c.end(), s.begin(), s.end()); };
+    auto ref = [&](unsigned char tag, std::uint16_t a) { c.push_back(tag); putBE(c, a, 2); };
+    const std::size_t md5At = c.size() + 1;
+    utf8("MD5");                                                   // #1
+    ref(8, 1);                                                     // #2 String MD5
+    utf8("java/security/MessageDigest");                           // #3
+    ref(7, 3);                                                     // #4 Class
+    utf8("getInstance");                                           // #5
+    utf8("(Ljava/lang/String;)Ljava/security/MessageDigest;");     // #6
+    ref(12, 5); putBE(c, 6, 2);                                    // #7 NameAndType
+    ref(10, 4); putBE(c, 7, 2);                                    // #8 Methodref
+    utf8("SHA1");                                                  // #9
+    ref(8, 9);                                                     // #10 String SHA1
+    const std::vector<unsigned char> code = { 0x12, 2, 0xB8, 0, 8, 0x57, 0x12, 10, 0x57, 0xB1 };
+    c.insert(c.end(), code.begin(), code.end());
+
+    const auto rules = analyzers::ClassRuleTable::build({});
+    std::vector<const Detection*> weak;
+    const auto found = analyzers::JavaBytecodeScanner::scanClassBytes("T.class", c, *rules);
+    for (const auto& d : found) {
+        if (d.algorithm.rfind("Java: MessageDigest.getInstance", 0) == 0) weak.push_back(&d);
+    }
+    CHECK(weak.size() == 1);
+    if (!weak.empty()) {
+        CHECK(weak[0]->matchString == "MD5");
+        CHECK(weak[0]->offset == md5At);
+    }
+}
+
+int main() {
+    testNestedArchiveUnderSmallBudget();
+    testNestedReservationKeepsParentCounted();
+    testElfHeaderOffsetsFuzz();
+    testPrefilterAdmitsPatternSamples();
+    testTreeCacheKeyedByRuleSet();
+    testElfImportsWithEmptyGnuHash();
+    testGetInstanceLiteralTiedToCall();
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        std::_Exit(1);
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
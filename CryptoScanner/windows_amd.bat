@@ -76,6 +76,22 @@ echo     JavaASTScanner.cpp \
 echo     PythonASTScanner.cpp \
 echo     CppASTScanner.cpp \
 echo     DynLinkParser.cpp \
+echo     ScanGovernor.cpp \
+echo     DeviceScheduler.cpp \
+echo     ContainerReader.cpp \
+echo     ParserPool.cpp \
+echo     AstRuleEngine.cpp \
+echo     TokenPrefilter.cpp \
+echo     LexerScanner.cpp \
+echo     TreeCache.cpp \
+echo     ArtifactExporter.cpp \
+echo     ConstantScanner.cpp \
+echo     InsnScanner.cpp \
+echo     PEImage.cpp \
+echo     ApiNameIndex.cpp \
+echo     LibraryResolver.cpp \
+echo     DotNetMetadata.cpp \
+echo     GoBinaryScanner.cpp \
 echo     third_party/miniz/miniz.c \
 echo     third_party/miniz/miniz_zip.c \
 echo     third_party/miniz/miniz_tinfl.c \
@@ -91,7 +107,23 @@ echo     JavaBytecodeScanner.h \
 echo     JavaASTScanner.h \
 echo     PythonASTScanner.h \
 echo     CppASTScanner.h \
-echo     DynLinkParser.h
+echo     DynLinkParser.h \
+echo     ScanGovernor.h \
+echo     DeviceScheduler.h \
+echo     ContainerReader.h \
+echo     ParserPool.h \
+echo     AstRuleEngine.h \
+echo     TokenPrefilter.h \
+echo     LexerScanner.h \
+echo     TreeCache.h \
+echo     ArtifactExporter.h \
+echo     ConstantScanner.h \
+echo     InsnScanner.h \
+echo     PEImage.h \
+echo     ApiNameIndex.h \
+echo     LibraryResolver.h \
+echo     DotNetMetadata.h \
+echo     GoBinaryScanner.h
 ) > CryptoScannerCLI.pro
 
 echo.
@@ -136,7 +168,7 @@ echo Linking final executable...
 "%MINGW_DIR%\bin\g++.exe" -Wl,-s -Wl,-subsystem,console -mthreads -o release/CryptoScannerCLI.exe ^
   release/main_gui_cli.o release/CryptoScanner.o release/FileScanner.o release/PatternLoader.o ^
   release/PatternDefinitions.o release/JavaBytecodeScanner.o release/JavaASTScanner.o ^
-  release/PythonASTScanner.o release/CppASTScanner.o release/DynLinkParser.o ^
+  release/PythonASTScanner.o release/CppASTScanner.o release/DynLinkParser.o release/ScanGovernor.o release/DeviceScheduler.o release/ContainerReader.o release/ParserPool.o release/AstRuleEngine.o release/TokenPrefilter.o release/LexerScanner.o release/TreeCache.o release/ArtifactExporter.o release/ConstantScanner.o release/InsnScanner.o release/PEImage.o release/ApiNameIndex.o release/LibraryResolver.o release/DotNetMetadata.o release/GoBinaryScanner.o ^
   release/miniz.o release/miniz_zip.o release/miniz_tinfl.o release/miniz_tdef.o release/lib.o ^
   release/java_parser.o release/python_parser.o release/cpp_parser.o ^
   release/python_scanner.o release/cpp_scanner.o ^
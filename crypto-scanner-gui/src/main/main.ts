@@ -361,7 +361,7 @@ ipcMain.handle('start-scan', async (event, scanOptions) => {
               console.log('Main process sending progress:', progressData);
               mainWindow.webContents.send('scan-progress', progressData);
             } else if (line.startsWith('DETECTION:')) {
-              // Parse detection: DETECTION:filePath,offset,algorithm,matchString,evidenceType,severity
+              // Parse detection: DETECTION:filePath,offset,algorithm,matchString,evidenceType,severity[,section]
               const detectionData = line.substring(10); // Remove 'DETECTION:' prefix
               const parts = detectionData.split(',');
 
@@ -372,7 +372,8 @@ ipcMain.handle('start-scan', async (event, scanOptions) => {
                   algorithm: parts[2],
                   matchString: parts[3],
                   evidenceType: parts[4],
-                  severity: parts[5]
+                  severity: parts[5],
+                  section: parts[6] || ''
                 };
                 detections.push(detection);
                 console.log('Added detection:', detection);
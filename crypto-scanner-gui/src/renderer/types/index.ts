@@ -17,6 +17,7 @@ export interface Detection {
   matchString: string;
   evidenceType: string;
   severity: string;
+  section?: string;
   fileSize?: number;
 }
 